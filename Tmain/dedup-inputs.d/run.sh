@@ -0,0 +1,25 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+O="--quiet --options=NONE --sort=no"
+
+echo '# reuse'
+${CTAGS} $O --dedup-inputs=reuse -o - ./src/x/a.c ./src/y/a.c ./src/y/b.c ./src/x/a.c
+echo '# skip'
+${CTAGS} $O --dedup-inputs=skip -o - ./src/x/a.c ./src/y/a.c ./src/y/b.c ./src/x/a.c
+echo '# no'
+${CTAGS} $O --dedup-inputs=no -o - ./src/x/a.c ./src/y/a.c
+echo '# options between inputs'
+${CTAGS} $O --dedup-inputs -o - ./src/x/a.c --fields=+n ./src/y/a.c
+echo '# anonymous names'
+${CTAGS} $O --dedup-inputs -o - ./src/x/anon.c ./src/y/anon.c
+echo '# other writers'
+${CTAGS} $O --dedup-inputs -x ./src/x/a.c ./src/y/a.c
+echo '# verbose'
+${CTAGS} $O --dedup-inputs=reuse --verbose -o /dev/null ./src/x/a.c ./src/y/a.c ./src/y/b.c 2>&1 | grep -e '^reusing' -e '^skipping'
+${CTAGS} $O --dedup-inputs=skip --verbose -o /dev/null ./src/x/a.c ./src/y/a.c ./src/y/b.c 2>&1 | grep -e '^reusing' -e '^skipping'
+echo '# invalid'
+${CTAGS} $O --dedup-inputs=x -o - ./src/x/a.c
+exit 0
@@ -0,0 +1 @@
+enum { RED, GREEN };
@@ -0,0 +1,8 @@
+int foo (void)
+{
+	return 0;
+}
+
+struct bar {
+	int baz;
+};
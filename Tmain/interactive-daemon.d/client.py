@@ -0,0 +1,27 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+#
+# Sends a request to the ctags daemon listening on argv[1] and prints
+# the responses.
+
+import socket
+import sys
+import time
+
+for _ in range(100):
+    try:
+        s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        s.connect(sys.argv[1])
+        break
+    except OSError:
+        s.close()
+        time.sleep(0.1)
+else:
+    sys.exit("cannot connect to " + sys.argv[1])
+
+s.sendall(b'{"command":"generate-tags", "filename":"test.c"}\n')
+s.shutdown(socket.SHUT_WR)
+f = s.makefile("rb")
+for line in f:
+    sys.stdout.write(line.decode())
+s.close()
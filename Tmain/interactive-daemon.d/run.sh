@@ -0,0 +1,44 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+. ../utils.sh
+
+is_feature_available ${CTAGS} daemon
+
+if ! python3 -c 'import socket; socket.AF_UNIX' > /dev/null 2>&1; then
+	skip "python3 with unix domain sockets is not available"
+fi
+
+# It seems that the output format is slightly different between libjansson versions
+s()
+{
+	sed -e s/':"'/': "'/g | jdropver
+}
+
+CTAGS="$CTAGS --quiet --options=NONE"
+
+echo '# too long socket path'
+${CTAGS} --_daemon=${BUILDDIR}/$(printf '%0300d' 0).sock > ${BUILDDIR}/daemon.out 2>&1
+echo "exit: $?"
+sed -e 's/socket path: [^"]*"/socket path: ..."/' < ${BUILDDIR}/daemon.out
+
+echo '# cannot bind'
+${CTAGS} --_daemon=${BUILDDIR}/no-such-dir/daemon.sock > ${BUILDDIR}/daemon.out 2>&1
+echo "exit: $?"
+sed -e 's/socket to [^"]*"/socket to ..."/' < ${BUILDDIR}/daemon.out
+rm -f ${BUILDDIR}/daemon.out
+
+echo '# serving'
+sock=${BUILDDIR}/daemon.sock
+rm -f $sock
+${CTAGS} --_daemon=$sock &
+pid=$!
+python3 ./client.py $sock | s
+kill $pid
+wait $pid
+echo "exit: $?"
+if [ -e $sock ]; then
+	echo "$sock is left"
+fi
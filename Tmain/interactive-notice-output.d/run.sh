@@ -11,7 +11,7 @@ s()
 	sed -e s/':"'/': "'/g | jdropver
 }
 
-if is_feature_available ${CTAGS} json; then
+if is_feature_available ${CTAGS} interactive; then
 	echo '{"command":"generate-tags", "filename":"input.cst"}' | $CTAGS --options=NONE --pseudo-tags=-TAG_PROGRAM_VERSION \
 																		--map-CTagsSelfTest=.cst --_interactive |s
 	echo '{"command":"generate-tags", "filename":"input.cst"}' | $CTAGS --quiet --options=NONE --pseudo-tags=-TAG_PROGRAM_VERSION \
@@ -0,0 +1,44 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+. ../utils.sh
+
+is_feature_available ${CTAGS} interactive
+
+# It seems that the output format is slightly different between libjansson versions
+s()
+{
+	sed -e s/':"'/': "'/g | jdropver
+}
+
+CTAGS="$CTAGS --quiet --options=NONE"
+
+echo request id in responses
+echo =======================================
+(
+	echo '{"command":"generate-tags", "filename":"test.rb", "id": 1}'
+	echo '{"command":"generate-tags", "filename":"test.foo", "id": "two"}'
+) | ${CTAGS} --_interactive |s
+
+echo
+echo invalid request id
+echo =======================================
+echo '{"command":"generate-tags", "filename":"test.rb", "id": [1]}' | ${CTAGS} --_interactive |s
+
+echo
+echo source code of a rejected request is skipped
+echo =======================================
+size=$(filesize test.rb)
+(
+	echo '{"command":"foobar", "size":'$size', "id": 3}'
+	cat test.rb
+	echo '{"command":"generate-tags", "filename":"foobar.rb", "size":'$size', "id": 4}'
+	cat test.rb
+) | ${CTAGS} --_interactive |s
+
+echo
+echo request line longer than 1024 bytes
+echo =======================================
+pad=$(printf '%02000d' 0)
+echo '{"command":"generate-tags", "filename":"test.rb", "id": 5, "pad": "'$pad'"}' | ${CTAGS} --_interactive |s
@@ -0,0 +1,26 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+. ../utils.sh
+
+is_feature_available ${CTAGS} interactive-workers
+
+# It seems that the output format is slightly different between libjansson versions
+s()
+{
+	sed -e s/':"'/': "'/g | jdropver
+}
+
+CTAGS="$CTAGS --quiet --options=NONE"
+
+# Responses may come in any order; lines of a response carry the request id.
+size=$(filesize test.rb)
+(
+	for i in 1 2 3 4; do
+		echo '{"command":"generate-tags", "filename":"test.c", "id": '$i'}'
+		echo '{"command":"generate-tags", "filename":"foobar.rb", "size":'$size', "id": "s'$i'"}'
+		cat test.rb
+	done
+	echo '{"command":"foobar", "id": 5}'
+) | ${CTAGS} --_interactive --_interactive-workers=3 |s | LC_ALL=C sort
@@ -0,0 +1,2 @@
+def a
+fun b
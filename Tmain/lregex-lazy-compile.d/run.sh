@@ -0,0 +1,18 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS="$1 --quiet --options=NONE --options=./x.ctags"
+
+. ../utils.sh
+
+# The patterns given with options are checked when they are given. Only
+# the patterns of built-in parsers are compiled when they are used first.
+
+echo2 '# no input'
+${CTAGS} --list-kinds-full=X
+
+echo2 '# input'
+${CTAGS} -o - input.x
+
+echo2 '# other language'
+${CTAGS} --language-force=C -o - input.x
@@ -0,0 +1,8 @@
+struct point {
+	int x, y;
+};
+
+int distance (struct point *a, struct point *b)
+{
+	return a->x - b->x;
+}
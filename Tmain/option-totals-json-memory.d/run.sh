@@ -0,0 +1,24 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+. ../utils.sh
+
+CTAGS=$1
+O=/tmp/ctags-tmain-$$
+
+${CTAGS} --quiet --options=NONE --totals=json -o - input.c 2> $O.json > /dev/null
+if ! grep -q '^ "memory"' $O.json; then
+	rm -f $O.json
+	skip "the size of an allocated block is not available"
+fi
+
+# The amount of memory and the order of subsystems vary from platform
+# to platform. Allocations outside the parser ("main" and "sort")
+# vary, too.
+sed -n -e 's/^ "memory": {\("peak"\): [0-9]*, \("allocations"\): [0-9]*, \("allocated"\): [0-9]*,$/\1 \2 \3/p' $O.json
+echo subsystems:
+sed -n -e '/^  "subsystems"/,/^  "largest"/s/^   {"name": "\([^"]*\)", "allocations": [1-9][0-9]*, "allocated": [1-9][0-9]*}.*/\1/p' $O.json \
+	| grep -v -e '^main$' -e '^sort$' | sort
+echo largest:
+sed -n -e '/^  "largest"/,/^ "parsers"/s/^   {\("name": "[^"]*", "parser": "[^"]*"\), "peak": [1-9][0-9]*}.*/\1/p' $O.json
+rm -f $O.json
@@ -0,0 +1,10 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+# Timings vary from run to run. The memory report is tested in
+# option-totals-json-memory.d.
+${CTAGS} --quiet --options=NONE --totals=json -o - input.py 2>&1 >/dev/null \
+	| sed -e 's/\("\(wall\|cpu\)": \)[0-9.]*/\1T/g' \
+	| sed -e '/^ "memory"/,/^ "parsers"/{/^ "parsers"/!d;}'
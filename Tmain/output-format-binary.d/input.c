@@ -0,0 +1,15 @@
+#define MAX 10
+
+struct point {
+	int x;
+	int y;
+};
+
+enum color { RED, GREEN };
+
+static int counter;
+
+int add (struct point *p, int n)
+{
+	return p->x + n;
+}
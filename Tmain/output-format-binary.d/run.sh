@@ -0,0 +1,35 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+READTAGS=$3
+
+. ../utils.sh
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+O="--quiet --options=NONE --sort=no --fields=+neKZS --extras=+r"
+
+rm -f $BUILDDIR/binary.tags $BUILDDIR/text.tags
+
+${CTAGS} $O --output-format=binary -o $BUILDDIR/binary.tags input.c
+${CTAGS} $O -o $BUILDDIR/text.tags input.c
+
+echo '#' binary
+${READTAGS} -t $BUILDDIR/binary.tags -e -E -l
+echo '#' find
+${READTAGS} -t $BUILDDIR/binary.tags -e -E point
+
+echo '#' diff
+${READTAGS} -t $BUILDDIR/binary.tags -e -E -l > $BUILDDIR/binary.out
+${READTAGS} -t $BUILDDIR/text.tags -e -E -l > $BUILDDIR/text.out
+diff $BUILDDIR/text.out $BUILDDIR/binary.out && echo same
+
+echo '#' append
+${CTAGS} $O --output-format=binary -a -o $BUILDDIR/binary.tags input.c
+echo $?
+
+rm -f $BUILDDIR/binary.tags $BUILDDIR/text.tags $BUILDDIR/binary.out $BUILDDIR/text.out
@@ -0,0 +1,25 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+O="--quiet --options=NONE"
+
+echo '# recurse'
+${CTAGS} $O --read-ahead=1,1 -R -o - ./src
+echo '# list file'
+${CTAGS} $O --read-ahead=2 -L list.txt -o -
+echo '# list file from a pipe'
+# The parsers and the helper thread must not share the lines.
+i=0
+while [ $i -lt 300 ]; do
+	cat list.txt
+	i=$((i + 1))
+done | ${CTAGS} $O --sort=no --read-ahead=64 -L /dev/stdin -o - | sort | uniq -c | sed -e 's/^ *//'
+echo '# arguments'
+${CTAGS} $O --read-ahead=1,4096 -o - ./src/a.c ./src/c.c ./src/subdir/b.c
+echo '# disabled'
+${CTAGS} $O --read-ahead=0 -R -o - ./src
+echo '# invalid'
+${CTAGS} $O --read-ahead=1,x -o - ./src/a.c
+exit 0
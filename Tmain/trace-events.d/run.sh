@@ -0,0 +1,11 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+O=/tmp/ctags-tmain-$$.json
+trap 'rm -f $O' EXIT
+
+${CTAGS} --quiet --options=NONE --_trace-events=$O --extras=+g -o - input.html > /dev/null
+# Time stamps and process ids vary from run to run.
+sed -e 's/"ts": [0-9.]*, "pid": [0-9]*, "tid": [0-9]*/"ts": T, "pid": P, "tid": P/' $O
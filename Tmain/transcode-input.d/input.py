@@ -0,0 +1,9 @@
+def ֐():
+    pass
+
+class \:
+    def o(self):
+        pass
+
+def ascii_fn():
+    pass
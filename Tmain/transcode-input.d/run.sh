@@ -0,0 +1,20 @@
+#!/bin/sh
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+. ../utils.sh
+
+if ${CTAGS} --quiet --options=NONE --list-features | grep -q iconv; then
+  check_encoding shift_jis
+  check_encoding utf-8
+  O="--quiet --options=NONE --input-encoding=shift_jis --output-encoding=utf-8 --transcode-input"
+  echo '# u-ctags'
+  ${CTAGS} $O --fields=+n -o - input.py
+  echo '# etags'
+  ${CTAGS} $O -e -o - input.py
+  exit $?
+else
+  skip "iconv feature is not available"
+fi
@@ -0,0 +1,45 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+. ../utils.sh
+
+is_feature_available ${CTAGS} watch
+
+CTAGS="$CTAGS --quiet --options=NONE"
+
+dir=$(mktemp -d)
+trap 'rm -rf $dir' EXIT
+
+# Wait until the tag file has a line starting with $1 and none with $2.
+wait_for()
+{
+	for i in $(seq 50); do
+		if [ -f $dir/tags ] && grep -q "^$1" $dir/tags && ! grep -q "^$2" $dir/tags; then
+			return 0
+		fi
+		sleep 0.1
+	done
+	echo "timeout waiting for $1"
+}
+
+# A file rewritten in place keeps its inode; it is not a duplicate
+# of what it was before.
+for mode in skip reuse; do
+	echo "# $mode"
+	rm -f $dir/tags
+	echo 'int alpha;' > $dir/a.c
+	echo 'int gamma;' > $dir/c.c
+
+	(cd $dir; exec ${CTAGS} --watch -R --dedup-inputs=$mode --pseudo-tags=) &
+	pid=$!
+	wait_for "alpha	" "none	"
+
+	echo 'int beta;' > $dir/a.c
+	wait_for "beta	" "alpha	"
+
+	kill -TERM $pid
+	wait $pid
+	echo "# exit status: $?"
+	cat $dir/tags
+done
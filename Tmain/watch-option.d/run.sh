@@ -0,0 +1,50 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+. ../utils.sh
+
+is_feature_available ${CTAGS} watch
+
+CTAGS="$CTAGS --quiet --options=NONE"
+
+echo '# without --recurse'
+${CTAGS} --watch input.c 2>&1
+echo '# to stdout'
+${CTAGS} --watch -R -f - 2>&1
+
+dir=$(mktemp -d)
+trap 'rm -rf $dir' EXIT
+mkdir $dir/sub
+echo 'int alpha;' > $dir/a.c
+echo 'int beta;' > $dir/sub/b.c
+echo 'int gamma;' > $dir/skip.c
+
+# Wait until the tag file has a line starting with $1 and none with $2.
+wait_for()
+{
+	for i in $(seq 50); do
+		if grep -q "^$1" $dir/tags && ! grep -q "^$2" $dir/tags; then
+			return 0
+		fi
+		sleep 0.1
+	done
+	echo "timeout waiting for $1"
+}
+
+(cd $dir; exec ${CTAGS} --watch -R --exclude=skip.c --pseudo-tags=) &
+pid=$!
+wait_for "beta	" "none	"
+
+echo 'int alpha2;' > $dir/a.c
+echo 'int delta;' > $dir/sub/d.c
+echo 'int gamma2;' > $dir/skip.c
+wait_for "delta	" "alpha	"
+rm $dir/sub/b.c
+mv $dir/sub $dir/renamed
+wait_for "delta	renamed/d.c" "beta	"
+
+kill -TERM $pid
+wait $pid
+echo "# exit status: $?"
+cat $dir/tags
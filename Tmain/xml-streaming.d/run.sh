@@ -0,0 +1,43 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE --sort=no --extras=+r --fields=+KrZ"
+
+echo '# streaming'
+${CTAGS} $O --languages=XML,Glade --verbose -o /dev/null input.glade 2>&1 | grep -e 'as a xml stream'
+${CTAGS} $O --languages=XML,Glade -o - input.glade
+echo '# streaming with the default parsers'
+${CTAGS} $O --verbose -o /dev/null input.glade 2>&1 | grep -e 'as a xml stream'
+${CTAGS} $O -o - input.glade
+echo '# dom with a subparser whose table may match'
+# The xpath table of PlistXML starts with ///plist.
+sed -e 's/id="button"/id="plist"/' input.glade > ${BUILDDIR}/plist.glade
+${CTAGS} $O --languages=XML,Glade,PlistXML --verbose -o /dev/null ${BUILDDIR}/plist.glade 2>&1 | grep -e 'as a xml stream'
+${CTAGS} $O --languages=XML,Glade,PlistXML -o - ${BUILDDIR}/plist.glade | sed -e "s|${BUILDDIR}/||"
+rm -f ${BUILDDIR}/plist.glade
+echo '# dom with the xpath field'
+${CTAGS} $O --languages=XML,Glade --fields=+{xpath} --verbose -o /dev/null input.glade 2>&1 | grep -e 'as a xml stream'
+${CTAGS} $O --languages=XML,Glade --fields=+{xpath} -o - input.glade
+echo '# broken input'
+${CTAGS} $O --languages=XML,Glade -o - broken.glade
+${CTAGS} $O -o - broken.glade
+echo '# truncated input'
+# No tag is made from the part before the broken part, as with the DOM tree.
+{
+	echo '<?xml version="1.0"?>'
+	echo '<glade-interface>'
+	i=0
+	while [ $i -lt 500 ]; do
+		echo "  <widget class=\"GtkButton\" id=\"button$i\"><signal name=\"clicked\" handler=\"on_button${i}_clicked\"/></widget>"
+		i=$((i + 1))
+	done
+	echo '  <widget class="GtkButton" id="truncated">'
+} > ${BUILDDIR}/truncated.glade
+${CTAGS} $O --languages=XML,Glade -o - ${BUILDDIR}/truncated.glade | wc -l
+${CTAGS} $O --languages=XML,Glade --fields=+{xpath} -o - ${BUILDDIR}/truncated.glade | wc -l
+${CTAGS} $O -o - ${BUILDDIR}/truncated.glade | wc -l
+rm -f ${BUILDDIR}/truncated.glade
+exit 0
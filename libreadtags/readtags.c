@@ -23,6 +23,22 @@
 */
 #define TAB '\t'
 
+/* The first bytes of a binary tag stream written by
+ * ctags --output-format=binary */
+#define BINARY_MAGIC "\211CTAGS\r\n"
+#define BINARY_MAGIC_LENGTH 8
+#define BINARY_VERSION 1
+
+/* Flags in the header of a binary tag stream */
+#define BINARY_FLAG_KIND_LETTER (1 << 0)
+#define BINARY_FLAG_KIND_LONG   (1 << 1)
+#define BINARY_FLAG_SCOPE_KEY   (1 << 2)
+#define BINARY_FLAG_COMBINE     (1 << 3)
+
+/* Limits for rejecting a broken stream before allocating for it */
+#define BINARY_FIELD_MAX 65536
+#define BINARY_ROLE_MAX  64
+
 
 /*
 *   DATA DECLARATIONS
@@ -39,6 +55,51 @@ typedef long long rt_off_t;
 typedef off_t rt_off_t;
 #endif
 
+/* How the value of a field is encoded in a binary tag stream */
+typedef enum {
+	BinaryEncString,
+	BinaryEncInteger,
+	BinaryEncPresence,
+	BinaryEncRoles,
+	BinaryEncScope,
+} binaryEncoding;
+
+typedef struct {
+		/* non-zero if the field is defined */
+	unsigned char defined;
+		/* id of the name in the string table */
+	unsigned int name;
+	binaryEncoding encoding;
+} binaryField;
+
+typedef struct {
+	unsigned int language;
+	char letter [2];
+	unsigned int name;
+	unsigned int roleCount;
+	unsigned int *roles;
+} binaryKind;
+
+typedef struct {
+	unsigned int id;
+	unsigned long long value;
+		/* id of the scope kind in the string table */
+	unsigned int scopeKind;
+} binaryFieldValue;
+
+typedef struct {
+		/* 'T' for a tag, 'P' for a pseudo tag */
+	int type;
+	unsigned int name;
+	unsigned int file;
+	unsigned int pattern;
+	unsigned long line;
+	unsigned int kind;
+	unsigned int fieldCount;
+	unsigned int fieldMax;
+	binaryFieldValue *fields;
+} binaryRecord;
+
 /* Information about current tag file */
 struct sTagFile {
 		/* has the file been opened and this structure initialized? */
@@ -92,6 +153,36 @@ struct sTagFile {
 			/* program version */
 		char *version;
 	} program;
+		/* state for reading a binary tag stream */
+	struct {
+				/* non-zero if the file is a binary tag stream */
+			unsigned char enabled;
+				/* flags in the header */
+			unsigned int flags;
+				/* file position of the first record */
+			rt_off_t start;
+				/* definitions before this position have been read */
+			rt_off_t defined;
+				/* file position of the next byte read */
+			rt_off_t offset;
+				/* string table; ids start from 1 */
+			char **strings;
+			unsigned int stringCount;
+			unsigned int stringMax;
+				/* field table indexed by field id */
+			binaryField *fields;
+			unsigned int fieldMax;
+				/* kind table; ids start from 1 */
+			binaryKind *kinds;
+			unsigned int kindCount;
+			unsigned int kindMax;
+				/* last tag or pseudo tag record read */
+			binaryRecord record;
+				/* values rendered for the last entry parsed */
+			char **scratch;
+			unsigned int scratchCount;
+			unsigned int scratchMax;
+	} binary;
 		/* 0 (initial state set by calloc), errno value,
 		 * or tagErrno typed value */
 	int err;
@@ -108,6 +199,8 @@ static const size_t PseudoTagPrefixLength = 2;
 *   FUNCTION DEFINITIONS
 */
 
+static int readBinaryRecord (tagFile *const file, int *err);
+
 static rt_off_t readtags_ftell(FILE *fp)
 {
 	rt_off_t pos;
@@ -315,6 +408,9 @@ static int readTagLineRaw (tagFile *const file, int *err)
 	int result = 1;
 	int reReadLine;
 
+	if (file->binary.enabled)
+		return readBinaryRecord (file, err);
+
 	/*  If reading the line places any character other than a null or a
 	 *  newline at the last character position in the buffer (one less than
 	 *  the buffer size), then we must resize the buffer and reattempt to read
@@ -413,6 +509,653 @@ static tagResult growFields (tagFile *const file)
 	return result;
 }
 
+/*
+ * Reading a binary tag stream
+ *
+ * See docs/output-binary.rst of Universal Ctags for the layout.
+ * The records defining strings, fields, and kinds are read only once
+ * even if the file position is moved back; `binary.defined' remembers
+ * how far the definitions have been read.
+ */
+static tagResult growArray (void **array, unsigned int *max,
+							unsigned int needed, size_t size)
+{
+	unsigned int newMax;
+	void *newArray;
+
+	if (needed <= *max)
+		return TagSuccess;
+
+	newMax = (*max == 0)? 16: *max;
+	while (newMax < needed)
+	{
+		if (newMax > ((unsigned int) -1) / 2)
+			return TagFailure;
+		newMax *= 2;
+	}
+	if ((size_t) newMax > ((size_t) -1) / size)
+		return TagFailure;
+	newArray = realloc (*array, newMax * size);
+	if (newArray == NULL)
+		return TagFailure;
+	memset ((char *) newArray + (*max * size), 0, (newMax - *max) * size);
+	*array = newArray;
+	*max = newMax;
+	return TagSuccess;
+}
+
+static int binaryGetc (tagFile *const file)
+{
+	int c = getc (file->fp);
+	if (c != EOF)
+		file->binary.offset++;
+	return c;
+}
+
+static int readBinaryVarint (tagFile *const file, unsigned long long *value,
+							 int *err)
+{
+	unsigned long long v = 0;
+	int shift = 0;
+	int c;
+
+	do
+	{
+		c = binaryGetc (file);
+		if (c == EOF || shift > 63)
+		{
+			*err = ferror (file->fp)? errno: TagErrnoUnexpectedFormat;
+			return 0;
+		}
+		v |= (unsigned long long) (c & 0x7f) << shift;
+		shift += 7;
+	} while (c & 0x80);
+
+	*value = v;
+	return 1;
+}
+
+static int readBinaryUInt (tagFile *const file, unsigned int *value, int *err)
+{
+	unsigned long long v;
+
+	if (! readBinaryVarint (file, &v, err))
+		return 0;
+	if (v > (unsigned int) -1)
+	{
+		*err = TagErrnoUnexpectedFormat;
+		return 0;
+	}
+	*value = (unsigned int) v;
+	return 1;
+}
+
+/* Read a reference to the string table. 0 stands for no string. */
+static int readBinaryStringRef (tagFile *const file, unsigned int *id, int *err)
+{
+	if (! readBinaryUInt (file, id, err))
+		return 0;
+	if (*id > file->binary.stringCount)
+	{
+		*err = TagErrnoUnexpectedFormat;
+		return 0;
+	}
+	return 1;
+}
+
+/* Same as readBinaryStringRef () but 0 is rejected. */
+static int readBinaryStringId (tagFile *const file, unsigned int *id, int *err)
+{
+	if (! readBinaryStringRef (file, id, err))
+		return 0;
+	if (*id == 0)
+	{
+		*err = TagErrnoUnexpectedFormat;
+		return 0;
+	}
+	return 1;
+}
+
+static const char *binaryString (tagFile *const file, unsigned int id)
+{
+	return (id == 0)? NULL: file->binary.strings [id - 1];
+}
+
+static int readBinaryStringDefinition (tagFile *const file, int known, int *err)
+{
+	unsigned int length;
+	char *str;
+
+	if (! readBinaryUInt (file, &length, err))
+		return 0;
+
+	if (known)
+	{
+		if (readtags_fseek (file->fp, length, SEEK_CUR) < 0)
+		{
+			*err = errno;
+			return 0;
+		}
+		file->binary.offset += length;
+		return 1;
+	}
+
+	if (growArray ((void **) &file->binary.strings, &file->binary.stringMax,
+				   file->binary.stringCount + 1, sizeof (char *)) != TagSuccess)
+	{
+		*err = ENOMEM;
+		return 0;
+	}
+	str = (char *) malloc ((size_t) length + 1);
+	if (str == NULL)
+	{
+		*err = ENOMEM;
+		return 0;
+	}
+	if (fread (str, 1, length, file->fp) != length)
+	{
+		*err = ferror (file->fp)? errno: TagErrnoUnexpectedFormat;
+		free (str);
+		return 0;
+	}
+	file->binary.offset += length;
+	str [length] = '\0';
+	file->binary.strings [file->binary.stringCount++] = str;
+	return 1;
+}
+
+static int readBinaryFieldDefinition (tagFile *const file, int known, int *err)
+{
+	unsigned int id, name, encoding;
+
+	if (! readBinaryUInt (file, &id, err)
+		|| ! readBinaryStringRef (file, &name, err)
+		|| ! readBinaryUInt (file, &encoding, err))
+		return 0;
+	if (id >= BINARY_FIELD_MAX || encoding > BinaryEncScope)
+	{
+		*err = TagErrnoUnexpectedFormat;
+		return 0;
+	}
+	if (known)
+		return 1;
+
+	if (growArray ((void **) &file->binary.fields, &file->binary.fieldMax,
+				   id + 1, sizeof (binaryField)) != TagSuccess)
+	{
+		*err = ENOMEM;
+		return 0;
+	}
+	file->binary.fields [id].defined = 1;
+	file->binary.fields [id].name = name;
+	file->binary.fields [id].encoding = (binaryEncoding) encoding;
+	return 1;
+}
+
+static int readBinaryKindDefinition (tagFile *const file, int known, int *err)
+{
+	binaryKind kind;
+	unsigned int i;
+	int c;
+
+	memset (&kind, 0, sizeof (kind));
+	if (! readBinaryStringRef (file, &kind.language, err))
+		return 0;
+	c = binaryGetc (file);
+	if (c == EOF)
+	{
+		*err = ferror (file->fp)? errno: TagErrnoUnexpectedFormat;
+		return 0;
+	}
+	kind.letter [0] = (char) c;
+	if (! readBinaryStringRef (file, &kind.name, err)
+		|| ! readBinaryUInt (file, &kind.roleCount, err))
+		return 0;
+	if (kind.roleCount > BINARY_ROLE_MAX)
+	{
+		*err = TagErrnoUnexpectedFormat;
+		return 0;
+	}
+
+	if (! known && kind.roleCount > 0)
+	{
+		kind.roles = (unsigned int *) malloc (kind.roleCount * sizeof (unsigned int));
+		if (kind.roles == NULL)
+		{
+			*err = ENOMEM;
+			return 0;
+		}
+	}
+	for (i = 0; i < kind.roleCount; i++)
+	{
+		unsigned int role;
+		if (! readBinaryStringId (file, &role, err))
+		{
+			free (kind.roles);
+			return 0;
+		}
+		if (kind.roles)
+			kind.roles [i] = role;
+	}
+	if (known)
+		return 1;
+
+	if (growArray ((void **) &file->binary.kinds, &file->binary.kindMax,
+				   file->binary.kindCount + 1, sizeof (binaryKind)) != TagSuccess)
+	{
+		free (kind.roles);
+		*err = ENOMEM;
+		return 0;
+	}
+	file->binary.kinds [file->binary.kindCount++] = kind;
+	return 1;
+}
+
+static int copyBinaryName (tagFile *const file, const char *name)
+{
+	size_t length = strlen (name);
+
+	while (length >= file->line.size)
+		if (growString (&file->line) != TagSuccess)
+			return 0;
+	while (length >= file->name.size)
+		if (growString (&file->name) != TagSuccess)
+			return 0;
+	memcpy (file->line.buffer, name, length + 1);
+	memcpy (file->name.buffer, name, length + 1);
+	return 1;
+}
+
+static int readBinaryFields (tagFile *const file, binaryRecord *record, int *err)
+{
+	unsigned int i;
+
+	if (! readBinaryUInt (file, &record->fieldCount, err))
+		return 0;
+	if (growArray ((void **) &record->fields, &record->fieldMax,
+				   record->fieldCount, sizeof (binaryFieldValue)) != TagSuccess)
+	{
+		*err = ENOMEM;
+		return 0;
+	}
+
+	for (i = 0; i < record->fieldCount; i++)
+	{
+		binaryFieldValue *v = record->fields + i;
+		unsigned int n = 0;
+		int r = 1;
+
+		v->value = 0;
+		v->scopeKind = 0;
+		if (! readBinaryUInt (file, &v->id, err))
+			return 0;
+		if (v->id >= file->binary.fieldMax
+			|| ! file->binary.fields [v->id].defined)
+		{
+			*err = TagErrnoUnexpectedFormat;
+			return 0;
+		}
+		switch (file->binary.fields [v->id].encoding)
+		{
+		case BinaryEncString:
+			r = readBinaryStringRef (file, &n, err);
+			v->value = n;
+			break;
+		case BinaryEncInteger:
+		case BinaryEncRoles:
+			r = readBinaryVarint (file, &v->value, err);
+			break;
+		case BinaryEncPresence:
+			break;
+		case BinaryEncScope:
+			r = readBinaryStringId (file, &v->scopeKind, err)
+				&& readBinaryStringId (file, &n, err);
+			v->value = n;
+			break;
+		}
+		if (! r)
+			return 0;
+	}
+	return 1;
+}
+
+static int readBinaryEntry (tagFile *const file, int type, int *err)
+{
+	binaryRecord *record = &file->binary.record;
+
+	record->type = type;
+	record->line = 0;
+	record->kind = 0;
+	record->fieldCount = 0;
+
+	if (! readBinaryStringRef (file, &record->name, err)
+		|| ! readBinaryStringRef (file, &record->file, err)
+		|| ! readBinaryStringRef (file, &record->pattern, err))
+		return 0;
+
+	if (type == 'T')
+	{
+		unsigned long long line;
+
+		if (! readBinaryVarint (file, &line, err)
+			|| ! readBinaryUInt (file, &record->kind, err))
+			return 0;
+		record->line = (unsigned long) line;
+		if (record->kind > file->binary.kindCount)
+		{
+			*err = TagErrnoUnexpectedFormat;
+			return 0;
+		}
+	}
+
+	if (! readBinaryFields (file, record, err))
+		return 0;
+
+	if (! copyBinaryName (file, record->name? binaryString (file, record->name): EmptyString))
+	{
+		*err = ENOMEM;
+		return 0;
+	}
+	return 1;
+}
+
+/* Read records until a tag or a pseudo tag. Return 0 on failure or EOF. */
+static int readBinaryRecord (tagFile *const file, int *err)
+{
+	rt_off_t pos = readtags_ftell (file->fp);
+
+	if (pos < 0)
+	{
+		*err = errno;
+		return 0;
+	}
+	if (pos < file->binary.start)
+	{
+		if (readtags_fseek (file->fp, file->binary.start, SEEK_SET) < 0)
+		{
+			*err = errno;
+			return 0;
+		}
+		pos = file->binary.start;
+	}
+	file->binary.offset = pos;
+
+	while (1)
+	{
+		int known;
+		int r;
+		int type;
+
+		file->pos = file->binary.offset;
+		known = (file->pos < file->binary.defined);
+		type = binaryGetc (file);
+		switch (type)
+		{
+		case EOF:
+			*err = ferror (file->fp)? errno: 0;
+			return 0;
+		case 'S':
+			r = readBinaryStringDefinition (file, known, err);
+			break;
+		case 'F':
+			r = readBinaryFieldDefinition (file, known, err);
+			break;
+		case 'K':
+			r = readBinaryKindDefinition (file, known, err);
+			break;
+		case 'P':
+		case 'T':
+			return readBinaryEntry (file, type, err);
+		default:
+			*err = TagErrnoUnexpectedFormat;
+			return 0;
+		}
+		if (! r)
+			return 0;
+		if (! known)
+			file->binary.defined = file->binary.offset;
+	}
+}
+
+static void clearBinaryScratch (tagFile *const file)
+{
+	unsigned int i;
+
+	for (i = 0; i < file->binary.scratchCount; i++)
+		free (file->binary.scratch [i]);
+	file->binary.scratchCount = 0;
+}
+
+/* Allocate a buffer living until the next entry is parsed. */
+static char *newBinaryScratch (tagFile *const file, size_t size)
+{
+	char *buf;
+
+	if (growArray ((void **) &file->binary.scratch, &file->binary.scratchMax,
+				   file->binary.scratchCount + 1, sizeof (char *)) != TagSuccess)
+		return NULL;
+	buf = (char *) malloc (size);
+	if (buf)
+		file->binary.scratch [file->binary.scratchCount++] = buf;
+	return buf;
+}
+
+/* Same as getKindString () of ctags. */
+static const char *binaryKindString (tagFile *const file, const binaryKind *kind)
+{
+	const char *name = binaryString (file, kind->name);
+	const char letter = kind->letter [0];
+	const unsigned int flags = file->binary.flags;
+
+	if (name != NULL && ((flags & BINARY_FLAG_KIND_LONG) ||
+						 ((flags & BINARY_FLAG_KIND_LETTER) && letter == '\0')))
+		return name;
+	else if (letter != '\0' && ((flags & BINARY_FLAG_KIND_LETTER) ||
+								((flags & BINARY_FLAG_KIND_LONG) && name == NULL)))
+		return kind->letter;
+	return NULL;
+}
+
+static const char *renderBinaryRoles (tagFile *const file, const binaryKind *kind,
+									  unsigned long long bits)
+{
+	size_t size = 4;	/* "def" */
+	unsigned int i;
+	char *buf;
+
+	if (kind)
+		for (i = 0; i < kind->roleCount; i++)
+			if ((bits >> i) & 1)
+				size += strlen (binaryString (file, kind->roles [i])) + 1;
+
+	buf = newBinaryScratch (file, size);
+	if (buf == NULL)
+		return NULL;
+	if (bits == 0 || kind == NULL)
+	{
+		strcpy (buf, "def");
+		return buf;
+	}
+
+	buf [0] = '\0';
+	for (i = 0; i < kind->roleCount; i++)
+	{
+		if (!((bits >> i) & 1))
+			continue;
+		if (buf [0] != '\0')
+			strcat (buf, ",");
+		strcat (buf, binaryString (file, kind->roles [i]));
+	}
+	return buf;
+}
+
+static tagResult parseBinaryRecord (tagFile *const file, tagEntry *const entry, int *err)
+{
+	const binaryRecord *record = &file->binary.record;
+	const binaryKind *kind = NULL;
+	const char *pattern;
+	unsigned int i;
+	char *buf;
+
+	memset (entry, 0, sizeof (*entry));
+	clearBinaryScratch (file);
+
+	entry->name = file->name.buffer;
+	entry->file = binaryString (file, record->file);
+	if (entry->file == NULL)
+		entry->file = EmptyString;
+	pattern = binaryString (file, record->pattern);
+
+	if (record->type == 'T'
+		&& (pattern == NULL || (file->binary.flags & BINARY_FLAG_COMBINE)))
+	{
+		buf = newBinaryScratch (file, 24 + (pattern? strlen (pattern) + 1: 0));
+		if (buf == NULL)
+			goto mem_error;
+		if (pattern)
+			sprintf (buf, "%lu;%s", record->line, pattern);
+		else
+		{
+			sprintf (buf, "%lu", record->line);
+			entry->address.lineNumber = record->line;
+		}
+		pattern = buf;
+	}
+	entry->address.pattern = pattern;
+
+	if (record->kind > 0)
+	{
+		kind = file->binary.kinds + (record->kind - 1);
+		entry->kind = binaryKindString (file, kind);
+	}
+
+	for (i = 0; i < record->fieldCount; i++)
+	{
+		const binaryFieldValue *v = record->fields + i;
+		const binaryField *field = file->binary.fields + v->id;
+		const char *key = binaryString (file, field->name);
+		const char *value = EmptyString;
+
+		switch (field->encoding)
+		{
+		case BinaryEncString:
+			value = binaryString (file, (unsigned int) v->value);
+			if (value == NULL)
+				value = EmptyString;
+			break;
+		case BinaryEncInteger:
+			buf = newBinaryScratch (file, 24);
+			if (buf == NULL)
+				goto mem_error;
+			sprintf (buf, "%llu", v->value);
+			value = buf;
+			break;
+		case BinaryEncPresence:
+			if (key && strcmp (key, "line") == 0)
+			{
+				entry->address.lineNumber = record->line;
+				continue;
+			}
+			else if (key && strcmp (key, "file") == 0)
+			{
+				entry->fileScope = 1;
+				continue;
+			}
+			break;
+		case BinaryEncRoles:
+			value = renderBinaryRoles (file, kind, v->value);
+			if (value == NULL)
+				goto mem_error;
+			break;
+		case BinaryEncScope:
+			key = binaryString (file, v->scopeKind);
+			value = binaryString (file, (unsigned int) v->value);
+			if (file->binary.flags & BINARY_FLAG_SCOPE_KEY)
+			{
+				buf = newBinaryScratch (file, strlen (key) + strlen (value) + 2);
+				if (buf == NULL)
+					goto mem_error;
+				sprintf (buf, "%s:%s", key, value);
+				key = "scope";
+				value = buf;
+			}
+			break;
+		}
+
+		if (key == NULL)
+			continue;
+		if (entry->fields.count == file->fields.max)
+		{
+			if (growFields (file) != TagSuccess)
+				goto mem_error;
+		}
+		file->fields.list [entry->fields.count].key = key;
+		file->fields.list [entry->fields.count].value = value;
+		++entry->fields.count;
+	}
+
+	if (entry->fields.count > 0)
+		entry->fields.list = file->fields.list;
+	for (i = entry->fields.count  ;  i < file->fields.max  ;  ++i)
+	{
+		file->fields.list [i].key = NULL;
+		file->fields.list [i].value = NULL;
+	}
+	return TagSuccess;
+
+ mem_error:
+	*err = ENOMEM;
+	return TagFailure;
+}
+
+/* Return 1 if the file starts with the header of a binary tag stream. */
+static int readBinaryHeader (tagFile *const file, int *err)
+{
+	char magic [BINARY_MAGIC_LENGTH];
+	unsigned long long version;
+	unsigned long long flags;
+
+	if (fread (magic, 1, BINARY_MAGIC_LENGTH, file->fp) != BINARY_MAGIC_LENGTH
+		|| memcmp (magic, BINARY_MAGIC, BINARY_MAGIC_LENGTH) != 0)
+	{
+		if (readtags_fseek (file->fp, 0, SEEK_SET) == -1)
+			*err = errno;
+		return 0;
+	}
+
+	file->binary.offset = BINARY_MAGIC_LENGTH;
+	if (! readBinaryVarint (file, &version, err)
+		|| ! readBinaryVarint (file, &flags, err))
+		return 0;
+	if (version != BINARY_VERSION)
+	{
+		*err = TagErrnoUnexpectedFormat;
+		return 0;
+	}
+
+	file->binary.enabled = 1;
+	file->binary.flags = (unsigned int) flags;
+	file->binary.start = file->binary.offset;
+	file->binary.defined = file->binary.start;
+	return 1;
+}
+
+static void freeBinary (tagFile *const file)
+{
+	unsigned int i;
+
+	clearBinaryScratch (file);
+	free (file->binary.scratch);
+	for (i = 0; i < file->binary.stringCount; i++)
+		free (file->binary.strings [i]);
+	free (file->binary.strings);
+	free (file->binary.fields);
+	for (i = 0; i < file->binary.kindCount; i++)
+		free (file->binary.kinds [i].roles);
+	free (file->binary.kinds);
+	free (file->binary.record.fields);
+}
+
 static tagResult parseExtensionFields (tagFile *const file, tagEntry *const entry,
 									   char *const string, int *err)
 {
@@ -563,6 +1306,9 @@ static tagResult parseTagLine (tagFile *file, tagEntry *const entry, int *err)
 	size_t p_len = strlen (p);
 	char *tab = strchr (p, TAB);
 
+	if (file->binary.enabled)
+		return parseBinaryRecord (file, entry, err);
+
 	memset(entry, 0, sizeof(*entry));
 
 	entry->name = p;
@@ -856,6 +1602,7 @@ static tagResult gotoFirstLogicalTag (tagFile *const file)
 static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 {
 	tagFile *result = (tagFile*) calloc ((size_t) 1, sizeof (tagFile));
+	int binaryErr = 0;
 
 	if (result == NULL)
 	{
@@ -916,6 +1663,12 @@ static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 		goto file_error;
 	}
 
+	if (! readBinaryHeader (result, &binaryErr) && binaryErr)
+	{
+		info->status.error_number = binaryErr;
+		goto file_error;
+	}
+
 	if (readPseudoTags (result, info) == TagFailure)
 		goto file_error;
 
@@ -929,6 +1682,11 @@ static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 	free (result->line.buffer);
 	free (result->name.buffer);
 	free (result->fields.list);
+	free (result->program.author);
+	free (result->program.name);
+	free (result->program.url);
+	free (result->program.version);
+	freeBinary (result);
 	if (result->fp)
 		fclose (result->fp);
 	free (result);
@@ -943,6 +1701,7 @@ static void terminate (tagFile *const file)
 	free (file->line.buffer);
 	free (file->name.buffer);
 	free (file->fields.list);
+	freeBinary (file);
 
 	if (file->program.author != NULL)
 		free (file->program.author);
@@ -1192,8 +1951,9 @@ static tagResult find (tagFile *const file, tagEntry *const entry,
 		file->err = errno;
 		return TagFailure;
 	}
-	if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
-		(file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase))
+	if (!file->binary.enabled &&
+		((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
+		 (file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase)))
 	{
 		result = findBinary (file);
 		if (result == TagFailure && file->err)
@@ -1242,8 +2002,9 @@ static tagResult findNextFull (tagFile *const file, tagEntry *const entry,
 static tagResult findNext (tagFile *const file, tagEntry *const entry)
 {
 	return findNextFull (file, entry,
-						 (file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
-						 (file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase),
+						 !file->binary.enabled &&
+						 ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
+						  (file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase)),
 						 nameAcceptable, NULL);
 }
 
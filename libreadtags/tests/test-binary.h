@@ -0,0 +1,248 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released into the public domain.
+*
+*   Helpers for composing a binary tag stream in memory
+*   (see docs/output-binary.rst of Universal Ctags for the layout)
+*/
+
+#ifndef TEST_BINARY_H
+#define TEST_BINARY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BINARY_MAGIC "\211CTAGS\r\n"
+#define BINARY_MAGIC_LENGTH 8
+
+#define BINARY_FLAG_KIND_LETTER (1 << 0)
+#define BINARY_FLAG_KIND_LONG   (1 << 1)
+#define BINARY_FLAG_SCOPE_KEY   (1 << 2)
+#define BINARY_FLAG_COMBINE     (1 << 3)
+
+enum binaryEncoding {
+	ENC_STRING,
+	ENC_INTEGER,
+	ENC_PRESENCE,
+	ENC_ROLES,
+	ENC_SCOPE,
+};
+
+struct stream {
+	unsigned char buf [4096];
+	size_t len;
+		/* the number of strings and kinds defined so far */
+	unsigned int strings;
+	unsigned int kinds;
+		/* offsets where a record ends */
+	size_t ends [128];
+	unsigned int nends;
+};
+
+static void
+put_byte (struct stream *s, unsigned char c)
+{
+	if (s->len == sizeof (s->buf))
+	{
+		fprintf (stderr, "the stream buffer is too small\n");
+		exit (99);
+	}
+	s->buf [s->len++] = c;
+}
+
+static void
+put_varint (struct stream *s, unsigned long long v)
+{
+	while (v >= 0x80)
+	{
+		put_byte (s, (unsigned char) (v | 0x80));
+		v >>= 7;
+	}
+	put_byte (s, (unsigned char) v);
+}
+
+static void
+end_record (struct stream *s)
+{
+	if (s->nends == sizeof (s->ends) / sizeof (s->ends [0]))
+	{
+		fprintf (stderr, "too many records\n");
+		exit (99);
+	}
+	s->ends [s->nends++] = s->len;
+}
+
+static void
+put_header (struct stream *s, unsigned int flags)
+{
+	memset (s, 0, sizeof (*s));
+	for (int i = 0; i < BINARY_MAGIC_LENGTH; i++)
+		put_byte (s, (unsigned char) BINARY_MAGIC [i]);
+	put_varint (s, 1);
+	put_varint (s, flags);
+	end_record (s);
+}
+
+/* Emit a 'S' record and return the id of the string. */
+static unsigned int
+def_string (struct stream *s, const char *str)
+{
+	size_t len = strlen (str);
+
+	put_byte (s, 'S');
+	put_varint (s, len);
+	for (size_t i = 0; i < len; i++)
+		put_byte (s, (unsigned char) str [i]);
+	end_record (s);
+	return ++s->strings;
+}
+
+static void
+def_field (struct stream *s, unsigned long long id, unsigned int name,
+		   enum binaryEncoding encoding)
+{
+	put_byte (s, 'F');
+	put_varint (s, id);
+	put_varint (s, name);
+	put_varint (s, encoding);
+	end_record (s);
+}
+
+/* Emit a 'K' record and return the id of the kind. */
+static unsigned int
+def_kind (struct stream *s, unsigned int language, char letter, unsigned int name,
+		  unsigned int role_count, const unsigned int *roles)
+{
+	put_byte (s, 'K');
+	put_varint (s, language);
+	put_byte (s, (unsigned char) letter);
+	put_varint (s, name);
+	put_varint (s, role_count);
+	for (unsigned int i = 0; i < role_count; i++)
+		put_varint (s, roles [i]);
+	end_record (s);
+	return ++s->kinds;
+}
+
+/* Start a 'T' record. Write the fields with put_varint () and
+ * finish the record with end_record (). */
+static void
+put_tag (struct stream *s, unsigned int name, unsigned int file, unsigned int pattern,
+		 unsigned long line, unsigned int kind, unsigned int field_count)
+{
+	put_byte (s, 'T');
+	put_varint (s, name);
+	put_varint (s, file);
+	put_varint (s, pattern);
+	put_varint (s, line);
+	put_varint (s, kind);
+	put_varint (s, field_count);
+}
+
+static void
+put_pseudo_tag (struct stream *s, unsigned int name, unsigned int file, unsigned int pattern)
+{
+	put_byte (s, 'P');
+	put_varint (s, name);
+	put_varint (s, file);
+	put_varint (s, pattern);
+	put_varint (s, 0);
+	end_record (s);
+}
+
+/* A stream equivalent to:
+ *
+ *   !_TAG_PROGRAM_NAME	Universal Ctags	/Derived from Exuberant Ctags/
+ *   main	input.c	/^int main (void)$/;"	kind:function	line:3	typeref:typename:int
+ *   x	input.c	/^struct point { int x; };$/;"	kind:member	line:1	scope:struct:point
+ *   stdio.h	input.c	4;"	kind:header	line:4	roles:system
+ *   main	other.c	/^static int main (int argc)$/;"	kind:function	line:7
+ */
+static void
+make_sample (struct stream *s)
+{
+	unsigned int name, main_name, file, pattern, value, scope;
+	unsigned int c, k_function, k_member, k_header, roles [2];
+
+	put_header (s, BINARY_FLAG_KIND_LONG | BINARY_FLAG_SCOPE_KEY);
+
+	name = def_string (s, "!_TAG_PROGRAM_NAME");
+	file = def_string (s, "Universal Ctags");
+	pattern = def_string (s, "/Derived from Exuberant Ctags/");
+	put_pseudo_tag (s, name, file, pattern);
+
+	c = def_string (s, "C");
+	k_function = def_kind (s, c, 'f', def_string (s, "function"), 0, NULL);
+	def_field (s, 9, def_string (s, "typeref"), ENC_STRING);
+	def_field (s, 5, def_string (s, "line"), ENC_PRESENCE);
+	main_name = def_string (s, "main");
+	file = def_string (s, "input.c");
+	pattern = def_string (s, "/^int main (void)$/");
+	value = def_string (s, "typename:int");
+	put_tag (s, main_name, file, pattern, 3, k_function, 2);
+	put_varint (s, 5);
+	put_varint (s, 9);
+	put_varint (s, value);
+	end_record (s);
+
+	k_member = def_kind (s, c, 'm', def_string (s, "member"), 0, NULL);
+	def_field (s, 12, def_string (s, "scope"), ENC_SCOPE);
+	name = def_string (s, "x");
+	pattern = def_string (s, "/^struct point { int x; };$/");
+	value = def_string (s, "struct");
+	scope = def_string (s, "point");
+	put_tag (s, name, file, pattern, 1, k_member, 2);
+	put_varint (s, 5);
+	put_varint (s, 12);
+	put_varint (s, value);
+	put_varint (s, scope);
+	end_record (s);
+
+	roles [0] = def_string (s, "system");
+	roles [1] = def_string (s, "local");
+	k_header = def_kind (s, c, 'h', def_string (s, "header"), 2, roles);
+	def_field (s, 20, def_string (s, "roles"), ENC_ROLES);
+	name = def_string (s, "stdio.h");
+	put_tag (s, name, file, 0, 4, k_header, 2);
+	put_varint (s, 5);
+	put_varint (s, 20);
+	put_varint (s, 1);
+	end_record (s);
+
+	file = def_string (s, "other.c");
+	pattern = def_string (s, "/^static int main (int argc)$/");
+	put_tag (s, main_name, file, pattern, 7, k_function, 1);
+	put_varint (s, 5);
+	end_record (s);
+}
+
+/* Write the first LEN bytes of the stream to a temporary file.
+ * Return the name of the file or NULL. */
+static char *
+write_stream (const struct stream *s, size_t len)
+{
+	static char name [] = "./test-binary.tags.XXXXXX";
+	int fd;
+
+	strcpy (name + sizeof (name) - 7, "XXXXXX");
+	fd = mkstemp (name);
+	if (fd == -1)
+	{
+		perror ("mkstemp");
+		return NULL;
+	}
+	if (write (fd, s->buf, len) != (ssize_t) len)
+	{
+		perror ("write");
+		close (fd);
+		unlink (name);
+		return NULL;
+	}
+	close (fd);
+	return name;
+}
+
+#endif /* TEST_BINARY_H */
@@ -0,0 +1,466 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released into the public domain.
+*
+*   Testing the guard conditions for broken binary tag streams
+*/
+
+#include "readtags.h"
+#include "test-binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define COUNT(x) (sizeof(x)/sizeof(x[0]))
+
+/* Walk all tags. Return the error number at the end. */
+static int
+walk (tagFile *t)
+{
+	tagEntry e;
+	tagResult r;
+
+	for (r = tagsFirst (t, &e); r == TagSuccess; r = tagsNext (t, &e))
+		;
+	return tagsGetErrno (t);
+}
+
+/* Find all "main" tags. Return the error number at the end. */
+static int
+find_all (tagFile *t)
+{
+	tagEntry e;
+	tagResult r;
+
+	for (r = tagsFind (t, &e, "main", TAG_FULLMATCH); r == TagSuccess; r = tagsFindNext (t, &e))
+		;
+	return tagsGetErrno (t);
+}
+
+static int
+is_record_end (const struct stream *s, size_t len)
+{
+	for (unsigned int i = 0; i < s->nends; i++)
+		if (s->ends [i] == len)
+			return 1;
+	return 0;
+}
+
+static int
+test_truncated0 (struct stream *s, size_t len, int (* run) (tagFile *), const char *what)
+{
+	char *tags = write_stream (s, len);
+	tagFile *t;
+	tagFileInfo info;
+	int expected = is_record_end (s, len)? 0: TagErrnoUnexpectedFormat;
+	int err;
+
+	if (tags == NULL)
+		return 99;
+
+	fprintf (stderr, "%s in a stream truncated at %zu/%zu...", what, len, s->len);
+	t = tagsOpen (tags, &info);
+	unlink (tags);
+	if (t == NULL)
+	{
+		/* tagsOpen () reads up to the first tag record. */
+		if (expected == 0 || info.status.error_number != expected)
+		{
+			fprintf (stderr, "failed to open (error: %d)\n",
+					 info.status.error_number);
+			return 1;
+		}
+		fprintf (stderr, "not opened as expected\n");
+		return 0;
+	}
+
+	err = run (t);
+	tagsClose (t);
+	if (err != expected)
+	{
+		fprintf (stderr, "error number doesn't match: %d (expected: %d)\n",
+				 err, expected);
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+	return 0;
+}
+
+static int
+test_truncated (void)
+{
+	struct stream s;
+	int r;
+
+	make_sample (&s);
+
+	/* Shorter than the magic number, the file is taken as a text tags file. */
+	for (size_t len = BINARY_MAGIC_LENGTH; len < s.len; len++)
+	{
+		r = test_truncated0 (&s, len, walk, "walking");
+		if (r == 0)
+			r = test_truncated0 (&s, len, find_all, "finding");
+		if (r)
+			return r;
+	}
+	return 0;
+}
+
+/*
+ * Each of the following functions writes a stream whose second tag
+ * record refers to something not defined, or out of the range.
+ * tagsOpen () reads the first one.
+ */
+
+static void
+start (struct stream *s, unsigned int *name, unsigned int *file)
+{
+	put_header (s, BINARY_FLAG_KIND_LONG | BINARY_FLAG_SCOPE_KEY);
+	*name = def_string (s, "main");
+	*file = def_string (s, "input.c");
+	put_tag (s, *name, *file, 0, 1, 0, 0);
+	end_record (s);
+}
+
+static void
+bad_name (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	put_tag (s, s->strings + 1, file, 0, 1, 0, 0);
+}
+
+static void
+bad_file (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	put_tag (s, name, 0x7fffffff, 0, 1, 0, 0);
+}
+
+static void
+bad_pattern (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	put_tag (s, name, file, s->strings + 5, 1, 0, 0);
+}
+
+static void
+too_large_string_id (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	put_byte (s, 'T');
+	put_varint (s, 0x100000001ULL);
+}
+
+static void
+bad_string_value (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_field (s, 9, def_string (s, "typeref"), ENC_STRING);
+	put_tag (s, name, file, 0, 1, 0, 1);
+	put_varint (s, 9);
+	put_varint (s, s->strings + 1);
+}
+
+static void
+bad_scope_kind (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_field (s, 12, def_string (s, "scope"), ENC_SCOPE);
+	put_tag (s, name, file, 0, 1, 0, 1);
+	put_varint (s, 12);
+	put_varint (s, s->strings + 1);
+	put_varint (s, name);
+}
+
+static void
+null_scope_kind (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_field (s, 12, def_string (s, "scope"), ENC_SCOPE);
+	put_tag (s, name, file, 0, 1, 0, 1);
+	put_varint (s, 12);
+	put_varint (s, 0);
+	put_varint (s, name);
+}
+
+static void
+null_scope_name (struct stream *s)
+{
+	unsigned int name, file, struct_name;
+
+	start (s, &name, &file);
+	def_field (s, 12, def_string (s, "scope"), ENC_SCOPE);
+	struct_name = def_string (s, "struct");
+	put_tag (s, name, file, 0, 1, 0, 1);
+	put_varint (s, 12);
+	put_varint (s, struct_name);
+	put_varint (s, 0);
+}
+
+static void
+bad_field_name (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_field (s, 9, s->strings + 1, ENC_STRING);
+}
+
+static void
+bad_field_encoding (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_field (s, 9, def_string (s, "typeref"), ENC_SCOPE + 1);
+}
+
+static void
+undefined_field (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_field (s, 9, def_string (s, "typeref"), ENC_STRING);
+	put_tag (s, name, file, 0, 1, 0, 1);
+	put_varint (s, 8);
+}
+
+static void
+too_large_field_in_tag (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_field (s, 9, def_string (s, "typeref"), ENC_STRING);
+	put_tag (s, name, file, 0, 1, 0, 1);
+	put_varint (s, 0xffffffffU);
+}
+
+static void
+too_large_field_definition (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_field (s, 0xffffffffU, def_string (s, "typeref"), ENC_STRING);
+}
+
+static void
+huge_field_definition (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_field (s, 0x80000000U, def_string (s, "typeref"), ENC_STRING);
+}
+
+static void
+bad_kind (struct stream *s)
+{
+	unsigned int name, file, k;
+
+	start (s, &name, &file);
+	k = def_kind (s, def_string (s, "C"), 'f', def_string (s, "function"), 0, NULL);
+	put_tag (s, name, file, 0, 1, k + 1, 0);
+}
+
+static void
+too_large_kind (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	put_tag (s, name, file, 0, 1, 0xffffffffU, 0);
+}
+
+static void
+bad_kind_name (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	def_kind (s, def_string (s, "C"), 'f', s->strings + 2, 0, NULL);
+}
+
+static void
+bad_role_name (struct stream *s)
+{
+	unsigned int name, file, role;
+
+	start (s, &name, &file);
+	role = s->strings + 10;
+	def_kind (s, def_string (s, "C"), 'h', def_string (s, "header"), 1, &role);
+}
+
+static void
+null_role_name (struct stream *s)
+{
+	unsigned int name, file, role = 0;
+
+	start (s, &name, &file);
+	def_kind (s, def_string (s, "C"), 'h', def_string (s, "header"), 1, &role);
+}
+
+static void
+too_many_roles (struct stream *s)
+{
+	unsigned int name, file, roles [65];
+
+	start (s, &name, &file);
+	for (unsigned int i = 0; i < COUNT (roles); i++)
+		roles [i] = name;
+	def_kind (s, def_string (s, "C"), 'h', def_string (s, "header"), COUNT (roles), roles);
+}
+
+static void
+unknown_record (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	put_byte (s, 'X');
+}
+
+static void
+long_varint (struct stream *s)
+{
+	unsigned int name, file;
+
+	start (s, &name, &file);
+	put_byte (s, 'T');
+	for (int i = 0; i < 11; i++)
+		put_byte (s, 0xff);
+	put_byte (s, 0x01);
+}
+
+struct broken {
+	const char *name;
+	void (* make) (struct stream *);
+};
+
+static struct broken brokens [] = {
+	{ "an out of range name",                   bad_name },
+	{ "an out of range file",                   bad_file },
+	{ "an out of range pattern",                bad_pattern },
+	{ "a string id larger than unsigned int",   too_large_string_id },
+	{ "an out of range string field value",     bad_string_value },
+	{ "an out of range scope kind",             bad_scope_kind },
+	{ "no scope kind",                          null_scope_kind },
+	{ "no scope name",                          null_scope_name },
+	{ "an out of range field name",             bad_field_name },
+	{ "an unknown field encoding",              bad_field_encoding },
+	{ "an undefined field",                     undefined_field },
+	{ "a field id larger than the table",       too_large_field_in_tag },
+	{ "defining the largest field id",          too_large_field_definition },
+	{ "defining a huge field id",               huge_field_definition },
+	{ "an out of range kind",                   bad_kind },
+	{ "the largest kind id",                    too_large_kind },
+	{ "an out of range kind name",              bad_kind_name },
+	{ "an out of range role name",              bad_role_name },
+	{ "no role name",                           null_role_name },
+	{ "too many roles",                         too_many_roles },
+	{ "an unknown record type",                 unknown_record },
+	{ "a too long varint",                      long_varint },
+};
+
+static int
+test_broken (struct broken *broken)
+{
+	struct stream s;
+	char *tags;
+	tagFile *t;
+	tagFileInfo info;
+	int err;
+
+	fprintf (stderr, "%s...", broken->name);
+	broken->make (&s);
+	tags = write_stream (&s, s.len);
+	if (tags == NULL)
+		return 99;
+
+	t = tagsOpen (tags, &info);
+	unlink (tags);
+	if (t == NULL)
+	{
+		fprintf (stderr, "failed to open (error: %d)\n", info.status.error_number);
+		return 1;
+	}
+
+	err = walk (t);
+	tagsClose (t);
+	if (err != TagErrnoUnexpectedFormat)
+	{
+		fprintf (stderr, "error number doesn't match: %d (expected: %d)\n",
+				 err, TagErrnoUnexpectedFormat);
+		return 1;
+	}
+	fprintf (stderr, "error as expected\n");
+	return 0;
+}
+
+static int
+test_bad_version (void)
+{
+	struct stream s;
+	char *tags;
+	tagFile *t;
+	tagFileInfo info;
+
+	fprintf (stderr, "an unknown version...");
+	put_header (&s, 0);
+	s.buf [BINARY_MAGIC_LENGTH] = 2;
+	tags = write_stream (&s, s.len);
+	if (tags == NULL)
+		return 99;
+
+	t = tagsOpen (tags, &info);
+	unlink (tags);
+	if (t != NULL || info.status.error_number != TagErrnoUnexpectedFormat)
+	{
+		fprintf (stderr, "unexpected result (t: %p, error: %d)\n",
+				 (void *) t, info.status.error_number);
+		if (t)
+			tagsClose (t);
+		return 1;
+	}
+	fprintf (stderr, "not opened as expected\n");
+	return 0;
+}
+
+int
+main (void)
+{
+	int r = test_truncated ();
+	if (r)
+		return r;
+
+	r = test_bad_version ();
+	if (r)
+		return r;
+
+	for (unsigned int i = 0; i < COUNT (brokens); i++)
+	{
+		r = test_broken (brokens + i);
+		if (r)
+			return r;
+	}
+	return 0;
+}
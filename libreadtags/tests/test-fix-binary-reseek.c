@@ -0,0 +1,211 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released into the public domain.
+*
+*   Testing moving the file position back and forth in a binary tag stream
+*/
+
+#include "readtags.h"
+#include "test-binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct expectation {
+	const char *name;
+	const char *file;
+	const char *pattern;
+	unsigned long lineNumber;
+	const char *kind;
+	const char *key;
+	const char *value;
+};
+
+static struct expectation main_input = {
+	.name = "main",
+	.file = "input.c",
+	.pattern = "/^int main (void)$/",
+	.lineNumber = 3,
+	.kind = "function",
+	.key = "typeref",
+	.value = "typename:int",
+};
+
+static struct expectation x_input = {
+	.name = "x",
+	.file = "input.c",
+	.pattern = "/^struct point { int x; };$/",
+	.lineNumber = 1,
+	.kind = "member",
+	.key = "scope",
+	.value = "struct:point",
+};
+
+static struct expectation stdio_input = {
+	.name = "stdio.h",
+	.file = "input.c",
+	.pattern = "4",
+	.lineNumber = 4,
+	.kind = "header",
+	.key = "roles",
+	.value = "system",
+};
+
+static struct expectation main_other = {
+	.name = "main",
+	.file = "other.c",
+	.pattern = "/^static int main (int argc)$/",
+	.lineNumber = 7,
+	.kind = "function",
+};
+
+static int
+check_entry (const char *what, tagResult r, tagEntry *e, struct expectation *x)
+{
+	fprintf (stderr, "%s: \"%s\"...", what, x->name);
+	if (r != TagSuccess)
+	{
+		fprintf (stderr, "not found\n");
+		return 1;
+	}
+	if (strcmp (e->name, x->name) != 0
+		|| strcmp (e->file, x->file) != 0
+		|| strcmp (e->address.pattern, x->pattern) != 0
+		|| e->address.lineNumber != x->lineNumber
+		|| e->kind == NULL
+		|| strcmp (e->kind, x->kind) != 0)
+	{
+		fprintf (stderr, "unexpected entry: %s %s %s %lu %s\n",
+				 e->name, e->file, e->address.pattern,
+				 e->address.lineNumber, e->kind? e->kind: "(null)");
+		return 1;
+	}
+	if (x->key == NULL)
+	{
+		if (e->fields.count != 0)
+		{
+			fprintf (stderr, "unexpected field: %s\n", e->fields.list [0].key);
+			return 1;
+		}
+	}
+	else if (e->fields.count != 1
+			 || strcmp (e->fields.list [0].key, x->key) != 0
+			 || strcmp (e->fields.list [0].value, x->value) != 0)
+	{
+		fprintf (stderr, "unexpected fields (count: %u)\n", e->fields.count);
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+	return 0;
+}
+
+static int
+check_end (const char *what, tagFile *t, tagResult r)
+{
+	fprintf (stderr, "%s: the end...", what);
+	if (r != TagFailure)
+	{
+		fprintf (stderr, "found unexpectedly\n");
+		return 1;
+	}
+	if (tagsGetErrno (t) != 0)
+	{
+		fprintf (stderr, "unexpected error: %d\n", tagsGetErrno (t));
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+	return 0;
+}
+
+static int
+check_all (tagFile *t)
+{
+	tagEntry e;
+
+	if (check_entry ("tagsFirst", tagsFirst (t, &e), &e, &main_input)
+		|| check_entry ("tagsNext", tagsNext (t, &e), &e, &x_input)
+		|| check_entry ("tagsNext", tagsNext (t, &e), &e, &stdio_input)
+		|| check_entry ("tagsNext", tagsNext (t, &e), &e, &main_other)
+		|| check_end ("tagsNext", t, tagsNext (t, &e)))
+		return 1;
+	return 0;
+}
+
+static int
+run (const char *tags)
+{
+	tagFile *t;
+	tagFileInfo info;
+	tagEntry e;
+
+	fprintf (stderr, "opening %s...", tags);
+	t = tagsOpen (tags, &info);
+	if (t == NULL || info.status.opened == 0)
+	{
+		fprintf (stderr, "failed (error: %d)\n", info.status.error_number);
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+
+	/* Reach the end before walking from the first tag. */
+	if (check_entry ("tagsFind", tagsFind (t, &e, "stdio.h", TAG_FULLMATCH),
+					 &e, &stdio_input)
+		|| check_all (t))
+		goto failure;
+
+	if (check_entry ("tagsFind", tagsFind (t, &e, "main", TAG_FULLMATCH),
+					 &e, &main_input)
+		|| check_entry ("tagsFindNext", tagsFindNext (t, &e), &e, &main_other)
+		|| check_end ("tagsFindNext", t, tagsFindNext (t, &e)))
+		goto failure;
+
+	/* Go back after finding the last one. */
+	if (check_all (t))
+		goto failure;
+
+	fprintf (stderr, "tagsFirstPseudoTag...");
+	if (tagsFirstPseudoTag (t, &e) != TagSuccess
+		|| strcmp (e.name, "!_TAG_PROGRAM_NAME") != 0
+		|| strcmp (e.file, "Universal Ctags") != 0
+		|| strcmp (e.address.pattern, "/Derived from Exuberant Ctags/") != 0)
+	{
+		fprintf (stderr, "unexpected result\n");
+		goto failure;
+	}
+	fprintf (stderr, "ok\n");
+	if (check_end ("tagsNextPseudoTag", t, tagsNextPseudoTag (t, &e)))
+		goto failure;
+
+	/* Go forward after rewinding for the pseudo tags. */
+	if (check_entry ("tagsFind", tagsFind (t, &e, "x", TAG_FULLMATCH), &e, &x_input)
+		|| check_entry ("tagsNext", tagsNext (t, &e), &e, &stdio_input)
+		|| check_all (t))
+		goto failure;
+
+	tagsClose (t);
+	return 0;
+
+ failure:
+	tagsClose (t);
+	return 1;
+}
+
+int
+main (void)
+{
+	struct stream s;
+	char *tags;
+	int r;
+
+	make_sample (&s);
+	tags = write_stream (&s, s.len);
+	if (tags == NULL)
+		return 99;
+
+	r = run (tags);
+	unlink (tags);
+	return r;
+}
@@ -0,0 +1,337 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains the functions for --dedup-inputs: detecting input
+*   files parsed before under another name.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "dedup_p.h"
+#include "debug.h"
+#include "entry_p.h"
+#include "field.h"
+#include "htable.h"
+#include "options_p.h"
+#include "parse_p.h"
+#include "ptrarray.h"
+#include "read_p.h"
+#include "routines.h"
+#include "writer_p.h"
+#include "xtag.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+struct sDedupInput {
+	char *fileName;
+	langType language;
+
+	bool hasInode;
+	dev_t dev;
+	ino_t ino;
+	off_t fileSize;
+	time_t mtime;
+	time_t ctime;
+
+	unsigned long size;
+	uint64_t hash;
+
+	/* The tags captured for --dedup-inputs=reuse */
+	unsigned char *tags;
+	size_t tagsLength;
+	unsigned long anonymousNames;
+};
+
+/*
+*   DATA DEFINITIONS
+*/
+static ptrArray *Inputs;			/* owns the inputs */
+static hashTable *InputsByInode;
+static hashTable *InputsByContents;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void deleteInput (void *data)
+{
+	dedupInput *input = data;
+
+	eFree (input->fileName);
+	if (input->tags)
+		eFree (input->tags);
+	eFree (input);
+}
+
+/* Inputs having the same key in these tables have the same base name and
+ * language; the base name and the language decide the tags a parser
+ * makes from the same contents. */
+static bool isSameNameAndLanguage (const dedupInput *a, const dedupInput *b)
+{
+	return (a->language == b->language
+			&& strcmp (baseFilename (a->fileName), baseFilename (b->fileName)) == 0);
+}
+
+static unsigned int hashInode (const void *const key)
+{
+	const dedupInput *input = key;
+	return (unsigned int) (input->ino ^ ((uint64_t) input->dev << 5));
+}
+
+static bool isSameInode (const void *a, const void *b)
+{
+	const dedupInput *x = a, *y = b;
+	return (x->dev == y->dev && x->ino == y->ino
+			&& isSameNameAndLanguage (x, y));
+}
+
+static unsigned int hashContents (const void *const key)
+{
+	const dedupInput *input = key;
+	return (unsigned int) (input->hash ^ (input->hash >> 32));
+}
+
+static bool isSameContentsHash (const void *a, const void *b)
+{
+	const dedupInput *x = a, *y = b;
+	return (x->hash == y->hash && x->size == y->size
+			&& isSameNameAndLanguage (x, y));
+}
+
+/* FNV-1a */
+static uint64_t hashBytes (uint64_t h, const unsigned char *p, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= p[i];
+		h *= UINT64_C(1099511628211);
+	}
+	return h;
+}
+
+static void fillContentsHash (dedupInput *input, MIO *mio)
+{
+	uint64_t h = UINT64_C(14695981039346656037);
+	const unsigned char *data;
+	size_t len;
+
+	data = mio_memory_get_data (mio, &len);
+	if (data)
+	{
+		h = hashBytes (h, data, len);
+		input->size = len;
+	}
+	else
+	{
+		unsigned char buf [BUFSIZ];
+
+		input->size = 0;
+		mio_rewind (mio);
+		while ((len = mio_read (mio, buf, 1, sizeof (buf))) > 0)
+		{
+			h = hashBytes (h, buf, len);
+			input->size += len;
+		}
+		mio_rewind (mio);
+	}
+	input->hash = h;
+}
+
+/* The hash may collide; compare the contents. */
+static bool isSameContents (const char *const fileName, MIO *mio)
+{
+	MIO *other = mio_new_file (fileName, "rb");
+	unsigned char a [BUFSIZ], b [BUFSIZ];
+	bool same = true;
+
+	if (other == NULL)
+		return false;
+
+	mio_rewind (mio);
+	while (same)
+	{
+		size_t n = mio_read (mio, a, 1, sizeof (a));
+		size_t m = mio_read (other, b, 1, n > 0? n: 1);
+
+		if (n != m || memcmp (a, b, n) != 0)
+			same = false;
+		else if (n == 0)
+			break;
+	}
+	mio_rewind (mio);
+	mio_unref (other);
+	return same;
+}
+
+/* An inode can be rewritten, or freed and given to another file, after
+ * the input was parsed; its status must not have changed since then. */
+static bool isSameStatus (const dedupInput *a, const dedupInput *b)
+{
+	return (a->fileSize == b->fileSize
+			&& a->mtime == b->mtime && a->ctime == b->ctime);
+}
+
+static dedupInput *findInput (dedupInput *key, MIO *mio)
+{
+	dedupInput *input;
+
+	/* An input is not a duplicate of itself; a name given twice is
+	 * parsed twice as without --dedup-inputs. */
+	if (key->hasInode)
+	{
+		input = hashTableGetItem (InputsByInode, key);
+		if (input && isSameStatus (input, key)
+			&& strcmp (input->fileName, key->fileName) != 0)
+			return input;
+	}
+
+	fillContentsHash (key, mio);
+	input = hashTableGetItem (InputsByContents, key);
+	if (input && strcmp (input->fileName, key->fileName) != 0
+		&& isSameContents (input->fileName, mio))
+		return input;
+
+	return NULL;
+}
+
+static bool canDedupInputs (void)
+{
+	if (Option.dedupInputs == DEDUP_INPUTS_NO
+		|| Option.filter || Option.interactive)
+		return false;
+
+	/* The input field is the only field rewritten. The epoch field of a
+	 * file tag is the one of its input. */
+	if (Option.dedupInputs == DEDUP_INPUTS_REUSE
+		&& (Option.lineDirectives
+			|| (isXtagEnabled (XTAG_FILE_NAMES) && isFieldEnabled (FIELD_EPOCH))
+			|| !writerCanRewriteInput ()))
+		return false;
+
+	return true;
+}
+
+extern bool dedupStartInput (const char *const fileName, langType language,
+							 MIO *mio, dedupInput **input)
+{
+	dedupInput key;
+	dedupInput *found;
+
+	*input = NULL;
+	if (!canDedupInputs ())
+		return false;
+
+	if (Inputs == NULL)
+	{
+		Inputs = ptrArrayNew (deleteInput);
+		InputsByInode = hashTableNew (1021, hashInode, isSameInode, NULL, NULL);
+		InputsByContents = hashTableNew (1021, hashContents, isSameContentsHash,
+										 NULL, NULL);
+	}
+
+	memset (&key, 0, sizeof (key));
+	key.fileName = (char *) fileName;
+	key.language = language;
+#ifndef _WIN32
+	/* st_ino is not for identifying a file on Windows. */
+	struct stat status;
+	if (stat (fileName, &status) == 0)
+	{
+		key.hasInode = true;
+		key.dev = status.st_dev;
+		key.ino = status.st_ino;
+		key.fileSize = status.st_size;
+		key.mtime = status.st_mtime;
+		key.ctime = status.st_ctime;
+	}
+#endif
+
+	MIO *own = NULL;
+	if (mio == NULL)
+	{
+		mio = own = getMio (fileName, "rb", false);
+		if (mio == NULL)
+			return false;
+	}
+	found = findInput (&key, mio);
+	if (own)
+		mio_unref (own);
+
+	if (found)
+	{
+		if (Option.dedupInputs == DEDUP_INPUTS_SKIP)
+		{
+			verbose ("skipping %s (the same as %s)\n", fileName, found->fileName);
+			return true;
+		}
+		else if (found->tags
+				 && rewriteTagsForInput (found->tags, found->tagsLength,
+										 fileName, language))
+		{
+			verbose ("reusing the tags of %s for %s\n", found->fileName, fileName);
+			return true;
+		}
+		/* Parse it; the first one stays in the tables. */
+		return false;
+	}
+
+	*input = xMalloc (1, dedupInput);
+	**input = key;
+	(*input)->fileName = eStrdup (fileName);
+	ptrArrayAdd (Inputs, *input);
+	if ((*input)->hasInode)
+		hashTablePutItem (InputsByInode, *input, *input);
+	hashTablePutItem (InputsByContents, *input, *input);
+
+	if (Option.dedupInputs == DEDUP_INPUTS_REUSE)
+	{
+		(*input)->anonymousNames = countAnonymousNames ();
+		beginTagCapture ();
+	}
+	return false;
+}
+
+extern void dedupEndInput (dedupInput *input)
+{
+	if (input == NULL)
+		return;
+
+	if (Option.dedupInputs != DEDUP_INPUTS_REUSE)
+		return;
+
+	input->tags = endTagCapture (&input->tagsLength);
+
+	/* The tags having anonymous names are not for another input name. */
+	if (input->tags && input->anonymousNames != countAnonymousNames ())
+	{
+		eFree (input->tags);
+		input->tags = NULL;
+		input->tagsLength = 0;
+	}
+}
+
+extern void dedupResetInputs (void)
+{
+	if (Inputs == NULL)
+		return;
+
+	hashTableDelete (InputsByContents);
+	hashTableDelete (InputsByInode);
+	ptrArrayDelete (Inputs);
+	InputsByContents = NULL;
+	InputsByInode = NULL;
+	Inputs = NULL;
+}
@@ -0,0 +1,49 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Detecting input files parsed before under another name.
+*/
+#ifndef CTAGS_MAIN_DEDUP_PRIVATE_H
+#define CTAGS_MAIN_DEDUP_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "mio.h"
+#include "types.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sDedupInput dedupInput;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* With --dedup-inputs, an input is a duplicate of an input parsed before
+ * if both have the same base name, the same language, and the same
+ * contents: either they are the same file (the same device and inode,
+ * not changed since parsed), or the contents have the same hash and
+ * compare equal. An input is never a duplicate of one with the same
+ * name.
+ *
+ * Returns true if FILENAME, opened as MIO, is a duplicate; its tags are
+ * written again under FILENAME, or nothing is done for --dedup-inputs=skip.
+ * Otherwise FILENAME should be parsed between this call and
+ * dedupEndInput (*INPUT). MIO is rewound; it can be NULL if FILENAME is
+ * not opened yet. */
+extern bool dedupStartInput (const char *const fileName, langType language,
+							 MIO *mio, dedupInput **input);
+extern void dedupEndInput (dedupInput *input);
+
+/* Forgets the inputs parsed so far. Called when options change the
+ * tags an input makes, and before --watch updates the tag file. */
+extern void dedupResetInputs (void);
+
+#endif	/* CTAGS_MAIN_DEDUP_PRIVATE_H */
@@ -0,0 +1,452 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains the directory walker scanning a directory tree in
+*   a thread ahead of the parsers.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "dirwalk_p.h"
+
+#ifdef HAVE_DIR_WALKER
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "debug.h"
+#include "error_p.h"
+#include "options_p.h"
+#include "readahead_p.h"
+#include "routines.h"
+
+/*
+*   MACROS
+*/
+
+/* The number of entries the walker may be ahead of the parsers. */
+#define DIR_WALKER_QUEUE_SIZE 4096
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/* The walker thread must not call eMalloc() and friends, which are
+ * hooked for --totals=json, nor error(). It allocates entries with
+ * malloc(3); the consumer frees them with dirWalkerEntryDelete(). */
+struct sDirWalker {
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t readable;
+	pthread_cond_t writable;
+
+	dirWalkerEntry *queue [DIR_WALKER_QUEUE_SIZE];
+	unsigned int head;
+	unsigned int count;
+
+	bool stop;			/* set by the consumer to stop the walker */
+	bool finished;		/* set by the walker at the end */
+	bool broken;		/* the walker ran out of memory */
+
+	char *root;
+	unsigned int depth;
+	unsigned int maxDepth;
+
+	/* The read-ahead window: the files hinted but not taken yet */
+	unsigned int aheadFiles;
+	size_t aheadBytes;
+	unsigned int aheadDepth;
+	size_t aheadBudget;
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+/* Runs in the walker thread. Returns false if the consumer stopped the
+ * walker; ENTRY is freed then. */
+static bool pushEntry (dirWalker *walker, dirWalkerEntry *entry)
+{
+	bool r = true;
+
+	pthread_mutex_lock (&walker->mutex);
+	while (walker->count == DIR_WALKER_QUEUE_SIZE && !walker->stop)
+		pthread_cond_wait (&walker->writable, &walker->mutex);
+
+	if (walker->stop)
+		r = false;
+	else
+	{
+		walker->queue [(walker->head + walker->count) % DIR_WALKER_QUEUE_SIZE] = entry;
+		walker->count++;
+		pthread_cond_signal (&walker->readable);
+	}
+	pthread_mutex_unlock (&walker->mutex);
+
+	if (!r)
+		dirWalkerEntryDelete (entry);
+	return r;
+}
+
+static dirWalkerEntry *newEntry (dirWalker *walker, char *path)
+{
+	dirWalkerEntry *entry;
+
+	if (path == NULL)
+	{
+		walker->broken = true;
+		return NULL;
+	}
+
+	entry = calloc (1, sizeof (dirWalkerEntry));
+	if (entry == NULL)
+	{
+		free (path);
+		walker->broken = true;
+		return NULL;
+	}
+	entry->path = path;
+	return entry;
+}
+
+/* The same as combinePathAndFile () except "." is not prefixed, as
+ * recurseUsingOpendir () does. */
+static char *joinPath (const char *const dirPath, const char *const name)
+{
+	if (strcmp (dirPath, ".") == 0)
+		return strdup (name);
+
+	size_t len = strlen (dirPath);
+	size_t nameLen = strlen (name);
+	bool terminated = (len > 0 && dirPath [len - 1] == OUTPUT_PATH_SEPARATOR);
+	char *path = malloc (len + 1 + nameLen + 1);
+
+	if (path == NULL)
+		return NULL;
+
+	memcpy (path, dirPath, len);
+	if (len > 0 && !terminated)
+		path [len++] = OUTPUT_PATH_SEPARATOR;
+	memcpy (path + len, name, nameLen + 1);
+	return path;
+}
+
+/* Fills the status of ENTRY, named NAME in DIR. Returns true if the walker
+ * should descend into it. */
+static bool statEntry (dirWalker *walker, dirWalkerEntry *entry,
+					   DIR *dir, struct dirent *d, unsigned int depth)
+{
+	bool isDirectory;
+
+#ifdef DT_DIR
+	if (d->d_type == DT_DIR)
+	{
+		/* Nothing but these is used for a directory. */
+		entry->status.exists = true;
+		entry->status.isDirectory = true;
+		isDirectory = true;
+	}
+	else
+#endif
+	{
+		struct stat lstatus, status;
+		bool lstatOK, statOK = false;
+
+		lstatOK = (fstatat (dirfd (dir), d->d_name, &lstatus, AT_SYMLINK_NOFOLLOW) == 0);
+		if (!lstatOK)
+			entry->statErrno = errno;
+		else if (S_ISLNK (lstatus.st_mode))
+		{
+			statOK = (fstatat (dirfd (dir), d->d_name, &status, 0) == 0);
+			if (!statOK)
+				entry->statErrno = errno;
+		}
+		fillFileStatus (&entry->status, lstatOK? &lstatus: NULL, statOK? &status: NULL);
+		isDirectory = lstatOK && S_ISDIR (lstatus.st_mode);
+	}
+
+	return isDirectory && depth + 1 <= walker->maxDepth;
+}
+
+#ifdef HAVE_READ_AHEAD
+/* Hints ENTRY, NAME in DIR, for read-ahead if it is an input file and
+ * the window has room for it; waits for the room. Returns false if the
+ * consumer stopped the walker. */
+static bool readAheadEntry (dirWalker *walker, dirWalkerEntry *entry,
+							DIR *dir, const char *const name)
+{
+	size_t length;
+	bool stop;
+
+	if (walker->aheadDepth == 0
+		|| !entry->status.isNormalFile || entry->status.size == 0
+		|| (entry->status.isSymbolicLink && !Option.followLinks)
+		|| isExcludedFile (entry->path, false))
+		return true;
+
+	length = (entry->status.size < walker->aheadBudget)
+		? entry->status.size: walker->aheadBudget;
+
+	pthread_mutex_lock (&walker->mutex);
+	while (!walker->stop
+		   && (walker->aheadFiles >= walker->aheadDepth
+			   || (walker->aheadBytes > 0
+				   && walker->aheadBytes + length > walker->aheadBudget)))
+		pthread_cond_wait (&walker->writable, &walker->mutex);
+
+	stop = walker->stop;
+	if (!stop)
+	{
+		walker->aheadFiles++;
+		walker->aheadBytes += length;
+		entry->readAhead = length;
+	}
+	pthread_mutex_unlock (&walker->mutex);
+
+	if (!stop)
+		readAheadFileAt (dirfd (dir), name, length);
+	return !stop;
+}
+#endif
+
+/* Queues ENTRY for a directory opened as FD, and then the entries in it.
+ * OPENERRNO is errno of opening the directory if FD is negative.
+ * Returns false if the walker should stop. */
+static bool walkDirectory (dirWalker *walker, dirWalkerEntry *entry,
+						   int fd, int openErrno, unsigned int depth)
+{
+	DIR *dir = NULL;
+	char *dirPath = strdup (entry->path);
+	bool r = true;
+
+	if (dirPath == NULL)
+	{
+		walker->broken = true;
+		dirWalkerEntryDelete (entry);
+		if (fd >= 0)
+			close (fd);
+		return false;
+	}
+
+	if (fd < 0)
+		entry->openErrno = openErrno;
+	else if ((dir = fdopendir (fd)) == NULL)
+	{
+		entry->openErrno = errno;
+		close (fd);
+	}
+	entry->descended = true;
+
+	if (!pushEntry (walker, entry))
+		r = false;
+
+	struct dirent *d;
+	while (r && dir && (d = readdir (dir)) != NULL)
+	{
+		if (strcmp (d->d_name, ".") == 0 || strcmp (d->d_name, "..") == 0)
+			continue;
+
+		dirWalkerEntry *child = newEntry (walker, joinPath (dirPath, d->d_name));
+		if (child == NULL)
+		{
+			r = false;
+			break;
+		}
+
+		if (isExcludedFile (child->path, true))
+		{
+			child->excluded = true;
+			r = pushEntry (walker, child);
+		}
+		else if (statEntry (walker, child, dir, d, depth))
+		{
+			int childFd = openat (dirfd (dir), d->d_name,
+								  O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+			r = walkDirectory (walker, child, childFd, errno, depth + 1);
+		}
+		else
+		{
+#ifdef HAVE_READ_AHEAD
+			if (!readAheadEntry (walker, child, dir, d->d_name))
+			{
+				dirWalkerEntryDelete (child);
+				r = false;
+				break;
+			}
+#endif
+			r = pushEntry (walker, child);
+		}
+	}
+
+	if (dir)
+		closedir (dir);
+
+	if (r)
+	{
+		/* The end of the directory */
+		dirWalkerEntry *end = calloc (1, sizeof (dirWalkerEntry));
+		if (end == NULL)
+		{
+			walker->broken = true;
+			r = false;
+		}
+		else
+			r = pushEntry (walker, end);
+	}
+
+	free (dirPath);
+	return r;
+}
+
+static void *walkerMain (void *data)
+{
+	dirWalker *walker = data;
+	dirWalkerEntry *root = newEntry (walker, strdup (walker->root));
+
+	if (root)
+	{
+		int fd = open (walker->root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		walkDirectory (walker, root, fd, errno, walker->depth);
+	}
+
+	pthread_mutex_lock (&walker->mutex);
+	walker->finished = true;
+	pthread_cond_signal (&walker->readable);
+	pthread_mutex_unlock (&walker->mutex);
+	return NULL;
+}
+
+extern dirWalker *dirWalkerNew (const char *const dirName,
+								unsigned int depth, unsigned int maxDepth)
+{
+	dirWalker *walker = xCalloc (1, dirWalker);
+
+	walker->root = eStrdup (dirName);
+	walker->depth = depth;
+	walker->maxDepth = maxDepth;
+	if (Option.readAheadBytes > 0)
+	{
+		walker->aheadDepth = Option.readAheadFiles;
+		walker->aheadBudget = Option.readAheadBytes;
+	}
+
+	/* Compile the patterns here; isExcludedFile() is called in the
+	 * walker thread. */
+	compileExcludePatterns ();
+
+	pthread_mutex_init (&walker->mutex, NULL);
+	pthread_cond_init (&walker->readable, NULL);
+	pthread_cond_init (&walker->writable, NULL);
+
+	if (pthread_create (&walker->thread, NULL, walkerMain, walker) != 0)
+	{
+		pthread_cond_destroy (&walker->writable);
+		pthread_cond_destroy (&walker->readable);
+		pthread_mutex_destroy (&walker->mutex);
+		eFree (walker->root);
+		eFree (walker);
+		return NULL;
+	}
+
+	return walker;
+}
+
+extern dirWalkerEntry *dirWalkerNext (dirWalker *walker)
+{
+	dirWalkerEntry *entry = NULL;
+	bool broken = false;
+
+	pthread_mutex_lock (&walker->mutex);
+	while (walker->count == 0 && !walker->finished)
+		pthread_cond_wait (&walker->readable, &walker->mutex);
+
+	if (walker->count > 0)
+	{
+		entry = walker->queue [walker->head];
+		walker->head = (walker->head + 1) % DIR_WALKER_QUEUE_SIZE;
+		walker->count--;
+		if (entry->readAhead > 0)
+		{
+			walker->aheadFiles--;
+			walker->aheadBytes -= entry->readAhead;
+		}
+		pthread_cond_signal (&walker->writable);
+	}
+	else
+		broken = true;
+	pthread_mutex_unlock (&walker->mutex);
+
+	if (broken)
+		error (FATAL, "out of memory while walking directories under \"%s\"",
+			   walker->root);
+
+	if (entry->path == NULL)
+	{
+		/* The end of the directory */
+		dirWalkerEntryDelete (entry);
+		return NULL;
+	}
+	return entry;
+}
+
+extern void dirWalkerSkip (dirWalker *walker, dirWalkerEntry *entry)
+{
+	dirWalkerEntry *child;
+
+	if (!entry->descended || entry->consumed)
+		return;
+
+	while ((child = dirWalkerNext (walker)) != NULL)
+	{
+		dirWalkerSkip (walker, child);
+		dirWalkerEntryDelete (child);
+	}
+	entry->consumed = true;
+}
+
+extern void dirWalkerEntryDelete (dirWalkerEntry *entry)
+{
+	free (entry->path);
+	free (entry);
+}
+
+extern void dirWalkerDelete (dirWalker *walker)
+{
+	pthread_mutex_lock (&walker->mutex);
+	walker->stop = true;
+	pthread_cond_signal (&walker->writable);
+	pthread_mutex_unlock (&walker->mutex);
+
+	pthread_join (walker->thread, NULL);
+
+	while (walker->count > 0)
+	{
+		dirWalkerEntryDelete (walker->queue [walker->head]);
+		walker->head = (walker->head + 1) % DIR_WALKER_QUEUE_SIZE;
+		walker->count--;
+	}
+
+	pthread_cond_destroy (&walker->writable);
+	pthread_cond_destroy (&walker->readable);
+	pthread_mutex_destroy (&walker->mutex);
+	eFree (walker->root);
+	eFree (walker);
+}
+
+#endif	/* HAVE_DIR_WALKER */
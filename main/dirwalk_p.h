@@ -0,0 +1,69 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Defines the interface to the directory walker used for --recurse.
+*/
+#ifndef CTAGS_MAIN_DIRWALK_PRIVATE_H
+#define CTAGS_MAIN_DIRWALK_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "routines_p.h"
+
+#if defined (HAVE_PTHREAD) && defined (HAVE_OPENDIR) && defined (HAVE_DIRENT_H) \
+	&& defined (HAVE_OPENAT) && defined (HAVE_FSTATAT) && defined (HAVE_FDOPENDIR)
+#define HAVE_DIR_WALKER 1
+#endif
+
+#ifdef HAVE_DIR_WALKER
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/* A directory walker scans a directory tree in a thread of its own, ahead
+ * of the parsers, and queues the entries in the order a depth-first walk
+ * with readdir(3) visits them. It also reads the input files ahead as
+ * --read-ahead option specifies.
+ *
+ * The entries of a directory the walker descends into follow the entry
+ * for the directory itself; dirWalkerNext() returns NULL at the end of
+ * them. The walker descends into a directory that is not a symbolic link,
+ * not excluded by isExcludedFile (name, true), and not deeper than the
+ * limit given to dirWalkerNew(). */
+typedef struct sDirWalker dirWalker;
+
+typedef struct sDirWalkerEntry {
+	char *path;
+	bool excluded;		/* isExcludedFile (path, true); status is not filled */
+	bool descended;		/* the entries of this directory follow */
+	int openErrno;		/* errno of opening this directory if descended */
+	int statErrno;		/* errno of stat(2) if !status.exists */
+	bool consumed;		/* the entries of this directory are taken */
+	size_t readAhead;	/* bytes hinted for read-ahead */
+	fileStatus status;	/* status.name is always NULL */
+} dirWalkerEntry;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* DEPTH is the depth of DIRNAME; the walker descends into directories
+ * not deeper than MAXDEPTH. The first entry is for DIRNAME itself.
+ * NULL is returned if a thread cannot be created. */
+extern dirWalker *dirWalkerNew (const char *const dirName,
+								unsigned int depth, unsigned int maxDepth);
+extern dirWalkerEntry *dirWalkerNext (dirWalker *walker);
+extern void dirWalkerSkip (dirWalker *walker, dirWalkerEntry *entry);
+extern void dirWalkerEntryDelete (dirWalkerEntry *entry);
+extern void dirWalkerDelete (dirWalker *walker);
+
+#endif	/* HAVE_DIR_WALKER */
+
+#endif	/* CTAGS_MAIN_DIRWALK_PRIVATE_H */
@@ -43,6 +43,7 @@
 #include "entry_p.h"
 #include "field.h"
 #include "fmt_p.h"
+#include "htable.h"
 #include "kind.h"
 #include "interval_tree_generic.h"
 #include "nestlevel.h"
@@ -56,6 +57,8 @@
 #include "parse_p.h"
 #include "ptrarray.h"
 #include "sort_p.h"
+#include "stats_p.h"
+#include "trace-event_p.h"
 #include "strlist.h"
 #include "subparser_p.h"
 #include "trashbox.h"
@@ -89,6 +92,7 @@ typedef struct eTagFile {
 	char *name;
 	char *directory;
 	MIO *mio;
+	MIO *capturedMio;	/* the tag file while capturing tags in mio */
 	struct sNumTags { unsigned long added, prev; } numTags;
 	struct sMax { size_t line, tag; } max;
 	vString *vLine;
@@ -98,9 +102,15 @@ typedef struct eTagFile {
 	ptrArray *corkQueue;
 	struct rb_root intervaltab;
 
-	bool patternCacheValid;
+	hashTable *patternCache;	/* line number -> patternCacheEntry */
 } tagFile;
 
+typedef struct sPatternCacheEntry {
+	MIOPos location;
+	bool boundaryStart;
+	vString *pattern;
+} patternCacheEntry;
+
 typedef struct sTagEntryInfoX  {
 	tagEntryInfo slot;
 	int corkIndex;
@@ -118,6 +128,7 @@ static tagFile TagFile = {
 	NULL,               /* tag file name */
 	NULL,               /* tag file directory (absolute) */
 	NULL,               /* file pointer */
+	NULL,               /* capturedMio */
 	{ 0, 0 },           /* numTags */
 	{ 0, 0 },        /* max */
 	NULL,                /* vLine */
@@ -130,7 +141,7 @@ static tagFile TagFile = {
 	 *   main\entry.c(128) : error C2099: initializer is not a constant
 	 *
 	 */
-	.patternCacheValid = false,
+	.patternCache = NULL,
 };
 
 static bool TagsToStdout = false;
@@ -162,6 +173,11 @@ extern void freeTagFileResources (void)
 	if (TagFile.directory != NULL)
 		eFree (TagFile.directory);
 	vStringDelete (TagFile.vLine);
+	if (TagFile.patternCache)
+	{
+		hashTableDelete (TagFile.patternCache);
+		TagFile.patternCache = NULL;
+	}
 }
 
 extern const char *tagFileName (void)
@@ -391,7 +407,9 @@ static bool isTagFile (const char *const filename)
 		if (line == NULL)
 			ok = true;
 		else
-			ok = (bool) (isCtagsLine (line) || isEtagsLine (line));
+			ok = (bool) (isCtagsLine (line) || isEtagsLine (line)
+						 || strncmp (line, BINARY_TAGS_MAGIC,
+									 BINARY_TAGS_MAGIC_LENGTH - 2) == 0);
 		mio_unref (mio);
 	}
 	return ok;
@@ -409,7 +427,9 @@ extern void openTagFile (void)
 	 */
 	if (TagsToStdout)
 	{
-		if (Option.interactive == INTERACTIVE_SANDBOX)
+		/* In interactive mode, the tags are kept in memory until they
+		 * are passed to the client; see streamTagFile (). */
+		if (Option.interactive)
 		{
 			TagFile.mio = mio_new_memory (NULL, 0, eRealloc, eFreeNoNullCheck);
 			TagFile.name = NULL;
@@ -451,7 +471,8 @@ extern void openTagFile (void)
 			}
 			else
 			{
-				TagFile.mio = mio_new_file (TagFile.name, "w");
+				TagFile.mio = mio_new_file (TagFile.name,
+											writerIsBinary ()? "wb": "w");
 				if (TagFile.mio != NULL && isXtagEnabled (XTAG_PSEUDO_TAGS))
 					addCommonPseudoTags ();
 			}
@@ -573,6 +594,115 @@ static void sortTagFile (void)
 	}
 }
 
+/*  In interactive mode, pass the tags accumulated so far to the client
+ *  without waiting for closeTagFile (). This must be called only between
+ *  input files: while parsing, a parser may ask for a rescan, and the tags
+ *  of the failed pass are discarded by truncating the tag file.
+ */
+extern void streamTagFile (void)
+{
+	if (! (Option.interactive && TagsToStdout && TagFile.mio)
+		|| Option.sorted != SO_UNSORTED)
+		return;
+
+	catFile (TagFile.mio);
+	mio_try_resize (TagFile.mio, 0);
+	mio_seek (TagFile.mio, 0, SEEK_SET);
+}
+
+/*  Write the tags of an input to memory as well as to the tag file.
+ *  endTagCapture () returns them. This must be called only between input
+ *  files.
+ */
+extern void beginTagCapture (void)
+{
+	Assert (TagFile.capturedMio == NULL);
+
+	/* mini-geany doesn't set TagFile.mio. */
+	if (TagFile.mio == NULL)
+		return;
+
+	TagFile.capturedMio = TagFile.mio;
+	TagFile.mio = mio_new_memory (NULL, 0, eRealloc, eFreeNoNullCheck);
+}
+
+extern unsigned char *endTagCapture (size_t *length)
+{
+	MIO *mio = TagFile.mio;
+	unsigned char *data, *tags;
+
+	*length = 0;
+	if (TagFile.capturedMio == NULL)
+		return NULL;
+
+	TagFile.mio = TagFile.capturedMio;
+	TagFile.capturedMio = NULL;
+
+	data = mio_memory_get_data (mio, length);
+	tags = eMalloc (*length? *length: 1);
+	if (*length > 0)
+	{
+		memcpy (tags, data, *length);
+		mio_write (TagFile.mio, data, 1, *length);
+		abort_if_ferror (TagFile.mio);
+	}
+	mio_unref (mio);
+
+	return tags;
+}
+
+/*  Write TAGS, captured with endTagCapture () for another input having
+ *  the same contents, again for FILENAME. Only the input field is
+ *  rewritten. Returns false if the writer cannot do so.
+ */
+extern bool rewriteTagsForInput (const unsigned char *const tags, size_t length,
+								 const char *const fileName, langType language)
+{
+	vString *tagPath;
+	tagEntryInfo tag;
+
+	if (!writerCanRewriteInput ())
+		return false;
+
+	tagPath = newInputFileTagPath (fileName);
+	if (strpbrk (vStringValue (tagPath), "\t\n") != NULL)
+	{
+		/* Let the writer reject the tags as it does. */
+		vStringDelete (tagPath);
+		return false;
+	}
+
+#ifdef _WIN32
+	if (getFilenameSeparator(Option.useSlashAsFilenameSeparator) == FILENAME_SEP_USE_SLASH)
+		vStringTranslate (tagPath, PATH_SEPARATOR, OUTPUT_PATH_SEPARATOR);
+#endif
+
+	memset (&tag, 0, sizeof (tag));
+	tag.inputFileName = vStringValue (tagPath);
+	tag.langType = language;
+
+	const char *line = (const char *) tags;
+	const char *end = line + length;
+	while (line < end)
+	{
+		const char *eol = memchr (line, '\n', end - line);
+		size_t lineLength = eol? (size_t) (eol - line) + 1: (size_t) (end - line);
+		const char *tab = memchr (line, '\t', lineLength);
+		int l = writerRewriteInput (TagFile.mio, line, lineLength, &tag);
+
+		if (l > 0)
+		{
+			++TagFile.numTags.added;
+			rememberMaxLengths (tab? (size_t) (tab - line): lineLength, (size_t) l);
+		}
+		line += lineLength;
+	}
+	abort_if_ferror (TagFile.mio);
+
+	vStringDelete (tagPath);
+	return true;
+}
+
 static void resizeTagFile (const long newSize)
 {
 	int result;
@@ -647,7 +777,15 @@ extern void closeTagFile (const bool resize)
 				TagFile.name? TagFile.name: "<mio>", size, desiredSize); )
 		resizeTagFile (desiredSize);
 	}
+
+	statsStamp stamp;
+	const char *allocationTag = setAllocationTag ("sort");
+	startStatsTimer (STATS_TIMER_SORT, &stamp);
+	beginTraceEvent ("sort", NULL, NULL);
 	sortTagFile ();
+	endTraceEvent ();
+	stopStatsTimer (STATS_TIMER_SORT, &stamp);
+	setAllocationTag (allocationTag);
 	if (TagsToStdout)
 	{
 		if (mio_unref (TagFile.mio) != 0)
@@ -746,7 +884,8 @@ extern char *readLineFromBypassForTag (vString *const vLine, const tagEntryInfo
 									   long *const pSeekValue)
 {
 	Assert (isPosSet (tag->filePosition) || (tag->pattern == NULL));
-	return readLineFromBypass (vLine, tag->filePosition, pSeekValue);
+	return readLineFromBypass (vLine, tag->lineNumber, tag->filePosition,
+							   pSeekValue);
 }
 
 /*  Truncates the text line containing the tag at the character following the
@@ -872,6 +1011,49 @@ extern void getTagScopeInformation (tagEntryInfo *const tag,
 }
 
 
+static void patternCacheEntryDelete (void *data)
+{
+	patternCacheEntry *entry = data;
+	vStringDelete (entry->pattern);
+	eFree (entry);
+}
+
+/* Patterns are cached per input line. Cork-mode parsers emit tags
+ * long after the lines are read; without the cache, every tag on
+ * a line already seen would read the line and escape it again. */
+static patternCacheEntry *getPatternCacheEntry (const tagEntryInfo *const tag,
+												bool *found)
+{
+	void *key = (void *)(uintptr_t)tag->lineNumber;
+	patternCacheEntry *entry;
+	bool boundaryStart = (tag->boundaryInfo & INPUT_BOUNDARY_START)? true: false;
+
+	if (TagFile.patternCache == NULL)
+		TagFile.patternCache = hashTableNew (1021, hashPtrhash, hashPtreq,
+											 NULL, patternCacheEntryDelete);
+
+	entry = hashTableGetItem (TagFile.patternCache, key);
+	if (entry)
+	{
+		*found = (entry->boundaryStart == boundaryStart
+				  && memcmp (&tag->filePosition, &entry->location,
+							 sizeof(MIOPos)) == 0);
+		if (!*found)
+			vStringClear (entry->pattern);
+	}
+	else
+	{
+		*found = false;
+		entry = xMalloc (1, patternCacheEntry);
+		entry->pattern = vStringNew ();
+		hashTablePutItem (TagFile.patternCache, key, entry);
+	}
+
+	entry->location = tag->filePosition;
+	entry->boundaryStart = boundaryStart;
+	return entry;
+}
+
 static int   makePatternStringCommon (const tagEntryInfo *const tag,
 									  int (* putc_func) (char , void *),
 									  int (* puts_func) (const char* , void *),
@@ -885,16 +1067,18 @@ static int   makePatternStringCommon (const tagEntryInfo *const tag,
 	bool  omitted;
 	size_t line_len;
 
-	bool making_cache = false;
+	patternCacheEntry *cache = NULL;
 	int (* puts_o_func)(const char* , void *);
 	void * o_output;
 
-	static vString *cached_pattern;
-	static MIOPos   cached_location;
-	if (TagFile.patternCacheValid
-		&& (! tag->truncateLineAfterTag)
-		&& (memcmp (&tag->filePosition, &cached_location, sizeof(MIOPos)) == 0))
-		return puts_func (vStringValue (cached_pattern), output);
+	if (! tag->truncateLineAfterTag)
+	{
+		bool found;
+
+		cache = getPatternCacheEntry (tag, &found);
+		if (found)
+			return puts_func (vStringValue (cache->pattern), output);
+	}
 
 	line = readLineFromBypassForTag (TagFile.vLine, tag, NULL);
 	if (line == NULL)
@@ -919,16 +1103,13 @@ static int   makePatternStringCommon (const tagEntryInfo *const tag,
 	searchChar = Option.backward ? '?' : '/';
 	terminator = (line_len > 0 && (line [line_len - 1] == '\n')) ? "$": "";
 
-	if (!tag->truncateLineAfterTag)
+	if (cache)
 	{
-		making_cache = true;
-		cached_pattern = vStringNewOrClearWithAutoRelease (cached_pattern);
-
 		puts_o_func = puts_func;
 		o_output    = output;
 		putc_func   = vstring_putc;
 		puts_func   = vstring_puts;
-		output      = cached_pattern;
+		output      = cache->pattern;
 	}
 
 	length += putc_func(searchChar, output);
@@ -939,12 +1120,8 @@ static int   makePatternStringCommon (const tagEntryInfo *const tag,
 	length += puts_func (omitted? "": terminator, output);
 	length += putc_func (searchChar, output);
 
-	if (making_cache)
-	{
-		puts_o_func (vStringValue (cached_pattern), o_output);
-		cached_location = tag->filePosition;
-		TagFile.patternCacheValid = true;
-	}
+	if (cache)
+		puts_o_func (vStringValue (cache->pattern), o_output);
 
 	return length;
 }
@@ -1585,6 +1762,7 @@ static int queueTagEntry (const tagEntryInfo *const tag)
 
 	int corkIndex;
 	tagEntryInfo * nil = ptrArrayItem (TagFile.corkQueue, 0);
+	const char *allocationTag = setAllocationTag ("cork");
 	tagEntryInfoX * entry = copyTagEntry (tag, nil->inputFileName, nil->sourceFileName,
 										TagFile.corkFlags);
 
@@ -1598,6 +1776,7 @@ static int queueTagEntry (const tagEntryInfo *const tag)
 				   tag->lineNumber,
 				   tag->inputFileName);
 		}
+		setAllocationTag (allocationTag);
 		return CORK_NIL;
 	}
 	warned = false;
@@ -1617,6 +1796,7 @@ static int queueTagEntry (const tagEntryInfo *const tag)
 		intervaltab_insert(entry, &TagFile.intervaltab);
 		entry->slot.inIntevalTab = 1;
 	}
+	setAllocationTag (allocationTag);
 	return corkIndex;
 }
 
@@ -1785,7 +1965,12 @@ static void writeTagEntry (const tagEntryInfo *const tag)
 		buildFqTagCache ( (tagEntryInfo *const)tag);
 	}
 
+	statsStamp stamp;
+	const char *allocationTag = setAllocationTag ("write");
+	startStatsTimer (STATS_TIMER_WRITE, &stamp);
 	length = writerWriteTag (TagFile.mio, tag);
+	stopStatsTimer (STATS_TIMER_WRITE, &stamp);
+	setAllocationTag (allocationTag);
 
 	if (length > 0)
 	{
@@ -1839,6 +2024,7 @@ extern void uncorkTagFile (void)
 	if (TagFile.cork > 0)
 		return ;
 
+	beginTraceEvent ("uncork", NULL, NULL);
 	for (i = 1; i < ptrArrayCount (TagFile.corkQueue); i++)
 	{
 		tagEntryInfo *tag = ptrArrayItem (TagFile.corkQueue, i);
@@ -1863,6 +2049,7 @@ extern void uncorkTagFile (void)
 
 	ptrArrayDelete (TagFile.corkQueue);
 	TagFile.corkQueue = NULL;
+	endTraceEvent ();
 }
 
 extern tagEntryInfo *getEntryInCorkQueue (int n)
@@ -2303,7 +2490,8 @@ extern unsigned long maxTagsLine (void)
 
 extern void invalidatePatternCache (void)
 {
-	TagFile.patternCacheValid = false;
+	if (TagFile.patternCache)
+		hashTableClear (TagFile.patternCache);
 }
 
 extern void tagFilePosition (MIOPos *p)
@@ -30,6 +30,11 @@ extern void freeTagFileResources (void);
 extern const char *tagFileName (void);
 extern void openTagFile (void);
 extern void closeTagFile (const bool resize);
+extern void streamTagFile (void);
+extern void beginTagCapture (void);
+extern unsigned char *endTagCapture (size_t *length);
+extern bool rewriteTagsForInput (const unsigned char *const tags, size_t length,
+								 const char *const fileName, langType language);
 extern void  setupWriter (void *writerClientData);
 extern bool  teardownWriter (const char *inputFilename);
 
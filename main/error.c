@@ -16,6 +16,7 @@
 #include "routines_p.h"
 
 #ifdef HAVE_JANSSON
+#include "interactive_p.h"
 #include <jansson.h>
 #endif
 
@@ -70,16 +71,21 @@ extern void error (const errorSelection selection,
 
 #ifdef HAVE_JANSSON
 bool jsonErrorPrinter (const errorSelection selection, const char *const format, va_list ap,
-					   void *data CTAGS_ATTR_UNUSED)
+					   void *data)
 {
 #define ERR_BUFFER_SIZE 4096
 	static char reason[ERR_BUFFER_SIZE];
+	struct interactiveModeArgs *iargs = data;
+	int err = errno;
 
 	vsnprintf (reason, ERR_BUFFER_SIZE, format, ap);
 	reason [ERR_BUFFER_SIZE - 1] = '\0'; /* Do we need this? */
 
 	json_t *response = json_object ();
 	json_object_set_new (response, "_type", json_string ("error"));
+	if (iargs && iargs->requestId)
+		json_object_set_new (response, "id",
+							 json_loads (iargs->requestId, JSON_DECODE_ANY, NULL));
 	json_object_set_new (response, "message", json_string (reason));
 	if (selected (selection, NOTICE))
 		json_object_set_new (response, "notice", json_true ());
@@ -89,8 +95,8 @@ bool jsonErrorPrinter (const errorSelection selection, const char *const format,
 		json_object_set_new (response, "fatal", json_true ());
 	if (selected (selection, PERROR))
 	{
-		json_object_set_new (response, "errno", json_integer (errno));
-		json_object_set_new (response, "perror", json_string (strerror (errno)));
+		json_object_set_new (response, "errno", json_integer (err));
+		json_object_set_new (response, "perror", json_string (strerror (err)));
 	}
 	json_dumpf (response, stdout, JSON_PRESERVE_ORDER);
 	fprintf (stdout, "\n");
@@ -464,6 +464,10 @@ static unsigned int       fieldObjectUsed = 0;
 static unsigned int       fieldObjectAllocated = 0;
 static fieldObject* fieldObjects = NULL;
 
+/* Incremented whenever a field is defined or (en|dis)abled.
+ * Writers caching decisions based on the field states compare this. */
+static unsigned int       fieldStateGeneration = 0;
+
 extern void initFieldObjects (void)
 {
 	unsigned int i;
@@ -628,6 +632,14 @@ static const char *renderEscapedString (const char *s,
 					const tagEntryInfo *const tag CTAGS_ATTR_UNUSED,
 					vString* b)
 {
+	/* Most strings need no escaping. Return S as is then. */
+	if (vStringIsEmpty (b))
+	{
+		size_t len = strlen (s);
+		if (findFirstCharToEscape (s, len, '\\') == len)
+			return s;
+	}
+
 	vStringCatSWithEscaping (b, s);
 	return vStringValue (b);
 }
@@ -656,10 +668,16 @@ static const char *renderEscapedName (const bool isTagName,
 	{
 		/* Find the first byte needing escaping for the warning message */
 		const char *p = s;
+		size_t len = strlen (p);
+		size_t n;
 
-		while (*p > 0x1F && *p != 0x7F)
-			p++;
-		unexpected_byte = *p;
+		while ((n = findFirstCharToEscape (p, len, '\\')) < len
+			   && p [n] == '\\')
+		{
+			p += n + 1;
+			len -= n + 1;
+		}
+		unexpected_byte = (unsigned char) p [n];
 	}
 
 	if (unexpected_byte)
@@ -1237,6 +1255,7 @@ extern bool enableField (fieldType type, bool state)
 	fieldDefinition *def = getFieldObject(type)->def;
 	bool old = def->enabled;
 	getFieldObject(type)->def->enabled = state;
+	fieldStateGeneration++;
 
 	if (isCommonField (type))
 		verbose ("enable field \"%s\": %s\n",
@@ -1250,6 +1269,11 @@ extern bool enableField (fieldType type, bool state)
 	return old;
 }
 
+extern unsigned int getFieldStateGeneration (void)
+{
+	return fieldStateGeneration;
+}
+
 extern bool isCommonField (fieldType type)
 {
 	return (FIELD_BUILTIN_LAST < type)? false: true;
@@ -1336,6 +1360,7 @@ extern int defineField (fieldDefinition *def, langType language)
 	}
 	fobj = fieldObjects + (fieldObjectUsed);
 	def->ftype = fieldObjectUsed++;
+	fieldStateGeneration++;
 
 	if (def->render == NULL)
 	{
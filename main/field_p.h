@@ -50,6 +50,9 @@ extern fieldType getFieldTypeForNameAndLanguage (const char *fieldName, langType
 extern bool enableField (fieldType type, bool state);
 extern bool isCommonField (fieldType type);
 
+/* Changed when a field is defined, enabled or disabled. */
+extern unsigned int getFieldStateGeneration (void);
+
 /* Return LANG_IGNORE if the field is a common field.*/
 extern langType getFieldLanguage (fieldType type);
 
@@ -0,0 +1,289 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains functions for matching file names against a
+*   compiled set of patterns.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fnmatch.h>
+
+#include "debug.h"
+#include "globset_p.h"
+#include "htable.h"
+#include "ptrarray.h"
+#include "read.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+struct globNode {
+	unsigned char c;			/* the character on the edge from the parent */
+	bool isStar;				/* reached with '*'; loops on any character */
+	bool accepting;
+	struct globNode *children;	/* edges for literal characters */
+	struct globNode *sibling;
+	struct globNode *any;		/* the edge for '?' */
+	struct globNode *star;		/* the edge for '*' */
+};
+
+struct sGlobSet {
+	hashTable *literals;
+	struct globNode *root;
+	ptrArray *nodes;
+	stringList *globs;			/* the patterns in the trie */
+	stringList *others;
+};
+
+/* The automaton runs on sets of states in fixed arrays so that matching
+ * doesn't allocate; the directory walker matches names in its own thread.
+ * If a set overflows, the patterns in the trie are tried with fnmatch(). */
+#define GLOB_STATES_MAX 64
+
+struct globStates {
+	unsigned int count;
+	bool overflow;
+	struct globNode *nodes [GLOB_STATES_MAX];
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static char *newNormalizedPattern (const char *const pattern)
+{
+#ifdef CASE_INSENSITIVE_FILENAMES
+	return newUpperString (pattern);
+#else
+	return eStrdup (pattern);
+#endif
+}
+
+#if defined (CASE_INSENSITIVE_FILENAMES) || defined (_WIN32)
+#define NEED_FILE_NAME_NORMALIZATION
+/* Normalizes FILENAME into BUF of SIZE bytes, or into a block from
+ * malloc(3) if it doesn't fit. Matching runs in the directory walker
+ * thread, which must not call eMalloc() and friends. Returns NULL if
+ * no memory is left. */
+static char *normalizeFileName (const char *const fileName, char *buf, size_t size)
+{
+	size_t len = strlen (fileName);
+	char *r = (len < size)? buf: malloc (len + 1);
+
+	if (r == NULL)
+		return NULL;
+
+	for (size_t i = 0; i <= len; i++)
+	{
+		char c = fileName [i];
+#ifdef CASE_INSENSITIVE_FILENAMES
+		c = (char) toupper ((unsigned char) c);
+#endif
+#if defined (_WIN32)
+		if (c == PATH_SEPARATOR)
+			c = OUTPUT_PATH_SEPARATOR;
+#endif
+		r [i] = c;
+	}
+	return r;
+}
+#endif
+
+static struct globNode *globNodeNew (globSet *set, unsigned char c, bool isStar)
+{
+	struct globNode *node = xCalloc (1, struct globNode);
+	node->c = c;
+	node->isStar = isStar;
+	ptrArrayAdd (set->nodes, node);
+	return node;
+}
+
+static struct globNode *globNodeChild (globSet *set, struct globNode *node, unsigned char c)
+{
+	struct globNode *child;
+
+	for (child = node->children; child; child = child->sibling)
+		if (child->c == c)
+			return child;
+
+	child = globNodeNew (set, c, false);
+	child->sibling = node->children;
+	node->children = child;
+	return child;
+}
+
+static void addGlobPattern (globSet *set, const char *const pattern)
+{
+	struct globNode *node = set->root;
+
+	for (const char *p = pattern; *p; p++)
+	{
+		if (*p == '*')
+		{
+			/* "**" is the same as "*". */
+			if (!node->isStar)
+			{
+				if (node->star == NULL)
+					node->star = globNodeNew (set, '*', true);
+				node = node->star;
+			}
+		}
+		else if (*p == '?')
+		{
+			if (node->any == NULL)
+				node->any = globNodeNew (set, '?', false);
+			node = node->any;
+		}
+		else
+			node = globNodeChild (set, node, (unsigned char) *p);
+	}
+	node->accepting = true;
+}
+
+extern globSet *globSetNew (const stringList *const patterns)
+{
+	globSet *set = xMalloc (1, globSet);
+
+	set->literals = hashTableNew (127, hashCstrhash, hashCstreq, eFree, NULL);
+	set->nodes = ptrArrayNew (eFree);
+	set->root = globNodeNew (set, '\0', false);
+	set->globs = stringListNew ();
+	set->others = stringListNew ();
+
+	for (unsigned int i = 0; patterns && i < stringListCount (patterns); i++)
+	{
+		char *pattern = newNormalizedPattern (vStringValue (stringListItem (patterns, i)));
+
+		if (strpbrk (pattern, "[\\"))
+			stringListAdd (set->others, vStringNewOwn (pattern));
+		else if (strpbrk (pattern, "*?"))
+		{
+			addGlobPattern (set, pattern);
+			stringListAdd (set->globs, vStringNewOwn (pattern));
+		}
+		else if (hashTableHasItem (set->literals, pattern))
+			eFree (pattern);
+		else
+			hashTablePutItem (set->literals, pattern, pattern);
+	}
+
+	return set;
+}
+
+extern void globSetDelete (globSet *set)
+{
+	hashTableDelete (set->literals);
+	ptrArrayDelete (set->nodes);
+	stringListDelete (set->globs);
+	stringListDelete (set->others);
+	eFree (set);
+}
+
+static void addGlobState (struct globStates *states, struct globNode *node)
+{
+	for (unsigned int i = 0; i < states->count; i++)
+		if (states->nodes [i] == node)
+			return;
+
+	if (states->count == GLOB_STATES_MAX)
+	{
+		states->overflow = true;
+		return;
+	}
+	states->nodes [states->count++] = node;
+
+	/* '*' matches the empty string. */
+	if (node->star)
+		addGlobState (states, node->star);
+}
+
+static bool matchPatterns (const stringList *const patterns, const char *const str)
+{
+	for (unsigned int i = 0; i < stringListCount (patterns); i++)
+		if (fnmatch (vStringValue (stringListItem (patterns, i)), str, 0) == 0)
+			return true;
+	return false;
+}
+
+static bool runGlobAutomaton (const globSet *const set, const char *const str)
+{
+	struct globStates states [2];
+	struct globStates *current = states, *next = states + 1;
+
+	current->count = 0;
+	current->overflow = false;
+	addGlobState (current, set->root);
+	for (const char *p = str; *p && current->count > 0; p++)
+	{
+		const unsigned char c = (unsigned char) *p;
+
+		next->count = 0;
+		next->overflow = current->overflow;
+		for (unsigned int i = 0; i < current->count; i++)
+		{
+			struct globNode *node = current->nodes [i];
+
+			if (node->isStar)
+				addGlobState (next, node);
+			if (node->any)
+				addGlobState (next, node->any);
+			for (struct globNode *child = node->children; child; child = child->sibling)
+			{
+				if (child->c == c)
+				{
+					addGlobState (next, child);
+					break;
+				}
+			}
+		}
+
+		struct globStates *tmp = current;
+		current = next;
+		next = tmp;
+	}
+
+	for (unsigned int i = 0; i < current->count; i++)
+		if (current->nodes [i]->accepting)
+			return true;
+
+	if (current->overflow)
+		return matchPatterns (set->globs, str);
+	return false;
+}
+
+extern bool globSetMatched (const globSet *const set, const char *const fileName)
+{
+#ifdef NEED_FILE_NAME_NORMALIZATION
+	char buf [256];
+	char *str = normalizeFileName (fileName, buf, sizeof (buf));
+
+	/* Out of memory; the name is taken as not matched. */
+	if (str == NULL)
+		return false;
+#else
+	const char *str = fileName;
+#endif
+	bool r;
+
+	r = hashTableHasItem (set->literals, str)
+		|| runGlobAutomaton (set, str)
+		|| matchPatterns (set->others, str);
+
+#ifdef NEED_FILE_NAME_NORMALIZATION
+	if (str != buf)
+		free (str);
+#endif
+	return r;
+}
@@ -0,0 +1,45 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   A set of file name patterns compiled for matching many names.
+*/
+#ifndef CTAGS_MAIN_GLOBSET_PRIVATE_H
+#define CTAGS_MAIN_GLOBSET_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "strlist.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sGlobSet globSet;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* globSetMatched (globSetNew (list), str) is the same as
+ * stringListFileMatched (list, str): patterns are matched with fnmatch()
+ * semantics, case-insensitively on platforms where file names are.
+ *
+ * Patterns without glob meta characters are stored in a hash table.
+ * Patterns using only '*' and '?' are merged into a trie that is run
+ * as a nondeterministic automaton, so the cost of a match depends on
+ * the length of the name rather than on the number of patterns. The
+ * rest, patterns having '[' or '\\', are passed to fnmatch() one by
+ * one.
+ *
+ * globSetMatched() doesn't call eMalloc() and friends; the directory
+ * walker calls it in its own thread. */
+extern globSet *globSetNew (const stringList *const patterns);
+extern void globSetDelete (globSet *set);
+extern bool globSetMatched (const globSet *const set, const char *const fileName);
+
+#endif  /* CTAGS_MAIN_GLOBSET_PRIVATE_H */
@@ -13,10 +13,22 @@
 #include "options_p.h"
 #include "routines.h"
 
+#if defined(HAVE_FORK) && defined(HAVE_POLL_H) && defined(HAVE_SYS_WAIT_H)
+#define HAVE_INTERACTIVE_WORKERS 1
+#ifdef HAVE_SYS_UN_H
+#define HAVE_INTERACTIVE_DAEMON 1
+#endif
+#endif
 
 struct interactiveModeArgs
 {
 	bool sandbox;
+	unsigned int workers;		/* --_interactive-workers */
+	char *socketPath;			/* --_daemon */
+
+	/* The "id" member of the request being served, in JSON notation.
+	   NULL if the request has no id. */
+	const char *requestId;
 };
 
 void interactiveLoop (cookedArgs *args, void *user);
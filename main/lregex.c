@@ -34,6 +34,7 @@
 #include "htable.h"
 #include "kind.h"
 #include "options.h"
+#include "options_p.h"
 #include "optscript.h"
 #include "parse_p.h"
 #include "promise.h"
@@ -42,6 +43,7 @@
 #include "routines.h"
 #include "routines_p.h"
 #include "script_p.h"
+#include "stats_p.h"
 #include "trace.h"
 #include "trashbox.h"
 #include "xtag_p.h"
@@ -139,7 +141,15 @@ struct mTableActionSpec {
 };
 
 typedef struct {
+	/* pattern.code is NULL until the pattern is used first.
+	 * regex_src is freed after compiling it. regex_table_index and
+	 * regex_index tell where the pattern was added, for reporting
+	 * an error in compiling it. */
 	regexCompiledCode pattern;
+	char *regex_src;
+	int regex_flags;
+	int regex_table_index;
+	unsigned int regex_index;
 	enum pType type;
 	bool exclusive;
 	bool accept_empty_name;
@@ -191,6 +201,8 @@ typedef struct {
 	struct {
 		unsigned int match;
 		unsigned int unmatch;
+		unsigned int tags;
+		double time;			/* spent in matching; only with --_regex-profile */
 	} statistics;
 } regexTableEntry;
 
@@ -253,6 +265,11 @@ typedef struct {
 static OptVM *optvm;
 static EsObject *lregex_dict = es_nil;
 
+/* The number of tag entries regex patterns passed to makeTagEntry () so far.
+ * makeTagEntry () returns CORK_NIL for a written tag when the cork queue
+ * is not in use, so this also counts tags dropped there. */
+static unsigned int madeTagCount;
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -329,7 +346,10 @@ static void deletePattern (regexPattern *p)
 	if (p->refcount > 0)
 		return;
 
-	p->pattern.backend->delete_code (p->pattern.code);
+	if (p->pattern.code)
+		p->pattern.backend->delete_code (p->pattern.code);
+	if (p->regex_src)
+		eFree (p->regex_src);
 
 	if (p->type == PTRN_TAG)
 	{
@@ -1573,8 +1593,12 @@ static struct flagDefsDescriptor choose_backend (const char *flags, enum regexPa
 	return desc;
 }
 
-static regexCompiledCode compileRegex (enum regexParserType regptype,
-									   const char* const regexp, const char* const flags)
+/* Only the backend and its flags are decided here. Compiling a regex
+ * is deferred to compilePatternMaybe(); a run using a few parsers
+ * should not pay for compiling the patterns of all the others, and of
+ * the optlib parsers loaded with options files. */
+static regexCompiledCode prepareRegex (enum regexParserType regptype,
+									   const char* const flags, int *backendFlags)
 {
 	struct flagDefsDescriptor desc = choose_backend (flags, regptype, false);
 
@@ -1589,7 +1613,47 @@ static regexCompiledCode compileRegex (enum regexParserType regptype,
 			   ARRAY_SIZE (backendCommonRegexFlagDefs),
 			   &desc);
 
-	return desc.backend->compile (desc.backend, regexp, desc.flags);
+	*backendFlags = desc.flags;
+	return (regexCompiledCode) { .backend = desc.backend, .code = NULL };
+}
+
+static void reportBrokenPattern (struct lregexControlBlock *lcb, enum pType type,
+								 const char *const regex, int table_index, unsigned int index)
+{
+	error (WARNING, "pattern: %s", regex);
+	if (type == PTRN_CALLBACK)
+		error (WARNING, "language: %s", getLanguageName (lcb->owner));
+	else if (table_index != TABLE_INDEX_UNUSED)
+	{
+		struct regexTable *table = ptrArrayItem (lcb->tables, table_index);
+		error (WARNING, "table: %s[%u]", table->name, index);
+		error (WARNING, "language: %s", getLanguageName (lcb->owner));
+	}
+	else
+		error (WARNING, "language: %s[%u]", getLanguageName (lcb->owner), index);
+}
+
+static bool compilePatternMaybe (struct lregexControlBlock *lcb, regexPattern *ptrn)
+{
+	if (ptrn->pattern.code)
+		return true;
+
+	/* Compiling failed before. */
+	if (ptrn->regex_src == NULL)
+		return false;
+
+	regexCompiledCode cp = ptrn->pattern.backend->compile (ptrn->pattern.backend,
+														   ptrn->regex_src,
+														   ptrn->regex_flags);
+	if (cp.code == NULL)
+		reportBrokenPattern (lcb, ptrn->type, ptrn->regex_src,
+							 ptrn->regex_table_index, ptrn->regex_index);
+	else
+		ptrn->pattern.code = cp.code;
+
+	eFree (ptrn->regex_src);
+	ptrn->regex_src = NULL;
+	return (ptrn->pattern.code != NULL);
 }
 
 
@@ -1863,6 +1927,7 @@ static void matchTagPattern (struct lregexControlBlock *lcb,
 			markTagExtraBit (&e, XTAG_ANONYMOUS);
 
 		n = makeTagEntry (&e);
+		madeTagCount++;
 
 		trashBoxMakeEmpty(field_trashbox);
 	}
@@ -1995,6 +2060,17 @@ static bool fillGuestRequest (const char *start,
 	return guestRequestIsFilled (guest_req);
 }
 
+static double startMatchClock (void)
+{
+	return Option.regexProfile? statsWallClock (): 0.0;
+}
+
+static void stopMatchClock (regexTableEntry *entry, double start)
+{
+	if (Option.regexProfile)
+		entry->statistics.time += statsWallClock () - start;
+}
+
 static bool matchRegexPattern (struct lregexControlBlock *lcb,
 							   const vString* const line,
 							   regexTableEntry *entry)
@@ -2008,10 +2084,16 @@ static bool matchRegexPattern (struct lregexControlBlock *lcb,
 	if (patbuf->disabled && *(patbuf->disabled))
 		return false;
 
+	if (!compilePatternMaybe (lcb, patbuf))
+		return false;
+
+	unsigned int tags = madeTagCount;
+	double since = startMatchClock ();
 	match = patbuf->pattern.backend->match (patbuf->pattern.backend,
 											patbuf->pattern.code, vStringValue (line),
 											vStringLength (line),
 											pmatch);
+	stopMatchClock (entry, since);
 
 	if (match == 0)
 	{
@@ -2069,6 +2151,7 @@ static bool matchRegexPattern (struct lregexControlBlock *lcb,
 	}
 	else
 		entry->statistics.unmatch++;
+	entry->statistics.tags += madeTagCount - tags;
 	return result;
 }
 
@@ -2092,13 +2175,19 @@ static bool matchMultilineRegexPattern (struct lregexControlBlock *lcb,
 	if (patbuf->disabled && *(patbuf->disabled))
 		return false;
 
+	if (!compilePatternMaybe (lcb, patbuf))
+		return false;
+
+	unsigned int tags = madeTagCount;
 	current = start = vStringValue (allLines);
 	do
 	{
+		double since = startMatchClock ();
 		match = patbuf->pattern.backend->match (patbuf->pattern.backend,
 												patbuf->pattern.code, current,
 												vStringLength (allLines) - (current - start),
 												pmatch);
+		stopMatchClock (entry, since);
 
 		if (match != 0)
 		{
@@ -2173,6 +2262,7 @@ static bool matchMultilineRegexPattern (struct lregexControlBlock *lcb,
 
 	} while (current < start + vStringLength (allLines));
 
+	entry->statistics.tags += madeTagCount - tags;
 	return result;
 }
 
@@ -2331,7 +2421,8 @@ static regexPattern *addTagRegexInternal (struct lregexControlBlock *lcb,
 					  const char* const name,
 					  const char* const kinds,
 					  const char* const flags,
-					  bool *disabled)
+					  bool *disabled,
+					  bool compileNow)
 {
 	Assert (regex != NULL);
 	Assert (name != NULL);
@@ -2339,20 +2430,19 @@ static regexPattern *addTagRegexInternal (struct lregexControlBlock *lcb,
 	if (!regexAvailable)
 		return NULL;
 
-	regexCompiledCode cp = compileRegex (regptype, regex, flags);
-	if (cp.code == NULL)
+	unsigned int index = (table_index != TABLE_INDEX_UNUSED)
+		? ptrArrayCount (((struct regexTable *) ptrArrayItem (lcb->tables, table_index))->entries)
+		: ptrArrayCount (lcb->entries[regptype]);
+	int backendFlags;
+	regexCompiledCode cp = prepareRegex (regptype, flags, &backendFlags);
+	if (compileNow)
 	{
-		error (WARNING, "pattern: %s", regex);
-		if (table_index != TABLE_INDEX_UNUSED)
+		cp = cp.backend->compile (cp.backend, regex, backendFlags);
+		if (cp.code == NULL)
 		{
-			struct regexTable *table = ptrArrayItem (lcb->tables, table_index);
-			error (WARNING, "table: %s[%u]", table->name, ptrArrayCount (table->entries));
-			error (WARNING, "language: %s", getLanguageName (lcb->owner));
+			reportBrokenPattern (lcb, PTRN_TAG, regex, table_index, index);
+			return NULL;
 		}
-		else
-			error (WARNING, "language: %s[%u]", getLanguageName (lcb->owner),
-				   ptrArrayCount (lcb->entries[regptype]));
-		return NULL;
 	}
 
 	char kindLetter;
@@ -2423,6 +2513,13 @@ static regexPattern *addTagRegexInternal (struct lregexControlBlock *lcb,
 												explictly_defined,
 												disabled);
 	rptr->pattern_string = escapeRegexPattern(regex);
+	if (rptr->pattern.code == NULL)
+	{
+		rptr->regex_src = eStrdup (regex);
+		rptr->regex_flags = backendFlags;
+		rptr->regex_table_index = table_index;
+		rptr->regex_index = index;
+	}
 
 	eFree (kindName);
 	if (description)
@@ -2452,7 +2549,7 @@ extern void addTagRegex (struct lregexControlBlock *lcb,
 			 bool *disabled)
 {
 	addTagRegexInternal (lcb, TABLE_INDEX_UNUSED,
-						 REG_PARSER_SINGLE_LINE, regex, name, kinds, flags, disabled);
+						 REG_PARSER_SINGLE_LINE, regex, name, kinds, flags, disabled, false);
 }
 
 extern void addTagMultiLineRegex (struct lregexControlBlock *lcb, const char* const regex,
@@ -2460,7 +2557,7 @@ extern void addTagMultiLineRegex (struct lregexControlBlock *lcb, const char* co
 								  bool *disabled)
 {
 	regexPattern *ptrn = addTagRegexInternal (lcb, TABLE_INDEX_UNUSED,
-											  REG_PARSER_MULTI_LINE, regex, name, kinds, flags, disabled);
+											  REG_PARSER_MULTI_LINE, regex, name, kinds, flags, disabled, false);
 	if (ptrn->mgroup.forLineNumberDetermination == NO_MULTILINE)
 	{
 		if (hasNameSlot(ptrn))
@@ -2483,7 +2580,7 @@ extern void addTagMultiTableRegex(struct lregexControlBlock *lcb,
 		error (FATAL, "unknown table name: %s", table_name);
 
 	addTagRegexInternal (lcb, table_index, REG_PARSER_MULTI_TABLE, regex, name, kinds, flags,
-						 disabled);
+						 disabled, false);
 }
 
 extern void addCallbackRegex (struct lregexControlBlock *lcb,
@@ -2499,17 +2596,14 @@ extern void addCallbackRegex (struct lregexControlBlock *lcb,
 		return;
 
 
-	regexCompiledCode cp = compileRegex (REG_PARSER_SINGLE_LINE, regex, flags);
-	if (cp.code == NULL)
-	{
-		error (WARNING, "pattern: %s", regex);
-		error (WARNING, "language: %s", getLanguageName (lcb->owner));
-		return;
-	}
-
+	int backendFlags;
+	regexCompiledCode cp = prepareRegex (REG_PARSER_SINGLE_LINE, flags, &backendFlags);
 	regexPattern *rptr = addCompiledCallbackPattern (lcb, &cp, callback, flags,
 													 disabled, userData);
 	rptr->pattern_string = escapeRegexPattern(regex);
+	rptr->regex_src = eStrdup (regex);
+	rptr->regex_flags = backendFlags;
+	rptr->regex_table_index = TABLE_INDEX_UNUSED;
 }
 
 static void addTagRegexOption (struct lregexControlBlock *lcb,
@@ -2561,9 +2655,11 @@ static void addTagRegexOption (struct lregexControlBlock *lcb,
 
 	if (parseTagRegex (regptype, regex_pat, &name, &kinds, &flags))
 	{
+		/* A broken pattern given by the user is reported here, before
+		 * its kind is defined. */
 		regexPattern *ptrn = addTagRegexInternal (lcb, table_index, regptype, regex_pat, name, kinds, flags,
-												  NULL);
-		if (regptype == REG_PARSER_MULTI_LINE
+												  NULL, true);
+		if (ptrn && regptype == REG_PARSER_MULTI_LINE
 			&& ptrn->mgroup.forLineNumberDetermination == NO_MULTILINE)
 		{
 			if (hasNameSlot(ptrn))
@@ -2711,6 +2807,26 @@ extern bool lregexControlBlockHasAny(struct lregexControlBlock *lcb)
 			|| ptrArrayCount(lcb->entries[REG_PARSER_SINGLE_LINE]));
 }
 
+static void compilePatternsInEntries (struct lregexControlBlock *lcb, ptrArray *entries)
+{
+	for (unsigned int i = 0; i < ptrArrayCount (entries); i++)
+	{
+		regexTableEntry *entry = ptrArrayItem (entries, i);
+		compilePatternMaybe (lcb, entry->pattern);
+	}
+}
+
+extern void compileRegexPatterns (struct lregexControlBlock *lcb)
+{
+	compilePatternsInEntries (lcb, lcb->entries[REG_PARSER_SINGLE_LINE]);
+	compilePatternsInEntries (lcb, lcb->entries[REG_PARSER_MULTI_LINE]);
+	for (unsigned int i = 0; i < ptrArrayCount (lcb->tables); i++)
+	{
+		struct regexTable *table = ptrArrayItem (lcb->tables, i);
+		compilePatternsInEntries (lcb, table->entries);
+	}
+}
+
 extern bool regexNeedsMultilineBuffer (struct lregexControlBlock *lcb)
 {
 	if  (ptrArrayCount(lcb->entries [REG_PARSER_MULTI_LINE]) > 0)
@@ -2933,12 +3049,18 @@ static struct regexTable * matchMultitableRegexTable (struct lregexControlBlock
 		if (ptrn->disabled && *(ptrn->disabled))
 			continue;
 
+		if (!compilePatternMaybe (lcb, ptrn))
+			continue;
+
+		double since = startMatchClock ();
 		match = ptrn->pattern.backend->match (ptrn->pattern.backend,
 											  ptrn->pattern.code, current,
 											  vStringLength(start) - (current - cstart),
 											  pmatch);
+		stopMatchClock (entry, since);
 		if (match == 0)
 		{
+			unsigned int tags = madeTagCount;
 			entry->statistics.match++;
 			scriptWindow window = {
 				.line = current,
@@ -2968,6 +3090,7 @@ static struct regexTable * matchMultitableRegexTable (struct lregexControlBlock
 					- cstart;
 				matchTagPattern (lcb, current, ptrn, pmatch, offset_for_tag,
 								 (ptrn->optscript && hasNameSlot (ptrn))? &window: NULL);
+				entry->statistics.tags += madeTagCount - tags;
 
 				struct mTableActionSpec *taction = (window.taction.action == TACTION_NOP)
 					? &(ptrn->taction)
@@ -3165,6 +3288,74 @@ extern void printMultitableStatistics (struct lregexControlBlock *lcb)
 	}
 }
 
+extern struct colprintTable * regexProfileColprintTableNew (void)
+{
+	return colprintTableNew ("R:TIME", "R:ATTEMPTS", "R:MATCHES", "R:TAGS",
+							 "L:LANGUAGE", "L:TYPE", "L:TABLE", "L:PATTERN", NULL);
+}
+
+static void regexProfileColprintAddEntry (struct colprintTable *table,
+										  struct lregexControlBlock *lcb,
+										  const char *type, const char *tableName,
+										  regexTableEntry *entry)
+{
+	unsigned int attempts = entry->statistics.match + entry->statistics.unmatch;
+	if (attempts == 0)
+		return;
+
+	struct colprintLine *line = colprintTableGetNewLine (table);
+	char time [32];
+
+	snprintf (time, sizeof (time), "%.6f", entry->statistics.time);
+	colprintLineAppendColumnCString (line, time);
+	colprintLineAppendColumnInt (line, attempts);
+	colprintLineAppendColumnInt (line, entry->statistics.match);
+	colprintLineAppendColumnInt (line, entry->statistics.tags);
+	colprintLineAppendColumnCString (line, getLanguageName (lcb->owner));
+	colprintLineAppendColumnCString (line, type);
+	colprintLineAppendColumnCString (line, tableName);
+	colprintLineAppendColumnCString (line, entry->pattern->pattern_string);
+}
+
+extern void regexProfileColprintAddLines (struct colprintTable *table,
+										  struct lregexControlBlock *lcb)
+{
+	for (unsigned int i = 0; i < ptrArrayCount (lcb->entries [REG_PARSER_SINGLE_LINE]); i++)
+		regexProfileColprintAddEntry (table, lcb, "line", "-",
+									  ptrArrayItem (lcb->entries [REG_PARSER_SINGLE_LINE], i));
+	for (unsigned int i = 0; i < ptrArrayCount (lcb->entries [REG_PARSER_MULTI_LINE]); i++)
+		regexProfileColprintAddEntry (table, lcb, "mline", "-",
+									  ptrArrayItem (lcb->entries [REG_PARSER_MULTI_LINE], i));
+	for (unsigned int i = 0; i < ptrArrayCount (lcb->tables); i++)
+	{
+		struct regexTable *rtable = ptrArrayItem (lcb->tables, i);
+		for (unsigned int j = 0; j < ptrArrayCount (rtable->entries); j++)
+			regexProfileColprintAddEntry (table, lcb, "mtable", rtable->name,
+										  ptrArrayItem (rtable->entries, j));
+	}
+}
+
+static int regexProfileColprintCompareLines (struct colprintLine *a , struct colprintLine *b)
+{
+	double ta = strtod (colprintLineGetColumn (a, 0), NULL);
+	double tb = strtod (colprintLineGetColumn (b, 0), NULL);
+
+	if (ta != tb)
+		return (ta < tb)? 1: -1;
+
+	/* Patterns tried more are costlier when the clock is too coarse. */
+	unsigned long aa = strtoul (colprintLineGetColumn (a, 1), NULL, 10);
+	unsigned long ab = strtoul (colprintLineGetColumn (b, 1), NULL, 10);
+	return (aa < ab)? 1: (aa > ab)? -1: 0;
+}
+
+extern void regexProfileColprintTablePrint (struct colprintTable *table,
+											bool withListHeader, bool machinable, FILE *fp)
+{
+	colprintTableSort (table, regexProfileColprintCompareLines);
+	colprintTablePrint (table, 0, withListHeader, machinable, fp);
+}
+
 extern bool matchMultitableRegex (struct lregexControlBlock *lcb, const vString* const allLines)
 {
 	if (ptrArrayCount (lcb->tables) == 0)
@@ -3532,6 +3723,7 @@ static EsObject* lrop_commit_tag (OptVM *vm, EsObject *name)
 
 	tagEntryInfo *e = es_pointer_get (tag);
 	int corkIndex = makeTagEntry (e);
+	madeTagCount++;
 	EsObject *n = es_integer_new (corkIndex);
 	if (es_error_p (n))
 		return n;
@@ -19,6 +19,7 @@
 *   INCLUDE FILES
 */
 #include "general.h"
+#include "colprint_p.h"
 #include "flags_p.h"
 #include "kind_p.h"
 #include "lregex.h"
@@ -91,6 +92,10 @@ extern void addTagMultiTableRegex(struct lregexControlBlock *lcb,
 
 extern bool lregexControlBlockHasAny(struct lregexControlBlock *lcb);
 
+/* Patterns are compiled when they are used first. This compiles all of
+ * them now, for processes forked to serve requests. */
+extern void compileRegexPatterns (struct lregexControlBlock *lcb);
+
 extern bool matchRegex (struct lregexControlBlock *lcb, const vString* const line, bool postrun);
 extern bool regexIsPostRun (struct lregexControlBlock *lcb);
 
@@ -119,6 +124,13 @@ extern void propagateParamToOptscript (struct lregexControlBlock *lcb, const cha
 
 extern void printMultitableStatistics (struct lregexControlBlock *lcb);
 
+/* for --_regex-profile */
+extern struct colprintTable * regexProfileColprintTableNew (void);
+extern void regexProfileColprintAddLines (struct colprintTable *table,
+										  struct lregexControlBlock *lcb);
+extern void regexProfileColprintTablePrint (struct colprintTable *table,
+											bool withListHeader, bool machinable, FILE *fp);
+
 extern void basic_regex_flag_short (char c, void* data);
 extern void basic_regex_flag_long (const char* const s, const char* const unused, void* data);
 extern void extend_regex_flag_short (char c, void* data);
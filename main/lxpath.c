@@ -11,18 +11,67 @@
 #include "general.h"  /* must always come first */
 #include "debug.h"
 #include "entry.h"
+#include "field.h"
 #include "lxpath_p.h"
 #include "options.h"
 #include "parse_p.h"
+#include "ptrarray.h"
 #include "read.h"
 #include "read_p.h"
 #include "routines.h"
 #include "xtag.h"
 
+#include <string.h>
+
 #ifdef HAVE_LIBXML
 #include <libxml/parser.h>
 #include <libxml/xpath.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
+
+typedef enum {
+	XPATH_STREAM_CHILD,
+	XPATH_STREAM_DESCENDANT,
+} xpathStreamAxis;
+
+typedef struct sXpathStreamPredicate {
+	bool localName;		/* [local-name()='NAME'] if true, [@NAME] or [@NAME='VALUE'] if false */
+	char *name;
+	char *value;
+} xpathStreamPredicate;
+
+typedef struct sXpathStreamStep {
+	xpathStreamAxis axis;
+	char *name;			/* NULL for * */
+	ptrArray *predicates;
+} xpathStreamStep;
+
+struct sXpathStreamPath {
+	bool absolute;
+	ptrArray *steps;
+	xpathStreamAxis attrAxis;
+	char *attr;			/* NULL if the xpath is for elements */
+};
+
+typedef struct sXpathStreamMatch {
+	char *name;
+	unsigned long lineNumber;
+} xpathStreamMatch;
+
+typedef struct sXpathStreamEntry {
+	langType language;
+	int tableTableIndex;
+	const tagXpathTable *elt;
+	ptrArray *matches;		/* NULL for the first entry */
+} xpathStreamEntry;
+
+struct sXpathStream {
+	ptrArray *entries;
+
+	bool checked;		/* by checkXpathStreamInput */
+	bool wellFormed;
+	char *rootName;		/* the local name of the root element, by peekXpathStreamRoot */
+};
 
 extern  void updateXMLTagLine (tagEntryInfo *e, xmlNode *node)
 {
@@ -77,6 +126,202 @@ out:
 	xmlFree (str);
 }
 
+static void deleteXpathStreamPredicate (void *data)
+{
+	xpathStreamPredicate *pred = data;
+
+	if (pred->name)
+		eFree (pred->name);
+	if (pred->value)
+		eFree (pred->value);
+	eFree (pred);
+}
+
+static void deleteXpathStreamStep (void *data)
+{
+	xpathStreamStep *step = data;
+
+	if (step->name)
+		eFree (step->name);
+	ptrArrayDelete (step->predicates);
+	eFree (step);
+}
+
+static void deleteXpathStreamPath (struct sXpathStreamPath *path)
+{
+	ptrArrayDelete (path->steps);
+	if (path->attr)
+		eFree (path->attr);
+	eFree (path);
+}
+
+static char *parseXpathStreamName (const char **p)
+{
+	const char *start = *p;
+
+	while (isalnum ((unsigned char) **p)
+		   || **p == '-' || **p == '_' || **p == '.')
+		(*p)++;
+
+	if (*p == start)
+		return NULL;
+	return eStrndup (start, *p - start);
+}
+
+static char *parseXpathStreamLiteral (const char **p)
+{
+	const char q = **p;
+	const char *start, *end;
+
+	if (q != '\'' && q != '"')
+		return NULL;
+
+	start = *p + 1;
+	end = strchr (start, q);
+	if (end == NULL)
+		return NULL;
+
+	*p = end + 1;
+	return eStrndup (start, end - start);
+}
+
+static xpathStreamPredicate *parseXpathStreamPredicate (const char **p)
+{
+	static const char localName[] = "local-name()=";
+	xpathStreamPredicate *pred = xCalloc (1, xpathStreamPredicate);
+
+	Assert (**p == '[');
+	(*p)++;
+
+	if (strncmp (*p, localName, strlen (localName)) == 0)
+	{
+		*p += strlen (localName);
+		pred->localName = true;
+		pred->name = parseXpathStreamLiteral (p);
+		if (pred->name == NULL)
+			goto fail;
+	}
+	else if (**p == '@')
+	{
+		(*p)++;
+		pred->name = parseXpathStreamName (p);
+		if (pred->name == NULL)
+			goto fail;
+		if (**p == '=')
+		{
+			(*p)++;
+			pred->value = parseXpathStreamLiteral (p);
+			if (pred->value == NULL)
+				goto fail;
+		}
+	}
+	else
+		goto fail;
+
+	if (**p != ']')
+		goto fail;
+	(*p)++;
+	return pred;
+
+ fail:
+	deleteXpathStreamPredicate (pred);
+	return NULL;
+}
+
+static int skipXpathStreamSlashes (const char **p)
+{
+	int n = 0;
+
+	while (**p == '/')
+	{
+		(*p)++;
+		n++;
+	}
+	return n;
+}
+
+/* Returns NULL if XPATH is not in the subset that can be matched
+ * while streaming. */
+static struct sXpathStreamPath *compileXpathStreamPath (const char *xpath)
+{
+	struct sXpathStreamPath *path = xCalloc (1, struct sXpathStreamPath);
+	const char *p = xpath;
+	xpathStreamAxis axis = XPATH_STREAM_CHILD;
+	int slashes;
+
+	path->steps = ptrArrayNew (deleteXpathStreamStep);
+
+	if (*p == '/')
+		path->absolute = true;
+	else if (*p == '.')
+	{
+		p++;
+		if (*p != '/')
+			goto fail;
+	}
+
+	/* libxml2 takes /// as // . */
+	slashes = skipXpathStreamSlashes (&p);
+	if (slashes > 3)
+		goto fail;
+	else if (slashes >= 2)
+		axis = XPATH_STREAM_DESCENDANT;
+
+	while (true)
+	{
+		xpathStreamStep *step;
+
+		if (*p == '@')
+		{
+			p++;
+			path->attr = parseXpathStreamName (&p);
+			if (path->attr == NULL || *p != '\0')
+				goto fail;
+			path->attrAxis = axis;
+			break;
+		}
+
+		step = xCalloc (1, xpathStreamStep);
+		step->axis = axis;
+		step->predicates = ptrArrayNew (deleteXpathStreamPredicate);
+		ptrArrayAdd (path->steps, step);
+
+		if (*p == '*')
+			p++;
+		else
+		{
+			step->name = parseXpathStreamName (&p);
+			if (step->name == NULL)
+				goto fail;
+		}
+
+		while (*p == '[')
+		{
+			xpathStreamPredicate *pred = parseXpathStreamPredicate (&p);
+			if (pred == NULL)
+				goto fail;
+			ptrArrayAdd (step->predicates, pred);
+		}
+
+		if (*p == '\0')
+			break;
+
+		slashes = skipXpathStreamSlashes (&p);
+		if (slashes == 1)
+			axis = XPATH_STREAM_CHILD;
+		else if (slashes == 2)
+			axis = XPATH_STREAM_DESCENDANT;
+		else
+			goto fail;
+	}
+
+	return path;
+
+ fail:
+	deleteXpathStreamPath (path);
+	return NULL;
+}
+
 extern void addTagXpath (const langType language CTAGS_ATTR_UNUSED, tagXpathTable *xpathTable)
 {
 	Assert (xpathTable->xpath);
@@ -86,6 +331,8 @@ extern void addTagXpath (const langType language CTAGS_ATTR_UNUSED, tagXpathTabl
 	xpathTable->xpathCompiled = xmlXPathCompile ((xmlChar *)xpathTable->xpath);
 	if (!xpathTable->xpathCompiled)
 		error (WARNING, "Failed to compile the Xpath expression: %s", xpathTable->xpath);
+	else
+		xpathTable->xpathStreamPath = compileXpathStreamPath (xpathTable->xpath);
 }
 
 extern void removeTagXpath (const langType language CTAGS_ATTR_UNUSED, tagXpathTable *xpathTable)
@@ -95,6 +342,12 @@ extern void removeTagXpath (const langType language CTAGS_ATTR_UNUSED, tagXpathT
 		xmlXPathFreeCompExpr (xpathTable->xpathCompiled);
 		xpathTable->xpathCompiled = NULL;
 	}
+
+	if (xpathTable->xpathStreamPath)
+	{
+		deleteXpathStreamPath (xpathTable->xpathStreamPath);
+		xpathTable->xpathStreamPath = NULL;
+	}
 }
 
 static void findXMLTagsCore (xmlXPathContext *ctx, xmlNode *root,
@@ -229,6 +482,497 @@ out:
 	}
 }
 
+static xmlAttr *findXpathStreamAttr (xmlNode *node, const char *name)
+{
+	for (xmlAttr *attr = node->properties; attr; attr = attr->next)
+		if (attr->ns == NULL && strcmp ((const char *)attr->name, name) == 0)
+			return attr;
+	return NULL;
+}
+
+static bool matchXpathStreamPredicate (xmlNode *node, const xpathStreamPredicate *pred)
+{
+	xmlAttr *attr;
+	xmlChar *value;
+	bool r;
+
+	if (pred->localName)
+		return strcmp ((const char *)node->name, pred->name) == 0;
+
+	attr = findXpathStreamAttr (node, pred->name);
+	if (attr == NULL)
+		return false;
+	if (pred->value == NULL)
+		return true;
+
+	value = xmlNodeGetContent ((xmlNode *)attr);
+	r = (value && strcmp ((const char *)value, pred->value) == 0);
+	if (value)
+		xmlFree (value);
+	return r;
+}
+
+static bool matchXpathStreamStep (xmlNode *node, const xpathStreamStep *step)
+{
+	if (node->type != XML_ELEMENT_NODE)
+		return false;
+
+	/* A name without prefix is for an element in no namespace. */
+	if (step->name
+		&& (node->ns != NULL || strcmp ((const char *)node->name, step->name) != 0))
+		return false;
+
+	for (unsigned int i = 0; i < ptrArrayCount (step->predicates); i++)
+		if (!matchXpathStreamPredicate (node, ptrArrayItem (step->predicates, i)))
+			return false;
+	return true;
+}
+
+static bool matchXpathStreamSteps (const struct sXpathStreamPath *path, int n,
+								   xmlNode *node, xmlNode *context);
+
+/* Is NODE the node the (N+1)th step of PATH starts from? */
+static bool matchXpathStreamOrigin (const struct sXpathStreamPath *path, int n,
+									xmlNode *node, xmlNode *context)
+{
+	if (n >= 0)
+		return matchXpathStreamSteps (path, n, node, context);
+	else if (path->absolute)
+		return node->type == XML_DOCUMENT_NODE;
+	else
+		return node == context;
+}
+
+/* Does NODE match the Nth step of PATH, and its ancestors the steps
+ * before it? */
+static bool matchXpathStreamSteps (const struct sXpathStreamPath *path, int n,
+								   xmlNode *node, xmlNode *context)
+{
+	const xpathStreamStep *step = ptrArrayItem (path->steps, n);
+
+	if (!matchXpathStreamStep (node, step))
+		return false;
+
+	if (step->axis == XPATH_STREAM_CHILD)
+		return node->parent && matchXpathStreamOrigin (path, n - 1, node->parent, context);
+
+	for (xmlNode *a = node->parent; a; a = a->parent)
+		if (matchXpathStreamOrigin (path, n - 1, a, context))
+			return true;
+	return false;
+}
+
+/* Returns the node matching PATH from NODE at its start tag, or NULL.
+ * CONTEXT is the node a relative xpath starts from. */
+static xmlNode *matchXpathStreamPath (const struct sXpathStreamPath *path,
+									  xmlNode *node, xmlNode *context)
+{
+	int n = (int)ptrArrayCount (path->steps) - 1;
+	xmlAttr *attr;
+
+	if (path->attr == NULL)
+		return matchXpathStreamSteps (path, n, node, context)? node: NULL;
+
+	attr = findXpathStreamAttr (node, path->attr);
+	if (attr == NULL)
+		return NULL;
+
+	if (path->attrAxis == XPATH_STREAM_CHILD)
+		return matchXpathStreamOrigin (path, n, node, context)? (xmlNode *)attr: NULL;
+
+	for (xmlNode *a = node; a; a = a->parent)
+		if (matchXpathStreamOrigin (path, n, a, context))
+			return (xmlNode *)attr;
+	return NULL;
+}
+
+static void deleteXpathStreamMatch (void *data)
+{
+	xpathStreamMatch *match = data;
+
+	eFree (match->name);
+	eFree (match);
+}
+
+static void deleteXpathStreamEntry (void *data)
+{
+	xpathStreamEntry *entry = data;
+
+	if (entry->matches)
+		ptrArrayDelete (entry->matches);
+	eFree (entry);
+}
+
+extern xpathStream *xpathStreamNew (void)
+{
+	xpathStream *stream = xMalloc (1, xpathStream);
+
+	stream->entries = ptrArrayNew (deleteXpathStreamEntry);
+	stream->checked = false;
+	stream->wellFormed = false;
+	stream->rootName = NULL;
+	return stream;
+}
+
+extern void xpathStreamDelete (xpathStream *stream)
+{
+	ptrArrayDelete (stream->entries);
+	if (stream->rootName)
+		eFree (stream->rootName);
+	eFree (stream);
+}
+
+#ifdef LIBXML_READER_ENABLED
+static xmlTextReaderPtr newXpathStreamReader (void)
+{
+	const unsigned char* data;
+	size_t size;
+
+	data = getInputFileData (&size);
+	if (data == NULL)
+		return NULL;
+
+	xmlLineNumbersDefault (1);
+	return xmlReaderForMemory ((const char *)data, size, NULL, NULL,
+							   XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+}
+
+/* Reads the input up to the root element. */
+static bool peekXpathStreamRoot (xpathStream *stream)
+{
+	xmlTextReaderPtr reader;
+
+	if (stream->rootName)
+		return true;
+
+	reader = newXpathStreamReader ();
+	if (reader == NULL)
+		return false;
+
+	while (xmlTextReaderRead (reader) == 1)
+	{
+		if (xmlTextReaderNodeType (reader) == XML_READER_TYPE_ELEMENT)
+		{
+			stream->rootName = eStrdup ((const char *)xmlTextReaderConstLocalName (reader));
+			break;
+		}
+	}
+
+	xmlFreeTextReader (reader);
+	return stream->rootName != NULL;
+}
+
+/* Reads the whole input once without making tags. A broken input is
+ * known only at its end; makeXMLDoc gives no tree for it. */
+static bool checkXpathStreamInput (xpathStream *stream)
+{
+	xmlTextReaderPtr reader;
+	int r;
+
+	if (stream->checked)
+		return true;
+
+	reader = newXpathStreamReader ();
+	if (reader == NULL)
+		return false;
+
+	while ((r = xmlTextReaderRead (reader)) == 1)
+		;
+
+	stream->checked = true;
+	stream->wellFormed = (r == 0);
+	xmlFreeTextReader (reader);
+	return true;
+}
+#else
+static bool peekXpathStreamRoot (xpathStream *stream CTAGS_ATTR_UNUSED)
+{
+	return false;
+}
+
+static bool checkXpathStreamInput (xpathStream *stream CTAGS_ATTR_UNUSED)
+{
+	return false;
+}
+#endif
+
+static bool hasBytes (const unsigned char *data, size_t size, const char *str)
+{
+	const size_t len = strlen (str);
+	const unsigned char *p = data, *end = data + size;
+
+	while (len > 0 && (size_t) (end - p) >= len
+		   && (p = memchr (p, str[0], end - p - len + 1)) != NULL)
+	{
+		if (memcmp (p, str, len) == 0)
+			return true;
+		p++;
+	}
+	return false;
+}
+
+/* XPATH is one of the alternatives of an xpath. */
+static bool mayXpathStreamMatchInput (xpathStream *stream, const char *xpath)
+{
+	const char *p = xpath;
+	int slashes = skipXpathStreamSlashes (&p);
+	char *name = NULL;
+	bool r = true;
+
+	if (slashes == 0 || slashes > 3)
+		return true;
+
+	if (*p == '*')
+	{
+		p++;
+		if (*p == '[')
+		{
+			xpathStreamPredicate *pred = parseXpathStreamPredicate (&p);
+			if (pred && pred->localName)
+			{
+				name = pred->name;
+				pred->name = NULL;
+			}
+			if (pred)
+				deleteXpathStreamPredicate (pred);
+		}
+	}
+	else
+	{
+		name = parseXpathStreamName (&p);
+		/* A prefixed name */
+		if (name && *p == ':')
+		{
+			eFree (name);
+			name = NULL;
+		}
+	}
+
+	if (name == NULL)
+		return true;
+
+	if (slashes == 1)
+		r = (strcmp (name, stream->rootName) == 0);
+	else
+	{
+		const unsigned char* data;
+		size_t size;
+
+		data = getInputFileData (&size);
+		r = (data == NULL || hasBytes (data, size, name));
+	}
+	eFree (name);
+	return r;
+}
+
+extern bool xpathStreamMayMatchTable (xpathStream *stream, int tableTableIndex)
+{
+	const langType lang = getInputLanguage();
+	const tagXpathTableTable *xpathTableTable
+		= getXpathTableTable (lang, tableTableIndex);
+
+	/* The answer for a broken input doesn't matter; findXMLTagsFull and
+	 * xpathStreamRun make no tag from the tables for it. */
+	if (!peekXpathStreamRoot (stream))
+		return true;
+
+	for (unsigned int i = 0; i < xpathTableTable->count; ++i)
+	{
+		/* Each alternative of a union like (A|B) starts after a '|'. A '|'
+		 * in a predicate makes an extra piece; it is harmless because the
+		 * answer is true if any piece may match. */
+		char *xpath = eStrdup (xpathTableTable->table[i].xpath);
+		char *alt = xpath, *bar;
+		bool r = false;
+
+		do
+		{
+			bar = strchr (alt, '|');
+			if (bar)
+				*bar = '\0';
+			while (*alt == '(' || isspace ((unsigned char) *alt))
+				alt++;
+			r = mayXpathStreamMatchInput (stream, alt);
+			alt = bar + 1;
+		} while (bar && !r);
+		eFree (xpath);
+
+		if (r)
+			return true;
+	}
+	return false;
+}
+
+static bool isXpathStreamEntry (const tagXpathTable *elt, bool first)
+{
+	const struct sXpathStreamPath *path = elt->xpathStreamPath;
+
+	if (path == NULL)
+		return false;
+
+	if (elt->specType == LXPATH_TABLE_DO_RECUR)
+		return first && elt->spec.recurSpec.streamable;
+
+	/* The contents of an element is not read yet at its start tag. */
+	return (path->attr != NULL
+			&& elt->spec.makeTagSpec.make == NULL
+			&& elt->spec.makeTagSpec.decideKind == NULL);
+}
+
+extern bool xpathStreamAddTable (xpathStream *stream, int tableTableIndex)
+{
+	const langType lang = getInputLanguage();
+	const tagXpathTableTable *xpathTableTable
+		= getXpathTableTable (lang, tableTableIndex);
+	const bool empty = ptrArrayIsEmpty (stream->entries);
+	unsigned int i;
+
+	for (i = 0; i < xpathTableTable->count; ++i)
+		if (!isXpathStreamEntry (xpathTableTable->table + i, empty && i == 0))
+			return false;
+
+	for (i = 0; i < xpathTableTable->count; ++i)
+	{
+		xpathStreamEntry *entry = xMalloc (1, xpathStreamEntry);
+
+		entry->language = lang;
+		entry->tableTableIndex = tableTableIndex;
+		entry->elt = xpathTableTable->table + i;
+		entry->matches = (empty && i == 0)? NULL: ptrArrayNew (deleteXpathStreamMatch);
+		ptrArrayAdd (stream->entries, entry);
+	}
+	return true;
+}
+
+static void matchXpathStreamEntry (xpathStreamEntry *entry,
+								   xmlNode *node, xmlNode *root,
+								   xmlXPathContext *ctx, void *userData)
+{
+	const tagXpathTable *elt = entry->elt;
+	xmlNode *target = matchXpathStreamPath (elt->xpathStreamPath, node, root);
+	xpathStreamMatch *match;
+	xmlChar *str;
+
+	if (target == NULL)
+		return;
+
+	if (entry->matches == NULL)
+	{
+		if (elt->specType == LXPATH_TABLE_DO_MAKE)
+			simpleXpathMakeTag (target, elt->xpath, &(elt->spec.makeTagSpec), userData);
+		else
+			elt->spec.recurSpec.enter (target, elt->xpath, &(elt->spec.recurSpec), ctx, userData);
+		return;
+	}
+
+	str = xmlNodeGetContent (target);
+	if (str == NULL)
+		return;
+
+	match = xMalloc (1, xpathStreamMatch);
+	match->name = eStrdup ((char *)str);
+	match->lineNumber = XML_GET_LINE (target);
+	ptrArrayAdd (entry->matches, match);
+	xmlFree (str);
+}
+
+extern bool xpathStreamRun (xpathStream *stream, void *userData)
+{
+#ifdef LIBXML_READER_ENABLED
+	xmlTextReaderPtr reader;
+	xmlXPathContext *ctx = NULL;
+	xmlNode *root = NULL;
+
+	/* xmlGetNodePath needs the following siblings of a node. */
+	if (isFieldEnabled (FIELD_XPATH))
+		return false;
+
+	if (getInputFileUserData ())
+		return false;
+
+	if (!checkXpathStreamInput (stream))
+		return false;
+
+	verbose ("read %s as a xml stream\n", getInputFileName());
+	findRegexTags ();
+
+	if (!stream->wellFormed)
+	{
+		verbose ("could not parse %s as a XML file\n", getInputFileName());
+		return true;
+	}
+
+	reader = newXpathStreamReader ();
+	if (reader == NULL)
+		return true;
+
+	while (xmlTextReaderRead (reader) == 1)
+	{
+		xmlNode *node;
+
+		if (xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT)
+			continue;
+
+		node = xmlTextReaderCurrentNode (reader);
+		if (root == NULL)
+		{
+			root = node;
+			ctx = xmlXPathNewContext (node->doc);
+			if (ctx == NULL)
+				error (FATAL, "failed to make a new xpath context for %s", getInputFileName());
+		}
+
+		for (unsigned int i = 0; i < ptrArrayCount (stream->entries); i++)
+			matchXpathStreamEntry (ptrArrayItem (stream->entries, i),
+								   node, root, ctx, userData);
+	}
+
+	if (ctx)
+		xmlXPathFreeContext (ctx);
+	xmlFreeTextReader (reader);
+	return true;
+#else
+	return false;
+#endif
+}
+
+static void makeXpathStreamTag (const tagXpathMakeTagSpec *spec,
+								const xpathStreamMatch *match)
+{
+	tagEntryInfo tag;
+
+	if (spec->role == ROLE_DEFINITION_INDEX)
+		initTagEntry (&tag, match->name, spec->kind);
+	else if (isXtagEnabled(XTAG_REFERENCE_TAGS))
+		initRefTagEntry (&tag, match->name, spec->kind, spec->role);
+	else
+		return;
+
+	updateTagLine (&tag, match->lineNumber,
+				   getInputFilePositionForLine (match->lineNumber));
+	makeTagEntry (&tag);
+}
+
+extern void xpathStreamMakeTags (xpathStream *stream, int tableTableIndex)
+{
+	const langType lang = getInputLanguage();
+
+	for (unsigned int i = 0; i < ptrArrayCount (stream->entries); i++)
+	{
+		xpathStreamEntry *entry = ptrArrayItem (stream->entries, i);
+
+		if (entry->language != lang
+			|| entry->tableTableIndex != tableTableIndex
+			|| entry->matches == NULL)
+			continue;
+
+		for (unsigned int j = 0; j < ptrArrayCount (entry->matches); j++)
+			makeXpathStreamTag (&(entry->elt->spec.makeTagSpec),
+								ptrArrayItem (entry->matches, j));
+		ptrArrayClear (entry->matches);
+	}
+}
+
 #else
 
 extern void addTagXpath (const langType language, tagXpathTable *xpathTable)
@@ -250,6 +994,34 @@ extern void findXMLTagsFull (xmlXPathContext *ctx, xmlNode *root,
 extern  void updateXMLTagLine (tagEntryInfo *e, xmlNode *node)
 {
 }
+
+extern xpathStream *xpathStreamNew (void)
+{
+	return NULL;
+}
+
+extern void xpathStreamDelete (xpathStream *stream)
+{
+}
+
+extern bool xpathStreamAddTable (xpathStream *stream, int tableTableIndex)
+{
+	return false;
+}
+
+extern bool xpathStreamMayMatchTable (xpathStream *stream, int tableTableIndex)
+{
+	return true;
+}
+
+extern bool xpathStreamRun (xpathStream *stream, void *userData)
+{
+	return false;
+}
+
+extern void xpathStreamMakeTags (xpathStream *stream, int tableTableIndex)
+{
+}
 #endif
 
 extern void findXMLTags (xmlXPathContext *ctx, xmlNode *root,
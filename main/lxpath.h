@@ -61,6 +61,9 @@ typedef struct sTagXpathRecurSpec {
 	int  nextTable;		/* A parser can use this field any purpose.
 				   main/lxpath part doesn't touch this. */
 
+	bool streamable;	/* ENTER looks at NODE, its attributes,
+				   its namespace definitions, and its
+				   ancestors only. See xpathStreamAddTable. */
 } tagXpathRecurSpec;
 
 typedef struct sTagXpathTable
@@ -72,6 +75,7 @@ typedef struct sTagXpathTable
 		tagXpathRecurSpec   recurSpec;
 	} spec;
 	xmlXPathCompExpr* xpathCompiled;
+	struct sXpathStreamPath *xpathStreamPath;
 } tagXpathTable;
 
 typedef struct sTagXpathTableTable {
@@ -92,6 +96,8 @@ typedef struct sXpathFileSpec {
 	const char *rootNSHref;
 } xpathFileSpec;
 
+typedef struct sXpathStream xpathStream;
+
 
 /*
 *   FUNCTION PROTOTYPES
@@ -109,4 +115,43 @@ extern void findXMLTags (xmlXPathContext *ctx, xmlNode *root,
 
 extern  void updateXMLTagLine (tagEntryInfo *e, xmlNode *node);
 
+/* Streaming interface
+ *
+ * Instead of making the DOM tree for the whole input, tables can be
+ * matched while reading the input with libxml2's reader. A table can be
+ * added to a stream if the xpath of each entry is made of child (/) and
+ * descendant (//) steps, with name tests, *, [local-name()='NAME'],
+ * [@ATTR], and [@ATTR='VALUE'], and the xpath may end with an attribute
+ * step. Also each entry must be either
+ *
+ * - an attribute to make a tag for without make and decideKind
+ *   callbacks, or
+ * - a recur entry marked streamable, only as the first entry of the first
+ *   table added to a stream.
+ *
+ * The tag for the first entry is made (or ENTER is called for it) while
+ * reading the input. The tags for the other entries are made with
+ * xpathStreamMakeTags. The order of the tags is the same as the one
+ * findXMLTags makes.
+ *
+ * The tables are the ones of the current language, like findXMLTags. A
+ * relative xpath is from the root element.
+ */
+extern xpathStream *xpathStreamNew (void);
+extern void xpathStreamDelete (xpathStream *stream);
+/* Returns false if the table cannot be matched while streaming. */
+extern bool xpathStreamAddTable (xpathStream *stream, int tableTableIndex);
+/* Returns false if no entry of the table, run from the root element, can
+ * select a node in the input. Only the first step of each xpath is looked
+ * at: a child step must name the root element, and a descendant step
+ * must name an element appearing in the input. Returns true if it cannot
+ * be decided. */
+extern bool xpathStreamMayMatchTable (xpathStream *stream, int tableTableIndex);
+/* Runs the regex parser, then reads the input, like findXMLTagsFull
+ * with NULL CTX. Returns false if the input cannot be read as a stream;
+ * nothing is done then. As findXMLTagsFull does, no tag is made from
+ * the xpath tables if the input is broken. */
+extern bool xpathStreamRun (xpathStream *stream, void *userData);
+extern void xpathStreamMakeTags (xpathStream *stream, int tableTableIndex);
+
 #endif  /* CTAGS_LXPATH_PARSE_H */
@@ -28,6 +28,7 @@
 #include <crt_externs.h>
 #endif
 
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -51,6 +52,8 @@
 
 #include "ctags.h"
 #include "debug.h"
+#include "dedup_p.h"
+#include "dirwalk_p.h"
 #include "entry_p.h"
 #include "error_p.h"
 #include "field_p.h"
@@ -59,11 +62,14 @@
 #include "options_p.h"
 #include "optscript.h"
 #include "parse_p.h"
+#include "readahead_p.h"
 #include "read_p.h"
 #include "routines_p.h"
 #include "stats_p.h"
 #include "trace.h"
+#include "trace-event_p.h"
 #include "trashbox_p.h"
+#include "watch_p.h"
 #include "writer_p.h"
 #include "xtag_p.h"
 
@@ -71,6 +77,17 @@
 #include "interactive_p.h"
 #include <jansson.h>
 #include <errno.h>
+#ifdef HAVE_INTERACTIVE_WORKERS
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#ifdef HAVE_INTERACTIVE_DAEMON
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
 #endif
 
 /*
@@ -78,11 +95,15 @@
 */
 static mainLoopFunc mainLoop;
 static void *mainData;
+static unsigned int RecursionDepth;
 
 /*
 *   FUNCTION PROTOTYPES
 */
 static bool createTagsForEntry (const char *const entryName);
+#ifdef HAVE_DIR_WALKER
+static bool createTagsForWalkedEntry (dirWalker *walker, dirWalkerEntry *walked);
+#endif
 
 /*
 *   FUNCTION DEFINITIONS
@@ -98,6 +119,7 @@ static bool recurseUsingOpendir (const char *const dirName)
 	else
 	{
 		struct dirent *entry;
+		watchDirectory (dirName);
 		while ((entry = readdir (dir)) != NULL)
 		{
 			if (strcmp (entry->d_name, ".") != 0  &&
@@ -123,6 +145,46 @@ static bool recurseUsingOpendir (const char *const dirName)
 }
 #endif
 
+#ifdef HAVE_DIR_WALKER
+/* Takes the entries in WALKED, a directory the walker descended into. */
+static bool recurseUsingDirWalker (dirWalker *walker, dirWalkerEntry *walked)
+{
+	bool resize = false;
+	dirWalkerEntry *entry;
+
+	if (walked->openErrno)
+	{
+		errno = walked->openErrno;
+		error (WARNING | PERROR, "cannot recurse into directory \"%s\"", walked->path);
+	}
+	else
+		watchDirectory (walked->path);
+
+	walked->consumed = true;
+	while ((entry = dirWalkerNext (walker)) != NULL)
+	{
+		resize |= createTagsForWalkedEntry (walker, entry);
+		dirWalkerSkip (walker, entry);
+		dirWalkerEntryDelete (entry);
+	}
+	return resize;
+}
+
+static bool recurseUsingNewDirWalker (const char *const dirName)
+{
+	dirWalker *walker = dirWalkerNew (dirName, RecursionDepth,
+									  Option.maxRecursionDepth);
+	if (walker == NULL)
+		return recurseUsingOpendir (dirName);
+
+	dirWalkerEntry *root = dirWalkerNext (walker);
+	bool resize = recurseUsingDirWalker (walker, root);
+	dirWalkerEntryDelete (root);
+	dirWalkerDelete (walker);
+	return resize;
+}
+#endif
+
 #ifdef HAVE__FINDFIRST
 
 static bool createTagsForWildcardEntry (
@@ -163,24 +225,33 @@ static bool createTagsForWildcardUsingFindfirst (const char *const pattern)
 #endif
 
 
-static bool recurseIntoDirectory (const char *const dirName)
+static bool shouldRecurseIntoDirectory (const char *const dirName, bool maybeLink)
 {
-	static unsigned int recursionDepth = 0;
-
-	recursionDepth++;
-
-	bool resize = false;
-	if (isRecursiveLink (dirName))
+	if (maybeLink && isRecursiveLink (dirName))
 		verbose ("ignoring \"%s\" (recursive link)\n", dirName);
 	else if (! Option.recurse)
 		verbose ("ignoring \"%s\" (directory)\n", dirName);
-	else if(recursionDepth > Option.maxRecursionDepth)
+	else if(RecursionDepth > Option.maxRecursionDepth)
 		verbose ("not descending in directory \"%s\" (depth %u > %u)\n",
-				dirName, recursionDepth, Option.maxRecursionDepth);
+				dirName, RecursionDepth, Option.maxRecursionDepth);
 	else
 	{
 		verbose ("RECURSING into directory \"%s\"\n", dirName);
-#if defined (HAVE_OPENDIR) && (defined (HAVE_DIRENT_H) || defined (_MSC_VER))
+		return true;
+	}
+	return false;
+}
+
+static bool recurseIntoDirectory (const char *const dirName)
+{
+	RecursionDepth++;
+
+	bool resize = false;
+	if (shouldRecurseIntoDirectory (dirName, true))
+	{
+#if defined (HAVE_DIR_WALKER)
+		resize = recurseUsingNewDirWalker (dirName);
+#elif defined (HAVE_OPENDIR) && (defined (HAVE_DIRENT_H) || defined (_MSC_VER))
 		resize = recurseUsingOpendir (dirName);
 #elif defined (HAVE__FINDFIRST)
 		{
@@ -194,35 +265,104 @@ static bool recurseIntoDirectory (const char *const dirName)
 #endif
 	}
 
-	recursionDepth--;
+	RecursionDepth--;
 
 	return resize;
 }
 
-static bool createTagsForEntry (const char *const entryName)
-{
-	bool resize = false;
-	fileStatus *status = eStat (entryName);
+enum entryAction {
+	ENTRY_IGNORE,
+	ENTRY_RECURSE,
+	ENTRY_PARSE,
+};
 
-	Assert (entryName != NULL);
-	if (isExcludedFile (entryName, true))
-		verbose ("excluding \"%s\" (the early stage)\n", entryName);
-	else if (status->isSymbolicLink  &&  ! Option.followLinks)
+static enum entryAction chooseEntryAction (const char *const entryName,
+										   const fileStatus *const status)
+{
+	if (status->isSymbolicLink  &&  ! Option.followLinks)
 		verbose ("ignoring \"%s\" (symbolic link)\n", entryName);
 	else if (! status->exists)
 		error (WARNING | PERROR, "cannot open input file \"%s\"", entryName);
 	else if (status->isDirectory)
-		resize = recurseIntoDirectory (entryName);
+		return ENTRY_RECURSE;
 	else if (! status->isNormalFile)
 		verbose ("ignoring \"%s\" (special file)\n", entryName);
 	else if (isExcludedFile (entryName, false))
 		verbose ("excluding \"%s\"\n", entryName);
 	else
+		return ENTRY_PARSE;
+	return ENTRY_IGNORE;
+}
+
+static bool createTagsForEntry (const char *const entryName)
+{
+	bool resize = false;
+
+	Assert (entryName != NULL);
+	if (isExcludedFile (entryName, true))
+	{
+		verbose ("excluding \"%s\" (the early stage)\n", entryName);
+		return false;
+	}
+
+	fileStatus *status = eStat (entryName);
+	switch (chooseEntryAction (entryName, status))
+	{
+	case ENTRY_RECURSE:
+		resize = recurseIntoDirectory (entryName);
+		break;
+	case ENTRY_PARSE:
+		resize = parseFile (entryName);
+		streamTagFile ();
+		break;
+	case ENTRY_IGNORE:
+		break;
+	}
+
+	eStatFree (status);
+	return resize;
+}
+
+#ifdef HAVE_DIR_WALKER
+/* The same as createTagsForEntry () but uses the status the walker got. */
+static bool createTagsForWalkedEntry (dirWalker *walker, dirWalkerEntry *walked)
+{
+	const char *const entryName = walked->path;
+	bool resize = false;
+
+	if (walked->excluded)
+	{
+		verbose ("excluding \"%s\" (the early stage)\n", entryName);
+		return false;
+	}
+
+	fileStatus *status = eStatSet (entryName, &walked->status);
+	errno = walked->statErrno;
+	switch (chooseEntryAction (entryName, status))
+	{
+	case ENTRY_RECURSE:
+		RecursionDepth++;
+		if (shouldRecurseIntoDirectory (entryName, status->isSymbolicLink))
+		{
+			if (walked->descended)
+				resize = recurseUsingDirWalker (walker, walked);
+			else
+				resize = recurseUsingNewDirWalker (entryName);
+		}
+		RecursionDepth--;
+		break;
+	case ENTRY_PARSE:
 		resize = parseFile (entryName);
+		streamTagFile ();
+		break;
+	case ENTRY_IGNORE:
+		break;
+	}
 
 	eStatFree (status);
 	return resize;
 }
+#endif
 
 #ifdef MANUAL_GLOBBING
 
@@ -253,6 +393,7 @@ static bool createTagsForWildcardArg (const char *const arg)
 static bool createTagsForArgs (cookedArgs *const args)
 {
 	bool resize = false;
+	readAhead *ra = readAheadNewForArgv (cArgArgv (args));
 
 	/*  Generate tags for each argument on the command line.
 	 */
@@ -265,15 +406,18 @@ static bool createTagsForArgs (cookedArgs *const args)
 #else
 		resize |= createTagsForEntry (arg);
 #endif
+		readAheadAdvance (ra);
 		cArgForth (args);
 		parseCmdlineOptions (args);
 	}
+	readAheadDelete (ra);
 	return resize;
 }
 
 /*  Read from an opened file a list of file names for which to generate tags.
  */
-static bool createTagsFromFileInput (FILE *const fp, const bool filter)
+static bool createTagsFromFileInput (FILE *const fp, const bool filter,
+									 readAhead *const ra)
 {
 	bool resize = false;
 	if (fp != NULL)
@@ -283,6 +427,7 @@ static bool createTagsFromFileInput (FILE *const fp, const bool filter)
 		while (! cArgOff (args))
 		{
 			resize |= createTagsForEntry (cArgItem (args));
+			readAheadAdvance (ra);
 			if (filter)
 			{
 				if (Option.filterTerminator != NULL)
@@ -304,13 +449,15 @@ static bool createTagsFromListFile (const char *const fileName)
 	bool resize;
 	Assert (fileName != NULL);
 	if (strcmp (fileName, "-") == 0)
-		resize = createTagsFromFileInput (stdin, false);
+		resize = createTagsFromFileInput (stdin, false, NULL);
 	else
 	{
 		FILE *const fp = fopen (fileName, "r");
 		if (fp == NULL)
 			error (FATAL | PERROR, "cannot open list file \"%s\"", fileName);
-		resize = createTagsFromFileInput (fp, false);
+		readAhead *ra = readAheadNewForListFile (fileName, fp);
+		resize = createTagsFromFileInput (fp, false, ra);
+		readAheadDelete (ra);
 		fclose (fp);
 	}
 	return resize;
@@ -367,7 +514,7 @@ static void batchMakeTags (cookedArgs *args, void *user CTAGS_ATTR_UNUSED)
 	if (Option.filter)
 	{
 		verbose ("Reading filter input\n");
-		resize = (bool) (createTagsFromFileInput (stdin, true) || resize);
+		resize = (bool) (createTagsFromFileInput (stdin, true, NULL) || resize);
 	}
 	if (! files  &&  Option.recurse)
 		resize = recurseIntoDirectory (".");
@@ -379,111 +526,682 @@ static void batchMakeTags (cookedArgs *args, void *user CTAGS_ATTR_UNUSED)
 
 	timeStamp (2);
 
-	if (Option.printTotals)
+	if (Option.printTotals == TOTALS_JSON)
+		printTotalsAsJson (Option.append, Option.sorted);
+	else if (Option.printTotals)
 	{
 		printTotals (timeStamps, Option.append, Option.sorted);
-		if (Option.printTotals > 1)
+		if (Option.printTotals == TOTALS_EXTRA)
 			for (unsigned int i = 0; i < countParsers(); i++)
 				printParserStatisticsIfUsed (i);
 	}
+	if (Option.regexProfile)
+		printLanguageRegexProfile (stderr);
 
 #undef timeStamp
+
+	if (Option.watch)
+		watchTagFile (createTagsForEntry);
 }
 
 #ifdef HAVE_JANSSON
-void interactiveLoop (cookedArgs *args CTAGS_ATTR_UNUSED, void *user)
+/*  Read a request line of any length. The newline is kept.
+ *  Return false at the end of input.
+ */
+static bool readRequestLine (vString *const line, FILE *const fp)
 {
-	struct interactiveModeArgs *iargs = user;
+	char buffer[1024];
 
-	if (iargs->sandbox) {
-		/* As of jansson 2.6, the object hashing is seeded off
-		   of /dev/urandom, so trigger the hash seeding
-		   before installing the syscall filter.
-		*/
-		json_t * tmp = json_object ();
-		json_decref (tmp);
-
-		if (installSyscallFilter ()) {
-			error (FATAL, "install_syscall_filter failed");
-			/* The explicit exit call is needed because
-			   "error (FATAL,..." just prints a message in
-			   interactive mode. */
-			exit (1);
-		}
+	vStringClear (line);
+	while (fgets (buffer, sizeof (buffer), fp))
+	{
+		vStringCatS (line, buffer);
+		if (vStringLast (line) == '\n')
+			break;
 	}
+	return vStringLength (line) > 0;
+}
 
-	char buffer[1024];
-	json_t *request;
+/*  Return the length of the source code sent after the request line,
+ *  or -1 if the request has no "size" member.
+ */
+static json_int_t requestDataSize (json_t *const request)
+{
+	json_int_t size = -1;
 
-	fputs ("{\"_type\": \"program\", \"name\": \"" PROGRAM_NAME "\", \"version\": \"" PROGRAM_VERSION "\"}\n", stdout);
-	fflush (stdout);
+	if (request)
+		json_unpack (request, "{sI}", "size", &size);
+	return size;
+}
+
+static void skipRequestData (json_int_t size)
+{
+	char buffer[4096];
+
+	while (size > 0)
+	{
+		size_t n = fread (buffer, 1,
+						  (size < (json_int_t) sizeof (buffer))? (size_t) size: sizeof (buffer),
+						  stdin);
+		if (n == 0)
+			break;
+		size -= n;
+	}
+}
+
+/*  Return the "id" member of the request in JSON notation, or NULL
+ *  if the request has no valid id. The caller must free the result.
+ */
+static char *requestIdOf (json_t *const request)
+{
+	json_t *id = request? json_object_get (request, "id"): NULL;
+
+	if (! (json_is_string (id) || json_is_integer (id)))
+		return NULL;
+	return json_dumps (id, JSON_ENCODE_ANY);
+}
+
+static void serveRequest (struct interactiveModeArgs *iargs, const char *const line)
+{
+	json_t *request = json_loads (line, JSON_DISABLE_EOF_CHECK, NULL);
+	if (! request)
+	{
+		error (FATAL, "invalid json");
+		return;
+	}
+
+	json_int_t size = requestDataSize (request);
+	char *requestId = requestIdOf (request);
+	iargs->requestId = requestId;
+	setJsonWriterRequestId (requestId);
+
+	if (json_object_get (request, "id") && ! requestId)
+	{
+		error (FATAL, "invalid request id");
+		goto skip;
+	}
+
+	if (size < -1)
+	{
+		error (FATAL, "invalid size");
+		goto next;
+	}
+
+	json_t *command = json_object_get (request, "command");
+	if (! json_is_string (command))
+	{
+		error (FATAL, "command name not found");
+		goto skip;
+	}
+
+	if (!strcmp ("generate-tags", json_string_value (command)))
+	{
+		const char *filename;
+
+		if (json_unpack (request, "{ss}", "filename", &filename) == -1)
+		{
+			error (FATAL, "invalid generate-tags request");
+			goto skip;
+		}
+
+		openTagFile ();
+		if (size == -1)
+		{					/* read from disk */
+			if (iargs->sandbox) {
+				error (FATAL,
+					   "invalid request in sandbox submode: reading file contents from a file is limited");
+				closeTagFile (false);
+				goto next;
+			}
+
+			createTagsForEntry (filename);
+		}
+		else
+		{					/* read nbytes from stream */
+			unsigned char *data = eMalloc (size);
+			size = fread (data, 1, size, stdin);
+			MIO *mio = mio_new_memory (data, size, eRealloc, eFreeNoNullCheck);
+			parseFileWithMio (filename, mio, NULL);
+			mio_unref (mio);
+		}
+
+		closeTagFile (false);
+		fputs ("{\"_type\": \"completed\", \"command\": \"generate-tags\"", stdout);
+		if (requestId)
+			fprintf (stdout, ", \"id\": %s", requestId);
+		fputs ("}\n", stdout);
+		goto next;
+	}
+	else
+		error (FATAL, "unknown command name");
+
+ skip:
+	/* Don't take the source code of a rejected request for the
+	   next request line. */
+	skipRequestData (size);
+ next:
+	setJsonWriterRequestId (NULL);
+	iargs->requestId = NULL;
+	if (requestId)
+		eFree (requestId);
+	json_decref (request);
+}
 
-	while (fgets (buffer, sizeof(buffer), stdin))
+/*  Serve the requests coming from stdin one by one. If DELIMIT is true,
+ *  an empty line follows the response to each request; a worker uses it
+ *  to tell the dispatcher that it is ready for the next request.
+ */
+static void serveRequests (struct interactiveModeArgs *iargs, bool delimit)
+{
+	vString *line = vStringNew ();
+
+	while (readRequestLine (line, stdin))
 	{
-		if (buffer[0] == '\n')
+		if (vStringChar (line, 0) == '\n')
 			continue;
 
-		request = json_loads (buffer, JSON_DISABLE_EOF_CHECK, NULL);
-		if (! request)
+		serveRequest (iargs, vStringValue (line));
+		if (delimit)
+			fputc ('\n', stdout);
+		fflush (stdout);
+	}
+
+	vStringDelete (line);
+}
+
+static void enterSandbox (void)
+{
+	/* As of jansson 2.6, the object hashing is seeded off
+	   of /dev/urandom, so trigger the hash seeding
+	   before installing the syscall filter.
+	*/
+	json_t * tmp = json_object ();
+	json_decref (tmp);
+
+	if (installSyscallFilter ()) {
+		error (FATAL, "install_syscall_filter failed");
+		/* The explicit exit call is needed because
+		   "error (FATAL,..." just prints a message in
+		   interactive mode. */
+		exit (1);
+	}
+}
+
+#ifdef HAVE_INTERACTIVE_WORKERS
+/*
+ * With --_interactive-workers=N, the requests are served by N worker
+ * processes forked after the initialization. Each worker keeps its
+ * parser state (initialized parsers, compiled regex tables, keyword
+ * tables) across the requests it serves. The parent process splits the
+ * input into requests, passes each to an idle worker, and copies the
+ * responses to stdout line by line as the workers produce them. A
+ * response of a short request is not held behind a long one; a client
+ * can match responses to requests with the "id" member.
+ */
+typedef struct sInteractiveWorker {
+	pid_t pid;
+	int requestFd;				/* parent -> worker */
+	int responseFd;				/* worker -> parent, -1 if the worker has gone */
+	vString *response;			/* incomplete line from the worker */
+	char *requestId;			/* the request being served */
+	bool busy;
+} interactiveWorker;
+
+static void spawnInteractiveWorker (struct interactiveModeArgs *iargs,
+									interactiveWorker *workers, unsigned int index)
+{
+	interactiveWorker *w = workers + index;
+	int requestPipe[2], responsePipe[2];
+
+	if (pipe (requestPipe) < 0 || pipe (responsePipe) < 0)
+	{
+		error (FATAL | PERROR, "cannot make pipes for a worker");
+		exit (1);
+	}
+
+	fflush (stdout);
+	w->pid = fork ();
+	if (w->pid < 0)
+	{
+		error (FATAL | PERROR, "cannot fork a worker");
+		exit (1);
+	}
+	else if (w->pid == 0)
+	{
+		dup2 (requestPipe[0], STDIN_FILENO);
+		dup2 (responsePipe[1], STDOUT_FILENO);
+		close (requestPipe[0]);
+		close (requestPipe[1]);
+		close (responsePipe[0]);
+		close (responsePipe[1]);
+		for (unsigned int i = 0; i < iargs->workers; i++)
 		{
-			error (FATAL, "invalid json");
-			goto next;
+			if (i == index || workers[i].responseFd < 0)
+				continue;
+			close (workers[i].requestFd);
+			close (workers[i].responseFd);
 		}
 
-		json_t *command = json_object_get (request, "command");
-		if (! command)
+		if (iargs->sandbox)
+			enterSandbox ();
+		serveRequests (iargs, true);
+		exit (0);
+	}
+
+	close (requestPipe[0]);
+	close (responsePipe[1]);
+	w->requestFd = requestPipe[1];
+	w->responseFd = responsePipe[0];
+	w->busy = false;
+	if (w->response == NULL)
+		w->response = vStringNew ();
+	vStringClear (w->response);
+}
+
+static void retireInteractiveWorker (interactiveWorker *w)
+{
+	if (w->requestFd >= 0)
+		close (w->requestFd);
+	close (w->responseFd);
+	w->requestFd = -1;
+	w->responseFd = -1;
+	waitpid (w->pid, NULL, 0);
+}
+
+static bool writeAll (int fd, const char *buf, size_t len)
+{
+	while (len > 0)
+	{
+		ssize_t n = write (fd, buf, len);
+		if (n < 0)
 		{
-			error (FATAL, "command name not found");
-			goto next;
+			if (errno == EINTR)
+				continue;
+			return false;
 		}
+		buf += n;
+		len -= n;
+	}
+	return true;
+}
+
+/*  Find the first request in INPUT. Return the length of the request
+ *  including its source code, or 0 if the request is incomplete.
+ *  Empty lines are dropped from INPUT.
+ */
+static size_t findRequest (vString *input, bool eof, char **requestId)
+{
+	char *nl;
+
+	while ((nl = memchr (vStringValue (input), '\n', vStringLength (input)))
+		   == vStringValue (input))
+		vStringTruncateLeading (input, 1);
+
+	if (vStringIsEmpty (input))
+		return 0;
+	if (nl == NULL)
+	{
+		if (! eof)
+			return 0;
+		vStringPut (input, '\n');
+		nl = vStringValue (input) + vStringLength (input) - 1;
+	}
+
+	size_t lineLength = nl - vStringValue (input) + 1;
+	json_t *request = json_loadb (vStringValue (input), lineLength,
+								  JSON_DISABLE_EOF_CHECK, NULL);
+	json_int_t size = requestDataSize (request);
+	*requestId = requestIdOf (request);
+	json_decref (request);
 
-		if (!strcmp ("generate-tags", json_string_value (command)))
+	size_t length = lineLength + ((size > 0)? (size_t) size: 0);
+	if (length > vStringLength (input))
+	{
+		if (! eof)
 		{
-			json_int_t size = -1;
-			const char *filename;
+			if (*requestId)
+				eFree (*requestId);
+			*requestId = NULL;
+			return 0;
+		}
+		length = vStringLength (input);
+	}
+	return length;
+}
+
+static bool forwardResponse (interactiveWorker *w, const char *buf, size_t len)
+{
+	bool done = false;
+
+	vStringNCatS (w->response, buf, len);
+	while (true)
+	{
+		char *nl = memchr (vStringValue (w->response), '\n',
+						   vStringLength (w->response));
+		if (nl == NULL)
+			break;
+
+		size_t lineLength = nl - vStringValue (w->response) + 1;
+		if (lineLength == 1)
+			done = true;		/* end of the response */
+		else
+			fwrite (vStringValue (w->response), 1, lineLength, stdout);
+		vStringTruncateLeading (w->response, lineLength);
+	}
+	return done;
+}
+
+static void dispatchRequests (struct interactiveModeArgs *iargs)
+{
+	const unsigned int nworkers = iargs->workers;
+	interactiveWorker *workers = xCalloc (nworkers, interactiveWorker);
+	struct pollfd *fds = xCalloc (nworkers + 1, struct pollfd);
+	vString *input = vStringNew ();
+	bool eof = false;
+	char buffer[BUFSIZ * 4];
+
+	for (unsigned int i = 0; i < nworkers; i++)
+	{
+		workers[i].requestFd = -1;
+		workers[i].responseFd = -1;
+	}
+	/* Share the initialized parsers and the compiled regex tables
+	 * among the workers. */
+	initializeParser (LANG_AUTO);
+	compileLanguageRegexPatterns (LANG_AUTO);
+	for (unsigned int i = 0; i < nworkers; i++)
+		spawnInteractiveWorker (iargs, workers, i);
+
+	while (true)
+	{
+		unsigned int nbusy = 0, nidle = 0, nfds = 0;
 
-			if (json_unpack (request, "{ss}", "filename", &filename) == -1)
+		for (unsigned int i = 0; i < nworkers; i++)
+		{
+			interactiveWorker *w = workers + i;
+			if (w->responseFd < 0)
+				continue;
+			if (! w->busy)
 			{
-				error (FATAL, "invalid generate-tags request");
-				goto next;
+				char *requestId;
+				size_t length = findRequest (input, eof, &requestId);
+				if (length > 0)
+				{
+					if (! writeAll (w->requestFd, vStringValue (input), length))
+						error (WARNING | PERROR, "cannot pass a request to a worker");
+					vStringTruncateLeading (input, length);
+					w->requestId = requestId;
+					w->busy = true;
+					if (eof && vStringIsEmpty (input))
+					{
+						/* The request may be truncated; let the worker
+						   see the end of input. */
+						close (w->requestFd);
+						w->requestFd = -1;
+					}
+				}
 			}
+			if (w->busy)
+				nbusy++;
+			else
+				nidle++;
+		}
 
-			json_unpack (request, "{sI}", "size", &size);
+		if (eof && nbusy == 0)
+			break;
 
-			openTagFile ();
-			if (size == -1)
-			{					/* read from disk */
-				if (iargs->sandbox) {
-					error (FATAL,
-						   "invalid request in sandbox submode: reading file contents from a file is limited");
-					closeTagFile (false);
-					goto next;
-				}
+		if (! eof && nidle > 0)
+		{
+			fds[nfds].fd = STDIN_FILENO;
+			fds[nfds].events = POLLIN;
+			nfds++;
+		}
+		for (unsigned int i = 0; i < nworkers; i++)
+		{
+			if (workers[i].responseFd < 0)
+				continue;
+			fds[nfds].fd = workers[i].responseFd;
+			fds[nfds].events = POLLIN;
+			nfds++;
+		}
+
+		if (poll (fds, nfds, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			error (FATAL | PERROR, "failed in poll");
+			exit (1);
+		}
 
-				createTagsForEntry (filename);
+		for (unsigned int j = 0; j < nfds; j++)
+		{
+			if (! (fds[j].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+
+			if (fds[j].fd == STDIN_FILENO)
+			{
+				ssize_t n = read (STDIN_FILENO, buffer, sizeof (buffer));
+				if (n > 0)
+					vStringNCatS (input, buffer, n);
+				else if (n == 0 || errno != EINTR)
+					eof = true;
+				continue;
 			}
-			else
-			{					/* read nbytes from stream */
-				unsigned char *data = eMalloc (size);
-				size = fread (data, 1, size, stdin);
-				MIO *mio = mio_new_memory (data, size, eRealloc, eFreeNoNullCheck);
-				parseFileWithMio (filename, mio, NULL);
-				mio_unref (mio);
+
+			interactiveWorker *w = NULL;
+			for (unsigned int i = 0; i < nworkers; i++)
+				if (workers[i].responseFd == fds[j].fd)
+					w = workers + i;
+
+			ssize_t n = read (w->responseFd, buffer, sizeof (buffer));
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n > 0)
+			{
+				if (forwardResponse (w, buffer, n))
+				{
+					w->busy = false;
+					if (w->requestId)
+						eFree (w->requestId);
+					w->requestId = NULL;
+				}
+				continue;
 			}
 
-			closeTagFile (false);
-			fputs ("{\"_type\": \"completed\", \"command\": \"generate-tags\"}\n", stdout);
-			fflush(stdout);
+			/* The worker has gone. */
+			retireInteractiveWorker (w);
+			if (w->busy)
+			{
+				iargs->requestId = w->requestId;
+				error (FATAL, "the worker serving the request terminated unexpectedly");
+				iargs->requestId = NULL;
+				if (w->requestId)
+					eFree (w->requestId);
+				w->requestId = NULL;
+				w->busy = false;
+			}
+			if (! eof)
+				spawnInteractiveWorker (iargs, workers, w - workers);
 		}
-		else
+		fflush (stdout);
+	}
+
+	for (unsigned int i = 0; i < nworkers; i++)
+	{
+		if (workers[i].responseFd >= 0)
+			retireInteractiveWorker (workers + i);
+		vStringDelete (workers[i].response);
+	}
+	vStringDelete (input);
+	eFree (fds);
+	eFree (workers);
+}
+#endif	/* HAVE_INTERACTIVE_WORKERS */
+
+#ifdef HAVE_INTERACTIVE_DAEMON
+/*
+ * With --_daemon=PATH, ctags listens on a unix domain socket and speaks
+ * the interactive protocol with each client connecting to it. All
+ * parsers are initialized before accepting clients; a process forked
+ * for a client starts with the parsers, compiled regex tables, and
+ * keyword tables already built.
+ */
+static volatile sig_atomic_t daemonStopRequested;
+
+static void requestDaemonStop (int signum CTAGS_ATTR_UNUSED)
+{
+	daemonStopRequested = 1;
+}
+
+static int openDaemonSocket (const char *const path)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	int fd;
+
+	/* The explicit exit calls are needed because "error (FATAL,..."
+	   just prints a message in interactive mode. */
+	if (strlen (path) >= sizeof (addr.sun_path))
+	{
+		error (FATAL, "too long socket path: %s", path);
+		exit (1);
+	}
+
+	/* Remove the socket left by a daemon that didn't exit cleanly.
+	   Don't touch anything other than a socket. */
+	if (stat (path, &st) == 0 && S_ISSOCK (st.st_mode))
+		unlink (path);
+
+	fd = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+	{
+		error (FATAL | PERROR, "cannot make a socket");
+		exit (1);
+	}
+
+	memset (&addr, 0, sizeof (addr));
+	addr.sun_family = AF_UNIX;
+	strcpy (addr.sun_path, path);
+	if (bind (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0)
+	{
+		error (FATAL | PERROR, "cannot bind the socket to %s", path);
+		exit (1);
+	}
+	if (listen (fd, SOMAXCONN) < 0)
+	{
+		error (FATAL | PERROR, "cannot listen on %s", path);
+		unlink (path);
+		exit (1);
+	}
+
+	return fd;
+}
+
+static void serveDaemonClient (struct interactiveModeArgs *iargs, int listener, int conn)
+{
+	close (listener);
+	signal (SIGCHLD, SIG_DFL);
+	signal (SIGINT, SIG_DFL);
+	signal (SIGTERM, SIG_DFL);
+
+	dup2 (conn, STDIN_FILENO);
+	dup2 (conn, STDOUT_FILENO);
+	close (conn);
+
+	fputs ("{\"_type\": \"program\", \"name\": \"" PROGRAM_NAME "\", \"version\": \"" PROGRAM_VERSION "\"}\n", stdout);
+	fflush (stdout);
+
+	if (iargs->workers > 1)
+		dispatchRequests (iargs);
+	else
+	{
+		if (iargs->sandbox)
+			enterSandbox ();
+		serveRequests (iargs, false);
+	}
+	exit (0);
+}
+
+static void runDaemon (struct interactiveModeArgs *iargs)
+{
+	struct sigaction sa;
+	int listener;
+
+	/* Do the work shared by all clients only once. */
+	initializeParser (LANG_AUTO);
+	compileLanguageRegexPatterns (LANG_AUTO);
+
+	listener = openDaemonSocket (iargs->socketPath);
+	verbose ("listening on %s\n", iargs->socketPath);
+
+	memset (&sa, 0, sizeof (sa));
+	sa.sa_handler = requestDaemonStop;
+	sigemptyset (&sa.sa_mask);
+	/* No SA_RESTART; accept () must return when a signal arrives. */
+	sigaction (SIGINT, &sa, NULL);
+	sigaction (SIGTERM, &sa, NULL);
+	signal (SIGCHLD, SIG_IGN);	/* Let the kernel reap the clients. */
+
+	fflush (stdout);
+	while (! daemonStopRequested)
+	{
+		int conn = accept (listener, NULL, NULL);
+		if (conn < 0)
 		{
-			error (FATAL, "unknown command name");
-			goto next;
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			/* Running out of resources may be temporary. */
+			if (errno == EMFILE || errno == ENFILE
+				|| errno == ENOBUFS || errno == ENOMEM)
+			{
+				error (WARNING | PERROR, "failed in accept");
+				sleep (1);
+				continue;
+			}
+			error (FATAL | PERROR, "failed in accept");
+			unlink (iargs->socketPath);
+			exit (1);
 		}
 
-	next:
-		json_decref (request);
+		pid_t pid = fork ();
+		if (pid == 0)
+			serveDaemonClient (iargs, listener, conn);
+		else if (pid < 0)
+			error (WARNING | PERROR, "cannot fork a process for a client");
+		close (conn);
 	}
+
+	close (listener);
+	unlink (iargs->socketPath);
+}
+#endif	/* HAVE_INTERACTIVE_DAEMON */
+
+void interactiveLoop (cookedArgs *args CTAGS_ATTR_UNUSED, void *user)
+{
+	struct interactiveModeArgs *iargs = user;
+
+#ifdef HAVE_INTERACTIVE_DAEMON
+	if (iargs->socketPath)
+	{
+		runDaemon (iargs);
+		return;
+	}
+#endif
+
+	fputs ("{\"_type\": \"program\", \"name\": \"" PROGRAM_NAME "\", \"version\": \"" PROGRAM_VERSION "\"}\n", stdout);
+	fflush (stdout);
+
+#ifdef HAVE_INTERACTIVE_WORKERS
+	if (iargs->workers > 1)
+	{
+		dispatchRequests (iargs);
+		return;
+	}
+#endif
+
+	if (iargs->sandbox)
+		enterSandbox ();
+	serveRequests (iargs, false);
 }
 #endif
 
@@ -583,7 +1301,9 @@ extern int ctags_cli_main (int argc CTAGS_ATTR_UNUSED, char **argv)
 	parseCmdlineOptions (args);
 	checkOptions ();
 
+	startMemoryStats ();
 	runMainLoop (args);
+	closeTraceEvents ();
 
 	/*  Clean up.
 	 */
@@ -591,6 +1311,7 @@ extern int ctags_cli_main (int argc CTAGS_ATTR_UNUSED, char **argv)
 	freeKeywordTable ();
 	freeRoutineResources ();
 	freeInputFileResources ();
+	dedupResetInputs ();
 	freeTagFileResources ();
 	freeOptionResources ();
 	freeParserResources ();
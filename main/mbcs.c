@@ -29,7 +29,75 @@
 #include "routines.h"
 
 static iconv_t iconv_fd = (iconv_t) -1;
+static char *iconv_input_encoding;
+static char *iconv_output_encoding;
+static bool converting;
+/* Whether 7-bit bytes are converted to themselves. */
+static bool ascii_transparent;
 
+static char *convert_buf;
+static size_t convert_buf_size;
+
+static bool isAscii (const char *s, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+		if ((unsigned char) s[i] & 0x80)
+			return false;
+	return true;
+}
+
+/* Converts SRC to convert_buf. Returns the length of the result, or
+ * (size_t) -1 if SRC cannot be converted. */
+static size_t convertBytes (const char *src, size_t src_len)
+{
+	size_t dest_len;
+	char *dest_ptr;
+
+	/* Should be longest length of bytes. so maybe utf8. */
+	if (convert_buf_size < src_len * 4 + 1)
+	{
+		convert_buf_size = src_len * 4 + 1;
+		convert_buf = xRealloc (convert_buf, convert_buf_size, char);
+	}
+	dest_ptr = convert_buf;
+	dest_len = src_len * 4;
+
+retry:
+	if (iconv (iconv_fd, (char **) &src, &src_len, &dest_ptr, &dest_len) == (size_t) -1)
+	{
+		if (errno == EILSEQ)
+		{
+			*dest_ptr++ = '?';
+			dest_len--;
+			src++;
+			src_len--;
+			verbose ("  Encoding: %s\n", strerror(errno));
+			goto retry;
+		}
+		iconv (iconv_fd, NULL, NULL, NULL, NULL);
+		return (size_t) -1;
+	}
+
+	iconv (iconv_fd, NULL, NULL, NULL, NULL);
+	*dest_ptr = '\0';
+	return dest_ptr - convert_buf;
+}
+
+static bool isAsciiTransparent (void)
+{
+	char ascii [127];
+	size_t len;
+
+	for (size_t i = 0; i < sizeof (ascii); i++)
+		ascii [i] = (char) (i + 1);
+
+	len = convertBytes (ascii, sizeof (ascii));
+	return (len == sizeof (ascii)
+			&& memcmp (convert_buf, ascii, sizeof (ascii)) == 0);
+}
+
+/* The descriptor is kept open after closeConverter, and used again
+ * if the next input file has the same encodings. */
 extern bool openConverter (const char* inputEncoding, const char* outputEncoding)
 {
 	if (!inputEncoding || !outputEncoding)
@@ -43,6 +111,16 @@ extern bool openConverter (const char* inputEncoding, const char* outputEncoding
 		}
 		return false;
 	}
+
+	if (iconv_fd != (iconv_t) -1
+		&& strcmp (iconv_input_encoding, inputEncoding) == 0
+		&& strcmp (iconv_output_encoding, outputEncoding) == 0)
+	{
+		converting = true;
+		return true;
+	}
+
+	freeConverter ();
 	iconv_fd = iconv_open(outputEncoding, inputEncoding);
 	if (iconv_fd == (iconv_t) -1)
 	{
@@ -50,64 +128,110 @@ extern bool openConverter (const char* inputEncoding, const char* outputEncoding
 					"failed opening encoding from '%s' to '%s'", inputEncoding, outputEncoding);
 		return false;
 	}
+	iconv_input_encoding = eStrdup (inputEncoding);
+	iconv_output_encoding = eStrdup (outputEncoding);
+	ascii_transparent = isAsciiTransparent ();
+	converting = true;
 	return true;
 }
 
 extern bool isConverting (void)
 {
-	return iconv_fd != (iconv_t) -1;
+	return converting;
 }
 
 extern bool convertString (vString *const string)
 {
-	size_t dest_len, src_len;
-	char *dest, *dest_ptr, *src;
-	if (iconv_fd == (iconv_t) -1)
+	size_t dest_len;
+
+	if (!converting)
 		return false;
-	src_len = vStringLength (string);
-	/* Should be longest length of bytes. so maybe utf8. */
-	dest_len = src_len * 4;
-	dest_ptr = dest = xCalloc (dest_len, char);
-	if (!dest)
+
+	if (ascii_transparent
+		&& isAscii (vStringValue (string), vStringLength (string)))
+		return true;
+
+	dest_len = convertBytes (vStringValue (string), vStringLength (string));
+	if (dest_len == (size_t) -1)
 		return false;
-	src = vStringValue (string);
-retry:
-	if (iconv (iconv_fd, &src, &src_len, &dest_ptr, &dest_len) == (size_t) -1)
+
+	vStringNCopySUnsafe (string, convert_buf, dest_len);
+	return true;
+}
+
+extern char *convertLines (const char *data, size_t size,
+						   size_t *converted_size,
+						   long **line_offsets, unsigned int *line_count)
+{
+	vString *converted;
+	const char *line = data;
+	unsigned int count = 0, offsets_size = 0;
+	long *offsets = NULL;
+
+	if (!converting)
+		return NULL;
+
+	if (ascii_transparent && isAscii (data, size))
+		return NULL;
+
+	converted = vStringNewInit ("");
+	while (line < data + size)
 	{
-		if (errno == EILSEQ)
+		const char *nl = memchr (line, '\n', data + size - line);
+		size_t len = nl? (size_t) (nl - line) + 1: (size_t) (data + size - line);
+		size_t dest_len;
+
+		if (count == offsets_size)
 		{
-			*dest_ptr++ = '?';
-			dest_len--;
-			src++;
-			src_len--;
-			verbose ("  Encoding: %s\n", strerror(errno));
-			goto retry;
+			offsets_size = offsets_size? offsets_size * 2: 1024;
+			offsets = xRealloc (offsets, offsets_size, long);
 		}
-		eFree (dest);
-		return false;
-	}
+		offsets [count++] = line - data;
 
-	dest_len = dest_ptr - dest;
-
-	vStringClear (string);
-	if (vStringSize (string) < dest_len + 1)
-		vStringResize (string, dest_len + 1);
-	memcpy (vStringValue (string), dest, dest_len + 1);
-	vStringLength (string) = dest_len;
-	eFree (dest);
-
-	iconv (iconv_fd, NULL, NULL, NULL, NULL);
+		if (ascii_transparent && isAscii (line, len))
+			vStringNCatSUnsafe (converted, line, len);
+		else if ((dest_len = convertBytes (line, len)) != (size_t) -1)
+			vStringNCatSUnsafe (converted, convert_buf, dest_len);
+		else
+			vStringNCatSUnsafe (converted, line, len);
+		line += len;
+	}
 
-	return true;
+	*converted_size = vStringLength (converted);
+	*line_offsets = offsets;
+	*line_count = count;
+	return vStringDeleteUnwrap (converted);
 }
 
 extern void closeConverter (void)
 {
+	converting = false;
+}
+
+extern void freeConverter (void)
+{
+	converting = false;
 	if (iconv_fd != (iconv_t) -1)
 	{
 		iconv_close(iconv_fd);
 		iconv_fd = (iconv_t) -1;
 	}
+	if (iconv_input_encoding)
+	{
+		eFree (iconv_input_encoding);
+		iconv_input_encoding = NULL;
+	}
+	if (iconv_output_encoding)
+	{
+		eFree (iconv_output_encoding);
+		iconv_output_encoding = NULL;
+	}
+	if (convert_buf)
+	{
+		eFree (convert_buf);
+		convert_buf = NULL;
+		convert_buf_size = 0;
+	}
 }
 
 #endif	/* HAVE_ICONV */
@@ -25,7 +25,18 @@
 */
 extern bool openConverter (const char*, const char*);
 extern bool convertString (vString *const);
+
+/* Converts DATA line by line, for --transcode-input. Returns NULL if DATA
+ * does not need converting. Otherwise it returns the converted data, and
+ * (*LINE_OFFSETS)[N] is the offset in DATA of the line starting at the
+ * Nth line of the result. */
+extern char *convertLines (const char *data, size_t size,
+						   size_t *converted_size,
+						   long **line_offsets, unsigned int *line_count);
+
+/* Stops converting; the converter is kept for the next input file. */
 extern void closeConverter (void);
+extern void freeConverter (void);
 
 #endif /* HAVE_ICONV */
 
@@ -25,8 +25,10 @@
 
 #include "ctags.h"
 #include "debug.h"
+#include "dedup_p.h"
 #include "entry_p.h"
 #include "field_p.h"
+#include "globset_p.h"
 #include "gvars.h"
 #include "keyword_p.h"
 #include "parse_p.h"
@@ -39,6 +41,7 @@
 #include "interactive_p.h"
 #include "writer_p.h"
 #include "trace.h"
+#include "trace-event_p.h"
 
 #ifdef HAVE_JANSSON
 #include <jansson.h>
@@ -125,6 +128,7 @@ typedef stringList searchPathList;
 static searchPathList *OptlibPathList;
 
 static stringList *Excluded, *ExcludedException;
+static globSet *ExcludedSet, *ExcludedExceptionSet;	/* compiled on demand */
 static bool FilesRequired = true;
 static bool SkipConfiguration;
 
@@ -158,13 +162,14 @@ optionValues Option = {
 #ifdef HAVE_ICONV
 	.inputEncoding= NULL,
 	.outputEncoding = NULL,
+	.transcodeInput = false,
 #endif
 	.language = LANG_AUTO,
 	.followLinks = true,
 	.filter = false,
 	.filterTerminator = NULL,
 	.tagRelative = TREL_NO,
-	.printTotals = 0,
+	.printTotals = TOTALS_NO,
 	.lineDirectives = false,
 	.printLanguage =false,
 	.guessLanguageEagerly = false,
@@ -173,6 +178,9 @@ optionValues Option = {
 	.patternLengthLimit = 96,
 	.putFieldPrefix = false,
 	.maxRecursionDepth = 0xffffffff,
+	.readAheadFiles = 64,
+	.readAheadBytes = 16 * 1024 * 1024,
+	.dedupInputs = DEDUP_INPUTS_NO,
 	.interactive = false,
 	.fieldsReset = false,
 #ifdef _WIN32
@@ -241,6 +249,13 @@ static optionDescription LongOptionDescription [] = {
  {1,0,"  -L <file>"},
  {1,0,"       A list of input file names is read from the specified <file>."},
  {1,0,"       If specified as \"-\", then standard input is read."},
+ {1,0,"  --read-ahead=<files>[,<bytes>]"},
+ {1,0,"       Read at most <files> input files and <bytes> bytes ahead of the parsers"},
+ {1,0,"       [64,16777216]. 0 disables read-ahead."},
+ {1,0,"  --dedup-inputs[=(no|reuse|skip)]"},
+ {1,0,"       Parse an input having the same name, language and contents as an input"},
+ {1,0,"       parsed before only once [no]. reuse writes its tags again under the"},
+ {1,0,"       other name; skip writes nothing for the other."},
  {1,0,"  --append[=(yes|no)]"},
  {1,0,"       Should tags should be appended to existing tag file [no]?"},
  {1,0,"  -a   Append the tags to an existing tag file."},
@@ -248,6 +263,12 @@ static optionDescription LongOptionDescription [] = {
  {1,0,"       Write tags to specified <tagfile>. Value of \"-\" writes tags to stdout"},
  {1,0,"       [\"tags\"; or \"TAGS\" when -e supplied]."},
  {1,0,"  -o   Alternative for -f."},
+ {1,0,"  --watch[=(yes|no)]"},
+#ifdef HAVE_SYS_INOTIFY_H
+ {1,0,"       Keep running after -R, updating the tag file when files change [no]."},
+#else
+ {1,0,"       Not supported on this platform."},
+#endif
  {1,0,""},
  {1,0,"Output Format Options"},
  {0,0,"  --format=(1|2)"},
@@ -256,11 +277,7 @@ static optionDescription LongOptionDescription [] = {
 #else
  {0,0,"       Force output of specified tag file format [2]."},
 #endif
-#ifdef HAVE_JANSSON
- {0,0,"  --output-format=(u-ctags|e-ctags|etags|xref|json)"},
-#else
- {0,0,"  --output-format=(u-ctags|e-ctags|etags|xref)"},
-#endif
+ {0,0,"  --output-format=(u-ctags|e-ctags|etags|xref|json|binary)"},
  {0,0,"      Specify the output format. [u-ctags]"},
  {0,0,"  -e   Output tag file for use with Emacs."},
  {1,0,"  -x   Print a tabular cross reference file to standard output."},
@@ -277,6 +294,8 @@ static optionDescription LongOptionDescription [] = {
  {1,0,"  --output-encoding=<encoding>"},
  {1,0,"       The <encoding> to write the tag file in. Defaults to UTF-8 if --input-encoding"},
  {1,0,"       is specified, otherwise no conversion is performed."},
+ {1,0,"  --transcode-input[=(yes|no)]"},
+ {1,0,"       Convert each input file to the output encoding before parsing it [no]."},
 #endif
  {1,1,"  --_xformat=<field_format>"},
  {1,1,"       Specify custom format for tabular cross reference (-x)."},
@@ -484,8 +503,9 @@ static optionDescription LongOptionDescription [] = {
  {0,0,"       input file."},
  {1,0,"  --quiet[=(yes|no)]"},
  {0,0,"       Don't print NOTICE class messages [no]."},
- {1,0,"  --totals[=(yes|no|extra)]"},
+ {1,0,"  --totals[=(yes|no|extra|json)]"},
  {1,0,"       Print statistics about input and tag files [no]."},
+ {1,0,"       json prints a report for each parser in JSON."},
  {1,0,"  --verbose[=(yes|no)]"},
  {1,0,"       Enable verbose messages describing actions on each input file."},
  {1,0,"  --version[=<language>]"},
@@ -501,6 +521,10 @@ static optionDescription LongOptionDescription [] = {
 
  {1,1,"  --_anonhash=<fname>"},
  {1,1,"       Used in u-ctags test harness"},
+#ifdef HAVE_INTERACTIVE_DAEMON
+ {0,1,"  --_daemon=<path>"},
+ {0,1,"       Serve interactive requests to clients connecting to unix domain socket <path>."},
+#endif
  {1,1,"  --_dump-keywords"},
  {1,1,"       Dump keywords of initialized parser(s)."},
  {1,1,"  --_dump-options"},
@@ -511,6 +535,8 @@ static optionDescription LongOptionDescription [] = {
  {1,1,"       Make all warnings fatal."},
  {1,1,"  --_force-initializing"},
  {1,1,"       Initialize all parsers in early stage"},
+ {1,1,"  --_regex-profile[=(yes|no)]"},
+ {1,1,"       Print the cost of each regex pattern to stderr after running."},
 #ifdef HAVE_JANSSON
  {0,1,"  --_interactive"
 #ifdef HAVE_SECCOMP
@@ -521,11 +547,17 @@ static optionDescription LongOptionDescription [] = {
 #ifdef HAVE_SECCOMP
  {0,1,"       Enter file I/O limited interactive mode if sandbox is specified. [default]"},
 #endif
+#ifdef HAVE_INTERACTIVE_WORKERS
+ {0,1,"  --_interactive-workers=<N>"},
+ {0,1,"       Serve interactive requests with <N> worker processes. [1]"},
+#endif
 #endif
 #ifdef DO_TRACING
  {1,1,"  --_trace=<list>"},
  {1,1,"       Trace parsers for the languages."},
 #endif
+ {1,1,"  --_trace-events=<file>"},
+ {1,1,"       Write spans of parsing, sorting, etc. to <file> in Chrome trace event format."},
  {1,1, NULL}
 };
 
@@ -586,9 +618,15 @@ static struct Feature {
 #ifdef HAVE_LIBXML
 	{"xpath", "linked with library for parsing xml input"},
 #endif
-#ifdef HAVE_JANSSON
 	{"json", "supports json format output"},
+#ifdef HAVE_JANSSON
 	{"interactive", "accepts source code from stdin"},
+#ifdef HAVE_INTERACTIVE_WORKERS
+	{"interactive-workers", "serves interactive requests with worker processes"},
+#endif
+#ifdef HAVE_INTERACTIVE_DAEMON
+	{"daemon", "serves interactive requests over a unix domain socket"},
+#endif
 #endif
 #ifdef HAVE_SECCOMP
 	{"sandbox", "linked with code for system call level sandbox"},
@@ -596,6 +634,9 @@ static struct Feature {
 #ifdef HAVE_LIBYAML
 	{"yaml", "linked with library for parsing yaml input"},
 #endif
+#ifdef HAVE_SYS_INOTIFY_H
+	{"watch", "keeps a tag file up to date with --watch"},
+#endif
 #ifdef CASE_INSENSITIVE_FILENAMES
 	{"case-insensitive-filenames", "TO BE WRITTEN"},
 #endif
@@ -774,11 +815,34 @@ extern void checkOptions (void)
 		if (Option.printTotals)
 		{
 			error (WARNING, "%s disables totals", notice);
-			Option.printTotals = 0;
+			Option.printTotals = TOTALS_NO;
 		}
 		if (Option.tagFileName != NULL)
 			error (WARNING, "%s ignores output tag file name", notice);
 	}
+	if (Option.watch)
+	{
+		notice = "watch mode";
+		if (!Option.recurse)
+			error (FATAL, "%s requires --recurse", notice);
+		if (Option.filter || Option.interactive)
+			error (FATAL, "%s is not compatible with filter or interactive mode", notice);
+		if (isDestinationStdout ())
+			error (FATAL, "%s is not compatible with tags to stdout", notice);
+		if (!writerIsLineOrientedByFile ())
+			error (FATAL, "%s supports only the ctags output formats", notice);
+	}
+	if (writerIsBinary ())
+	{
+		notice = "binary output";
+		if (Option.append)
+			error (FATAL, "%s is not compatible with append mode", notice);
+		if (Option.sorted != SO_UNSORTED)
+		{
+			error (WARNING, "%s disables sorting", notice);
+			Option.sorted = SO_UNSORTED;
+		}
+	}
 	writerCheckOptions (Option.fieldsReset);
 }
 
@@ -866,7 +930,6 @@ static void setXrefMode (void)
 	setTagWriter (WRITER_XREF, NULL);
 }
 
-#ifdef HAVE_JANSSON
 static void setJsonMode (void)
 {
 	enablePtag (PTAG_JSON_OUTPUT_VERSION, true);
@@ -874,7 +937,14 @@ static void setJsonMode (void)
 	enablePtag (PTAG_FILE_FORMAT, false);
 	setTagWriter (WRITER_JSON, NULL);
 }
-#endif
+
+static void setBinaryMode (void)
+{
+	Option.sorted = SO_UNSORTED;
+	enablePtag (PTAG_OUTPUT_MODE, false);
+	enablePtag (PTAG_FILE_FORMAT, false);
+	setTagWriter (WRITER_BINARY, NULL);
+}
 
 /*
  *  Cooked argument parsing
@@ -1053,6 +1123,16 @@ extern void cArgForth (cookedArgs* const current)
 	}
 }
 
+/* Returns the arguments from the current one if CURRENT reads an argv,
+ * or NULL. */
+extern char* const* cArgArgv (cookedArgs* const current)
+{
+	Assert (current != NULL);
+	if (current->args->type != ARG_ARGV || cArgOptionPending (current))
+		return NULL;
+	return current->args->u.argvArgs.item;
+}
+
 /*
  *  File extension and language mapping
  */
@@ -1169,9 +1249,17 @@ static void processEtagsInclude (
 }
 
 static void processExcludeOptionCommon (
-	stringList** list, const char *const optname, const char *const parameter)
+	stringList** list, globSet **set,
+	const char *const optname, const char *const parameter)
 {
 	const char *const fileName = parameter + 1;
+
+	if (*set)
+	{
+		globSetDelete (*set);
+		*set = NULL;
+	}
+
 	if (parameter [0] == '\0')
 		freeList (list);
 	else if (parameter [0] == '@')
@@ -1201,13 +1289,34 @@ static void processExcludeOptionCommon (
 static void processExcludeOption (
 		const char *const option, const char *const parameter)
 {
-	processExcludeOptionCommon (&Excluded, option, parameter);
+	processExcludeOptionCommon (&Excluded, &ExcludedSet, option, parameter);
 }
 
 static void processExcludeExceptionOption (
 		const char *const option, const char *const parameter)
 {
-	processExcludeOptionCommon (&ExcludedException, option, parameter);
+	processExcludeOptionCommon (&ExcludedException, &ExcludedExceptionSet, option, parameter);
+}
+
+static bool isFileMatched (const stringList *list, globSet **set,
+						   const char *const name, const char *const base)
+{
+	if (list == NULL || stringListCount (list) == 0)
+		return false;
+
+	if (*set == NULL)
+		*set = globSetNew (list);
+
+	return globSetMatched (*set, base)
+		|| (name != base && globSetMatched (*set, name));
+}
+
+extern void compileExcludePatterns (void)
+{
+	if (Excluded && ExcludedSet == NULL)
+		ExcludedSet = globSetNew (Excluded);
+	if (ExcludedException && ExcludedExceptionSet == NULL)
+		ExcludedExceptionSet = globSetNew (ExcludedException);
 }
 
 extern bool isExcludedFile (const char* const name,
@@ -1221,24 +1330,12 @@ extern bool isExcludedFile (const char* const name,
 		&& stringListCount (ExcludedException) > 0)
 		return false;
 
-	if (Excluded != NULL)
-	{
-		result = stringListFileMatched (Excluded, base);
-		if (! result  &&  name != base)
-			result = stringListFileMatched (Excluded, name);
-	}
-
-	if (result && ExcludedException != NULL)
-	{
-		bool result_exception;
+	result = isFileMatched (Excluded, &ExcludedSet, name, base);
 
-		result_exception = stringListFileMatched (ExcludedException, base);
-		if (! result_exception && name != base)
-			result_exception = stringListFileMatched (ExcludedException, name);
+	if (result
+		&& isFileMatched (ExcludedException, &ExcludedExceptionSet, name, base))
+		result = false;
 
-		if (result_exception)
-			result = false;
-	}
 	return result;
 }
 
@@ -1659,50 +1756,82 @@ static void processHelpFullOption (
 }
 
 #ifdef HAVE_JANSSON
+static struct interactiveModeArgs interactiveArgs;
+
 static void processInteractiveOption (
 		const char *const option CTAGS_ATTR_UNUSED,
 		const char *const parameter)
 {
-	static struct interactiveModeArgs args;
-
-
 	if (parameter && (strcmp (parameter, "sandbox") == 0))
 	{
 		Option.interactive = INTERACTIVE_SANDBOX;
-		args.sandbox = true;
+		interactiveArgs.sandbox = true;
 	}
 	else if (parameter && (strcmp (parameter, "default") == 0))
 	{
 		Option.interactive = INTERACTIVE_DEFAULT;
-		args.sandbox = false;
+		interactiveArgs.sandbox = false;
 	}
 	else if ((!parameter) || *parameter == '\0')
 	{
 		Option.interactive = INTERACTIVE_DEFAULT;
-		args.sandbox = false;
+		interactiveArgs.sandbox = false;
 	}
 	else
 		error (FATAL, "Unknown option argument \"%s\" for --%s option",
 			   parameter, option);
 
 #ifndef HAVE_SECCOMP
-	if (args.sandbox)
+	if (interactiveArgs.sandbox)
 		error (FATAL, "sandbox submode is not supported on this platform");
 #endif
 
 #ifdef ENABLE_GCOV
-	if (args.sandbox)
+	if (interactiveArgs.sandbox)
 		error (FATAL, "sandbox submode does not work if gcov is instrumented");
 #endif
 
 	Option.sorted = SO_UNSORTED;
-	setMainLoop (interactiveLoop, &args);
-	setErrorPrinter (jsonErrorPrinter, NULL);
+	setMainLoop (interactiveLoop, &interactiveArgs);
+	setErrorPrinter (jsonErrorPrinter, &interactiveArgs);
 	setTagWriter (WRITER_JSON, NULL);
 	enablePtag (PTAG_JSON_OUTPUT_VERSION, true);
 
 	json_set_alloc_funcs (eMalloc, eFree);
 }
+
+static void processInteractiveWorkersOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	if (!strToUInt (parameter, 0, &interactiveArgs.workers) || interactiveArgs.workers == 0)
+		error (FATAL, "-%s: Invalid number of workers: %s", option, parameter);
+
+#ifndef HAVE_INTERACTIVE_WORKERS
+	if (interactiveArgs.workers > 1)
+		error (FATAL, "multiple workers are not supported on this platform");
+#endif
+}
+
+static void processDaemonOption (
+		const char *const option, const char *const parameter)
+{
+#ifndef HAVE_INTERACTIVE_DAEMON
+	error (FATAL, "--%s option is not supported on this platform", option);
+#endif
+
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A socket path is needed after \"%s\" option", option);
+
+	if (!Option.interactive)
+		processInteractiveOption ("_interactive", NULL);
+
+	if (interactiveArgs.socketPath)
+		eFree (interactiveArgs.socketPath);
+	interactiveArgs.socketPath = eStrdup (parameter);
+}
 #endif
 
 static void processIf0Option (const char *const option,
@@ -2414,10 +2543,10 @@ static void processOutputFormat (const char *const option CTAGS_ATTR_UNUSED,
 		setEtagsMode ();
 	else if (strcmp (parameter, "xref") == 0)
 		setXrefMode ();
-#ifdef HAVE_JANSSON
 	else if (strcmp (parameter, "json") == 0)
 		setJsonMode ();
-#endif
+	else if (strcmp (parameter, "binary") == 0)
+		setBinaryMode ();
 	else
 		error (FATAL, "unknown output format name supplied for \"%s=%s\"", option, parameter);
 }
@@ -2526,15 +2655,31 @@ static void processTotals (
 		const char *const option, const char *const parameter)
 {
 	if (isFalse (parameter))
-		Option.printTotals = 0;
+		Option.printTotals = TOTALS_NO;
 	else if (isTrue (parameter) || *parameter == '\0')
-		Option.printTotals = 1;
+		Option.printTotals = TOTALS_YES;
 	else if (strcasecmp (parameter, "extra") == 0)
-		Option.printTotals = 2;
+		Option.printTotals = TOTALS_EXTRA;
+	else if (strcasecmp (parameter, "json") == 0)
+		Option.printTotals = TOTALS_JSON;
 	else
 		error (FATAL, "Invalid value for \"%s\" option", option);
 }
 
+static void processDedupInputsOption (
+		const char *const option, const char *const parameter)
+{
+	if (isFalse (parameter))
+		Option.dedupInputs = DEDUP_INPUTS_NO;
+	else if (isTrue (parameter) || *parameter == '\0'
+			 || strcmp (parameter, "reuse") == 0)
+		Option.dedupInputs = DEDUP_INPUTS_REUSE;
+	else if (strcmp (parameter, "skip") == 0)
+		Option.dedupInputs = DEDUP_INPUTS_SKIP;
+	else
+		error (FATAL, "Invalid value for \"%s\" option: %s", option, parameter);
+}
+
 static void installHeaderListDefaults (void)
 {
 	Option.headerExt = stringListNewFromArgv (HeaderExtensions);
@@ -2692,6 +2837,14 @@ static void processVersionOption (
 	exit (0);
 }
 
+static void processTraceEventsOption (const char *const option,
+									  const char *const parameter)
+{
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A file name is needed after \"%s\" option", option);
+	openTraceEvents (parameter);
+}
+
 #ifdef DO_TRACING
 static void processTraceOption(const char *const option CTAGS_ATTR_UNUSED,
 							   const char *const parameter)
@@ -2795,6 +2948,31 @@ static void processMaxRecursionDepthOption (const char *const option, const char
 	Option.maxRecursionDepth = atol(parameter);
 }
 
+static void processReadAheadOption (const char *const option, const char *const parameter)
+{
+	unsigned int files;
+	unsigned long bytes = Option.readAheadBytes;
+	const char *comma;
+
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	comma = strchr (parameter, ',');
+	if (comma)
+	{
+		char *tmp = eStrndup (parameter, comma - parameter);
+		bool ok = strToUInt (tmp, 0, &files);
+		eFree (tmp);
+		if (!ok || !strToULong (comma + 1, 0, &bytes))
+			error (FATAL, "-%s: Invalid read-ahead window: %s", option, parameter);
+	}
+	else if (!strToUInt (parameter, 0, &files))
+		error (FATAL, "-%s: Invalid read-ahead window: %s", option, parameter);
+
+	Option.readAheadFiles = files;
+	Option.readAheadBytes = bytes;
+}
+
 static void processPatternLengthLimit(const char *const option, const char *const parameter)
 {
 	if (parameter == NULL || parameter[0] == '\0')
@@ -2842,6 +3020,7 @@ static void processDumpOptionsOption (const char *const option, const char *cons
 static void processDumpPreludeOption (const char *const option, const char *const parameter);
 
 static parametricOption ParametricOptions [] = {
+	{ "dedup-inputs",           processDedupInputsOption,       true,   STAGE_ANY },
 	{ "etags-include",          processEtagsInclude,            false,  STAGE_ANY },
 	{ "exclude",                processExcludeOption,           false,  STAGE_ANY },
 	{ "exclude-exception",      processExcludeExceptionOption,  false,  STAGE_ANY },
@@ -2889,11 +3068,15 @@ static parametricOption ParametricOptions [] = {
 	{ "output-format",          processOutputFormat,            true,   STAGE_ANY },
 	{ "pattern-length-limit",   processPatternLengthLimit,      true,   STAGE_ANY },
 	{ "pseudo-tags",            processPseudoTags,              false,  STAGE_ANY },
+	{ "read-ahead",             processReadAheadOption,         true,   STAGE_ANY },
 	{ "sort",                   processSortOption,              true,   STAGE_ANY },
 	{ "tag-relative",           processTagRelative,             true,   STAGE_ANY },
 	{ "totals",                 processTotals,                  true,   STAGE_ANY },
 	{ "version",                processVersionOption,           true,   STAGE_ANY },
 	{ "_anonhash",              processAnonHashOption,          false,  STAGE_ANY },
+#ifdef HAVE_JANSSON
+	{ "_daemon",                processDaemonOption,            true,   STAGE_ANY },
+#endif
 	{ "_dump-keywords",         processDumpKeywordsOption,      false,  STAGE_ANY },
 	{ "_dump-options",          processDumpOptionsOption,       false,  STAGE_ANY },
 	{ "_dump-prelude",          processDumpPreludeOption,       false,  STAGE_ANY },
@@ -2902,6 +3085,7 @@ static parametricOption ParametricOptions [] = {
 	{ "_force-quit",            processForceQuitOption,         false,  STAGE_ANY },
 #ifdef HAVE_JANSSON
 	{ "_interactive",           processInteractiveOption,       true,   STAGE_ANY },
+	{ "_interactive-workers",   processInteractiveWorkersOption, true,  STAGE_ANY },
 #endif
 	{ "_list-kinddef-flags",    processListKinddefFlagsOptions, true,   STAGE_ANY },
 	{ "_list-langdef-flags",    processListLangdefFlagsOptions, true,   STAGE_ANY },
@@ -2910,6 +3094,7 @@ static parametricOption ParametricOptions [] = {
 #ifdef DO_TRACING
 	{ "_trace",                 processTraceOption,             false,  STAGE_ANY },
 #endif
+	{ "_trace-events",          processTraceEventsOption,       false,  STAGE_ANY },
 	{ "_xformat",               processXformatOption,           false,  STAGE_ANY },
 };
 
@@ -2927,13 +3112,18 @@ static booleanOption BooleanOptions [] = {
 	{ "quiet",          &Option.quiet,                  false, STAGE_ANY },
 #ifdef RECURSE_SUPPORTED
 	{ "recurse",        &Option.recurse,                false, STAGE_ANY },
+#endif
+#ifdef HAVE_ICONV
+	{ "transcode-input", &Option.transcodeInput,        false, STAGE_ANY },
 #endif
 	{ "verbose",        &ctags_verbose,                 false, STAGE_ANY },
+	{ "watch",          &Option.watch,                  true,  STAGE_ANY },
 #ifdef _WIN32
 	{ "use-slash-as-filename-separator", (bool *)&Option.useSlashAsFilenameSeparator, false, STAGE_ANY },
 #endif
 	{ "with-list-header", &localOption.withListHeader,  true,  STAGE_ANY },
 	{ "_fatal-warnings",&Option.fatalWarnings,          false, STAGE_ANY },
+	{ "_regex-profile", &Option.regexProfile,           false, STAGE_ANY },
 };
 
 /*
@@ -3503,6 +3693,11 @@ static void parseOption (cookedArgs* const args)
 			processShortOption (args->item, parameter);
 		}
 		cArgForth (args);
+
+		/* The tags of the inputs parsed so far may differ from the ones
+		 * the same inputs would make from now. */
+		if (NonOptionEncountered)
+			dedupResetInputs ();
 	}
 }
 
@@ -3946,6 +4141,10 @@ extern void freeOptionResources (void)
 
 	freeList (&Excluded);
 	freeList (&ExcludedException);
+	if (ExcludedSet)
+		globSetDelete (ExcludedSet);
+	if (ExcludedExceptionSet)
+		globSetDelete (ExcludedExceptionSet);
 	freeList (&Option.headerExt);
 	freeList (&Option.etagsInclude);
 
@@ -70,6 +70,13 @@ typedef enum eTagRelative {
 	TREL_NEVER,
 } tagRelative;
 
+typedef enum eTotalsMode {
+	TOTALS_NO,
+	TOTALS_YES,
+	TOTALS_EXTRA,	/* also print statistics of each parser */
+	TOTALS_JSON,	/* print a report per parser in JSON */
+} totalsMode;
+
 /*  This stores the command line options.
  */
 typedef struct sOptionValues {
@@ -89,22 +96,30 @@ typedef struct sOptionValues {
 #ifdef HAVE_ICONV
 	char *inputEncoding;	/* --input-encoding	convert text into --output-encoding */
 	char *outputEncoding;	/* --output-encoding	write tags file as this encoding */
+	bool transcodeInput;	/* --transcode-input */
 #endif
 	langType language;      /* --lang specified language override */
 	bool followLinks;    /* --link  follow symbolic links? */
 	bool filter;         /* --filter  behave as filter: files in, tags out */
 	char* filterTerminator; /* --filter-terminator  string to output */
 	tagRelative tagRelative;    /* --tag-relative file paths relative to tag file */
-	int  printTotals;    /* --totals  print cumulative statistics */
+	totalsMode printTotals;    /* --totals  print cumulative statistics */
 	bool lineDirectives; /* --line-directives  process #line directives */
 	bool printLanguage;  /* --print-language */
 	bool guessLanguageEagerly; /* --guess-language-eagerly|-G */
 	bool quiet;		      /* --quiet */
 	bool fatalWarnings;	/* --_fatal-warnings */
+	bool regexProfile;	/* --_regex-profile */
 	unsigned int patternLengthLimit; /* --pattern-length-limit=N */
 	bool putFieldPrefix;		 /* --put-field-prefix */
 	unsigned int maxRecursionDepth; /* --maxdepth=<max-recursion-depth> */
+	unsigned int readAheadFiles;	/* --read-ahead=<files>[,<bytes>] */
+	unsigned long readAheadBytes;
+	enum dedupInputsMode { DEDUP_INPUTS_NO,
+						   DEDUP_INPUTS_REUSE,
+						   DEDUP_INPUTS_SKIP, } dedupInputs; /* --dedup-inputs */
 	bool fieldsReset;				/* --fields=[^+-] */
+	bool watch;				/* --watch */
 	enum interactiveMode { INTERACTIVE_NONE = 0,
 						   INTERACTIVE_DEFAULT,
 						   INTERACTIVE_SANDBOX, } interactive; /* --interactive */
@@ -146,8 +161,12 @@ extern bool cArgOff (cookedArgs* const current);
 extern bool cArgIsOption (cookedArgs* const current);
 extern const char* cArgItem (cookedArgs* const current);
 extern void cArgForth (cookedArgs* const current);
+extern char* const* cArgArgv (cookedArgs* const current);
 extern bool isExcludedFile (const char* const name,
 							bool falseIfExceptionsAreDefeind);
+/* Makes isExcludedFile () safe to call from another thread until
+ * --exclude or --exclude-exception is given again. */
+extern void compileExcludePatterns (void);
 extern bool isIncludeFile (const char *const fileName);
 extern void parseCmdlineOptions (cookedArgs* const cargs);
 extern void previewFirstOption (cookedArgs* const cargs);
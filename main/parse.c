@@ -18,9 +18,11 @@
 #include "options_p.h"
 
 #include <string.h>
+#include <fnmatch.h>
 
 #include "ctags.h"
 #include "debug.h"
+#include "dedup_p.h"
 #include "entry_p.h"
 #include "field_p.h"
 #include "flags_p.h"
@@ -43,6 +45,7 @@
 #include "subparser.h"
 #include "subparser_p.h"
 #include "trace.h"
+#include "trace-event_p.h"
 #include "trashbox.h"
 #include "trashbox_p.h"
 #include "vstring.h"
@@ -470,55 +473,301 @@ extern langType getLanguageForCommand (const char *const command, langType start
 											&tmp_specType);
 }
 
-static langType getPatternLanguageAndSpec (const char *const baseName, langType start_index,
-					   const char **const spec, enum specType *specType)
+/*
+ * Compiled language map
+ *
+ * Choosing a parser for a file name used to walk the pattern and the
+ * extension lists of all languages, running fnmatch() on each pattern.
+ * Instead the lists are compiled into the tables below on the first
+ * lookup after --langmap or --map-<LANG> changes them:
+ *
+ * - patterns without any glob meta character are looked up in a hash
+ *   table keyed by file name,
+ * - patterns in the form "*LITERAL" are compared against the tail of
+ *   the file name,
+ * - the other patterns are passed to fnmatch(), and
+ * - extensions are looked up in a hash table keyed by extension.
+ *
+ * Each entry remembers the language and the position in the list of
+ * the language so that the lookup chooses the same parser and spec as
+ * walking the lists in order. Whether a language is enabled is checked
+ * at lookup time; enabling or disabling a parser doesn't recompile the
+ * map.
+ */
+struct langMapEntry {
+	langType lang;
+	unsigned int order;		/* index in currentPatterns or currentExtensions */
+	const char *spec;		/* owned by currentPatterns or currentExtensions */
+	char *pattern;			/* used in matching; case-folded if needed */
+	size_t length;
+};
+
+static struct languageMap {
+	bool compiled;
+	hashTable *names;		/* file name => ptrArray of langMapEntry */
+	ptrArray *suffixes;
+	ptrArray *globs;
+	hashTable *extensions;	/* extension => ptrArray of langMapEntry */
+	ptrArray *entries;		/* owns all langMapEntry */
+} LanguageMap;
+
+#ifdef CASE_INSENSITIVE_FILENAMES
+#define langMapStrhash hashCstrcasehash
+#define langMapStreq   hashCstrcaseeq
+#define langMapStrcmp  strcasecmp
+#else
+#define langMapStrhash hashCstrhash
+#define langMapStreq   hashCstreq
+#define langMapStrcmp  strcmp
+#endif
+
+static void langMapEntryDelete (void *data)
 {
-	langType result = LANG_IGNORE;
-	unsigned int i;
+	struct langMapEntry *entry = data;
+	eFree (entry->pattern);
+	eFree (entry);
+}
 
-	if (start_index == LANG_AUTO)
-	        start_index = 0;
-	else if (start_index == LANG_IGNORE || start_index >= (int) LanguageCount)
-		return result;
+static void invalidateLanguageMap (void)
+{
+	LanguageMap.compiled = false;
+}
 
-	*spec = NULL;
-	for (i = start_index  ;  i < LanguageCount  &&  result == LANG_IGNORE  ;  ++i)
+static void clearLanguageMapIndex (void)
+{
+	if (LanguageMap.entries == NULL)
 	{
-		if (! isLanguageEnabled (i))
-			continue;
+		LanguageMap.names = hashTableNew (64, langMapStrhash, langMapStreq,
+										  NULL, (hashTableDeleteFunc)ptrArrayDelete);
+		LanguageMap.extensions = hashTableNew (512, langMapStrhash, langMapStreq,
+											   NULL, (hashTableDeleteFunc)ptrArrayDelete);
+		LanguageMap.suffixes = ptrArrayNew (NULL);
+		LanguageMap.globs = ptrArrayNew (NULL);
+		LanguageMap.entries = ptrArrayNew (langMapEntryDelete);
+		return;
+	}
+
+	hashTableClear (LanguageMap.names);
+	hashTableClear (LanguageMap.extensions);
+	ptrArrayClear (LanguageMap.suffixes);
+	ptrArrayClear (LanguageMap.globs);
+	ptrArrayClear (LanguageMap.entries);
+}
+
+static void freeLanguageMapIndex (void)
+{
+	if (LanguageMap.entries == NULL)
+		return;
+
+	hashTableDelete (LanguageMap.names);
+	hashTableDelete (LanguageMap.extensions);
+	ptrArrayDelete (LanguageMap.suffixes);
+	ptrArrayDelete (LanguageMap.globs);
+	ptrArrayDelete (LanguageMap.entries);
+	memset (&LanguageMap, 0, sizeof (LanguageMap));
+}
+
+static bool hasGlobMetaChar (const char *str)
+{
+	return strpbrk (str, "*?[\\") != NULL;
+}
+
+static char *newLanguageMapPattern (const char *str)
+{
+#ifdef CASE_INSENSITIVE_FILENAMES
+	return newUpperString (str);
+#else
+	return eStrdup (str);
+#endif
+}
+
+static struct langMapEntry *newLangMapEntry (langType lang, unsigned int order,
+											 const char *spec, const char *pattern)
+{
+	struct langMapEntry *entry = xMalloc (1, struct langMapEntry);
+
+	entry->lang = lang;
+	entry->order = order;
+	entry->spec = spec;
+	entry->pattern = newLanguageMapPattern (pattern);
+	entry->length = strlen (entry->pattern);
+	ptrArrayAdd (LanguageMap.entries, entry);
+	return entry;
+}
 
+/* Only the first entry for a language in a bucket can be chosen. */
+static void putLangMapBucket (hashTable *table, struct langMapEntry *entry)
+{
+	ptrArray *bucket = hashTableGetItem (table, entry->pattern);
+
+	if (bucket == NULL)
+	{
+		bucket = ptrArrayNew (NULL);
+		hashTablePutItem (table, entry->pattern, bucket);
+	}
+	else if (ptrArrayCount (bucket) > 0
+			 && ((struct langMapEntry *)ptrArrayLast (bucket))->lang == entry->lang)
+		return;
+	ptrArrayAdd (bucket, entry);
+}
+
+static void compileLanguageMap (void)
+{
+	clearLanguageMapIndex ();
+
+	for (unsigned int i = 0; i < LanguageCount; i++)
+	{
 		parserObject *parser = LanguageTable + i;
-		stringList* const ptrns = parser->currentPatterns;
-		vString* tmp;
+		stringList *ptrns = parser->currentPatterns;
+		stringList *exts = parser->currentExtensions;
 
-		if (ptrns != NULL && (tmp = stringListFileFinds (ptrns, baseName)))
+		for (unsigned int j = 0; ptrns && j < stringListCount (ptrns); j++)
 		{
-			result = i;
-			*spec = vStringValue(tmp);
-			*specType = SPEC_PATTERN;
-			goto found;
+			const char *ptrn = vStringValue (stringListItem (ptrns, j));
+			struct langMapEntry *entry;
+
+			if (!hasGlobMetaChar (ptrn))
+				putLangMapBucket (LanguageMap.names,
+								  newLangMapEntry (i, j, ptrn, ptrn));
+			else if (ptrn[0] == '*' && !hasGlobMetaChar (ptrn + 1))
+			{
+				entry = newLangMapEntry (i, j, ptrn, ptrn + 1);
+				ptrArrayAdd (LanguageMap.suffixes, entry);
+			}
+			else
+			{
+				entry = newLangMapEntry (i, j, ptrn, ptrn);
+				ptrArrayAdd (LanguageMap.globs, entry);
+			}
+		}
+
+		for (unsigned int j = 0; exts && j < stringListCount (exts); j++)
+		{
+			const char *ext = vStringValue (stringListItem (exts, j));
+			putLangMapBucket (LanguageMap.extensions,
+							  newLangMapEntry (i, j, ext, ext));
 		}
 	}
 
-	for (i = start_index  ;  i < LanguageCount  &&  result == LANG_IGNORE  ;  ++i)
+	LanguageMap.compiled = true;
+}
+
+static bool langMapEntryPrecedes (const struct langMapEntry *a,
+								  const struct langMapEntry *b)
+{
+	if (b == NULL)
+		return true;
+	if (a->lang != b->lang)
+		return a->lang < b->lang;
+	return a->order < b->order;
+}
+
+static bool isLangMapEntryUsable (const struct langMapEntry *entry, langType start_index)
+{
+	return entry->lang >= start_index && isLanguageEnabled (entry->lang);
+}
+
+static const struct langMapEntry *findLangMapBucket (hashTable *table, const char *key,
+													 langType start_index)
+{
+	ptrArray *bucket = hashTableGetItem (table, key);
+
+	for (unsigned int i = 0; bucket && i < ptrArrayCount (bucket); i++)
 	{
-		if (! isLanguageEnabled (i))
-			continue;
+		const struct langMapEntry *entry = ptrArrayItem (bucket, i);
+		if (isLangMapEntryUsable (entry, start_index))
+			return entry;
+	}
+	return NULL;
+}
 
-		parserObject *parser = LanguageTable + i;
-		stringList* const exts = parser->currentExtensions;
-		vString* tmp;
+static const struct langMapEntry *findLangMapPattern (const char *fileName, langType start_index)
+{
+	const struct langMapEntry *best;
+	size_t len = strlen (fileName);
+
+	best = findLangMapBucket (LanguageMap.names, fileName, start_index);
+
+	/* suffixes and globs are sorted by language and order. */
+	for (unsigned int i = 0; i < ptrArrayCount (LanguageMap.suffixes); i++)
+	{
+		const struct langMapEntry *entry = ptrArrayItem (LanguageMap.suffixes, i);
+		if (!langMapEntryPrecedes (entry, best))
+			break;
+		if (isLangMapEntryUsable (entry, start_index)
+			&& entry->length <= len
+			&& langMapStrcmp (fileName + len - entry->length, entry->pattern) == 0)
+		{
+			best = entry;
+			break;
+		}
+	}
 
-		if (exts != NULL && (tmp = stringListExtensionFinds (exts,
-								     fileExtension (baseName))))
+	for (unsigned int i = 0; i < ptrArrayCount (LanguageMap.globs); i++)
+	{
+		const struct langMapEntry *entry = ptrArrayItem (LanguageMap.globs, i);
+		if (!langMapEntryPrecedes (entry, best))
+			break;
+		if (isLangMapEntryUsable (entry, start_index)
+			&& fnmatch (entry->pattern, fileName, 0) == 0)
 		{
-			result = i;
-			*spec = vStringValue(tmp);
-			*specType = SPEC_EXTENSION;
-			goto found;
+			best = entry;
+			break;
 		}
 	}
+
+	return best;
+}
+
+static langType getPatternLanguageAndSpec (const char *const baseName, langType start_index,
+					   const char **const spec, enum specType *specType)
+{
+	langType result = LANG_IGNORE;
+	const struct langMapEntry *entry;
+
+	if (start_index == LANG_AUTO)
+	        start_index = 0;
+	else if (start_index == LANG_IGNORE || start_index >= (int) LanguageCount)
+		return result;
+
+	if (!LanguageMap.compiled)
+		compileLanguageMap ();
+
+	*spec = NULL;
+
+	const char *fileName = baseName;
+#if defined (_WIN32) || defined (CASE_INSENSITIVE_FILENAMES)
+	vString *tmp = vStringNewInit (baseName);
+# if defined (_WIN32)
+	vStringTranslate (tmp, PATH_SEPARATOR, OUTPUT_PATH_SEPARATOR);
+# endif
+# if defined (CASE_INSENSITIVE_FILENAMES)
+	vStringUpper (tmp);
+# endif
+	fileName = vStringValue (tmp);
+#endif
+
+	entry = findLangMapPattern (fileName, start_index);
+	if (entry)
+	{
+		result = entry->lang;
+		*spec = entry->spec;
+		*specType = SPEC_PATTERN;
+		goto found;
+	}
+
+	entry = findLangMapBucket (LanguageMap.extensions, fileExtension (baseName),
+							   start_index);
+	if (entry)
+	{
+		result = entry->lang;
+		*spec = entry->spec;
+		*specType = SPEC_EXTENSION;
+	}
 found:
+#if defined (_WIN32) || defined (CASE_INSENSITIVE_FILENAMES)
+	vStringDelete (tmp);
+#endif
 	return result;
 }
 
@@ -1100,12 +1349,109 @@ static vString* extractPHPMark(MIO* input)
 }
 
 
+/* The tasters and the line based selectors look only at the head and
+ * the tail of an input. Both are read once per input into a taste window
+ * and shared by them; they never rewind or seek the input itself.
+ *
+ * If the input is already in memory, the window points into its buffer.
+ * Otherwise the head and the tail are read with two small reads. The
+ * tail must be larger than 3000 bytes, the range Emacs looks at for
+ * a local variables list. */
+#define TASTE_WINDOW_HEAD_SIZE 4096
+#define TASTE_WINDOW_TAIL_SIZE 4096
+
+struct tasteWindow {
+	bool filled;
+	bool whole;			/* the head holds the whole input */
+	const unsigned char *head;
+	size_t headLength;
+	size_t headLinesLength;	/* the head up to the last newline */
+	const unsigned char *tail;
+	size_t tailLength;
+	unsigned char headBuffer [TASTE_WINDOW_HEAD_SIZE];
+	unsigned char tailBuffer [TASTE_WINDOW_TAIL_SIZE];
+};
+
 struct getLangCtx {
     const char *fileName;
     MIO        *input;
     bool     err;
+    struct tasteWindow *window;
 };
 
+static struct getLangCtx *CurrentGetLangCtx;
+
+static void fillTasteWindow (struct tasteWindow *window, MIO *input)
+{
+	size_t size;
+	unsigned char *data = mio_memory_get_data (input, &size);
+
+	if (data)
+	{
+		window->head = data;
+		window->headLength = (size < TASTE_WINDOW_HEAD_SIZE)? size: TASTE_WINDOW_HEAD_SIZE;
+		window->tailLength = (size < TASTE_WINDOW_TAIL_SIZE)? size: TASTE_WINDOW_TAIL_SIZE;
+		window->tail = data + size - window->tailLength;
+	}
+	else
+	{
+		long end;
+
+		mio_rewind (input);
+		window->head = window->headBuffer;
+		window->headLength = mio_read (input, window->headBuffer, 1, TASTE_WINDOW_HEAD_SIZE);
+
+		if (mio_seek (input, 0, SEEK_END) == 0 && (end = mio_tell (input)) >= 0)
+			size = (size_t)end;
+		else
+			size = window->headLength;
+
+		if (size <= window->headLength)
+		{
+			window->tailLength = (size < TASTE_WINDOW_TAIL_SIZE)? size: TASTE_WINDOW_TAIL_SIZE;
+			window->tail = window->head + size - window->tailLength;
+		}
+		else
+		{
+			size_t tailLength = (size < TASTE_WINDOW_TAIL_SIZE)? size: TASTE_WINDOW_TAIL_SIZE;
+			window->tail = window->tailBuffer;
+			if (mio_seek (input, (long)(size - tailLength), SEEK_SET) == 0)
+				window->tailLength = mio_read (input, window->tailBuffer, 1, tailLength);
+			else
+				window->tailLength = 0;
+		}
+		mio_rewind (input);
+	}
+
+	window->whole = (size <= window->headLength);
+	window->headLinesLength = window->headLength;
+	if (!window->whole)
+	{
+		while (window->headLinesLength > 0
+			   && window->head [window->headLinesLength - 1] != '\n')
+			window->headLinesLength--;
+	}
+	window->filled = true;
+}
+
+static struct tasteWindow *getTasteWindow (struct getLangCtx *glc)
+{
+	if (!glc->window->filled)
+		fillTasteWindow (glc->window, glc->input);
+	return glc->window;
+}
+
+extern const unsigned char *getGuessingInputHead (MIO *input, size_t *length, bool *whole)
+{
+	if (CurrentGetLangCtx == NULL || CurrentGetLangCtx->input != input)
+		return NULL;
+
+	struct tasteWindow *window = getTasteWindow (CurrentGetLangCtx);
+	*length = window->headLinesLength;
+	*whole = window->whole;
+	return window->head;
+}
+
 #define GLC_FOPEN_IF_NECESSARY0(_glc_, _label_) do {        \
     if (!(_glc_)->input) {                                  \
 	    (_glc_)->input = getMio((_glc_)->fileName, "rb", false);	\
@@ -1143,6 +1489,7 @@ struct getLangCtx {
 static const struct taster {
 	vString* (* taste) (MIO *);
 	const char     *msg;
+	bool            atEOF;	/* taste the tail of the window */
 } eager_tasters[] = {
 	{
 		.taste  = extractInterpreter,
@@ -1159,6 +1506,7 @@ static const struct taster {
 	{
 		.taste  = extractEmacsModeLanguageAtEOF,
 		.msg    = "emacs mode at the EOF",
+		.atEOF  = true,
 	},
 	{
 		.taste  = extractVimFileTypeAtBOF,
@@ -1167,6 +1515,7 @@ static const struct taster {
 	{
 		.taste  = extractVimFileTypeAtEOF,
 		.msg    = "vim modeline at the EOF",
+		.atEOF  = true,
 	},
 	{
 		.taste  = extractPHPMark,
@@ -1410,9 +1759,15 @@ tasteLanguage (struct getLangCtx *glc, const struct taster *const tasters, int n
     for (i = 0; i < n_tasters; ++i) {
         langType language;
         vString* spec;
+        struct tasteWindow *window = getTasteWindow (glc);
+        MIO *mio;
 
-        mio_rewind(glc->input);
-	spec = tasters[i].taste(glc->input);
+        if (tasters[i].atEOF)
+            mio = mio_new_memory ((unsigned char *)window->tail, window->tailLength, NULL, NULL);
+        else
+            mio = mio_new_memory ((unsigned char *)window->head, window->headLength, NULL, NULL);
+	spec = tasters[i].taste(mio);
+        mio_unref (mio);
 
         if (NULL != spec) {
             verbose ("	%s: %s\n", tasters[i].msg, vStringValue (spec));
@@ -1470,10 +1825,12 @@ getFileLanguageForRequestInternal (struct GetLanguageRequest *req)
     };
     langType fallback[N_HINTS];
     int i;
+    struct tasteWindow window = { .filled = false, };
     struct getLangCtx glc = {
         .fileName = fileName,
         .input    = (req->type == GLR_REUSE)? mio_ref (req->mio): NULL,
         .err      = false,
+        .window   = &window,
     };
     const char* const baseName = baseFilename (fileName);
     char *templateBaseName = NULL;
@@ -1483,6 +1840,7 @@ getFileLanguageForRequestInternal (struct GetLanguageRequest *req)
 	fallback [i] = LANG_IGNORE;
 
     verbose ("Get file language for %s\n", fileName);
+    CurrentGetLangCtx = &glc;
 
     verbose ("	pattern: %s\n", baseName);
     language = getPatternLanguage (baseName, &glc,
@@ -1529,6 +1887,7 @@ getFileLanguageForRequestInternal (struct GetLanguageRequest *req)
 
 
   cleanup:
+	CurrentGetLangCtx = NULL;
 	if (req->type == GLR_OPEN && glc.input)
 	{
 		req->mio = mio_ref (glc.input);
@@ -1567,7 +1926,12 @@ static langType getFileLanguageForRequest (struct GetLanguageRequest *req)
 	langType l = Option.language;
 
 	if (l == LANG_AUTO)
-		return getFileLanguageForRequestInternal(req);
+	{
+		beginTraceEvent ("guess-language", "file", req->fileName);
+		l = getFileLanguageForRequestInternal(req);
+		endTraceEvent ();
+		return l;
+	}
 	else if (! isLanguageEnabled (l))
 	{
 		error (FATAL,
@@ -1632,6 +1996,7 @@ extern void installLanguageMapDefault (const langType language)
 	parserObject* parser;
 	Assert (0 <= language  &&  language < (int) LanguageCount);
 	parser = LanguageTable + language;
+	invalidateLanguageMap ();
 	if (parser->currentPatterns != NULL)
 		stringListDelete (parser->currentPatterns);
 	if (parser->currentExtensions != NULL)
@@ -1706,6 +2071,7 @@ extern void installLanguageAliasesDefaults (void)
 extern void clearLanguageMap (const langType language)
 {
 	Assert (0 <= language  &&  language < (int) LanguageCount);
+	invalidateLanguageMap ();
 	stringListClear ((LanguageTable + language)->currentPatterns);
 	stringListClear ((LanguageTable + language)->currentExtensions);
 }
@@ -1726,6 +2092,7 @@ static bool removeLanguagePatternMap1(const langType language, const char *const
 
 	if (ptrn != NULL && stringListDeleteItemExtension (ptrn, pattern))
 	{
+		invalidateLanguageMap ();
 		verbose (" (removed from %s)", getLanguageName (language));
 		result = true;
 	}
@@ -1757,6 +2124,7 @@ extern void addLanguagePatternMap (const langType language, const char* ptrn,
 	if (exclusiveInAllLanguages)
 		removeLanguagePatternMap (LANG_AUTO, ptrn);
 	stringListAdd (parser->currentPatterns, str);
+	invalidateLanguageMap ();
 }
 
 static bool removeLanguageExtensionMap1 (const langType language, const char *const extension)
@@ -1766,6 +2134,7 @@ static bool removeLanguageExtensionMap1 (const langType language, const char *co
 
 	if (exts != NULL  &&  stringListDeleteItemExtension (exts, extension))
 	{
+		invalidateLanguageMap ();
 		verbose (" (removed from %s)", getLanguageName (language));
 		result = true;
 	}
@@ -1796,6 +2165,7 @@ extern void addLanguageExtensionMap (
 	if (exclusiveInAllLanguages)
 		removeLanguageExtensionMap (LANG_AUTO, extension);
 	stringListAdd ((LanguageTable + language)->currentExtensions, str);
+	invalidateLanguageMap ();
 }
 
 extern void addLanguageAlias (const langType language, const char* alias)
@@ -2115,6 +2485,8 @@ extern void freeParserResources (void)
 		eFree (parser->def);
 		parser->def = NULL;
 	}
+	freeLanguageMapIndex ();
+
 	if (LanguageTable != NULL)
 		eFree (LanguageTable);
 	LanguageTable = NULL;
@@ -2454,6 +2826,7 @@ extern void processLanguageDefineOption (
 
 	LanguageTable [def->id].currentPatterns = stringListNew ();
 	LanguageTable [def->id].currentExtensions = stringListNew ();
+	invalidateLanguageMap ();
 	LanguageTable [def->id].pretendingAsLanguage = LANG_IGNORE;
 	LanguageTable [def->id].pretendedAsLanguage = LANG_IGNORE;
 
@@ -4084,6 +4457,7 @@ static rescanReason createTagsForFile (const langType language,
 
 	Assert (lang->parser || lang->parser2);
 
+	beginTraceEvent ((passCount > 1)? "rescan": "pass", "language", lang->name);
 	notifyInputStart ();
 
 	if (lang->parser != NULL)
@@ -4092,6 +4466,7 @@ static rescanReason createTagsForFile (const langType language,
 		rescan = lang->parser2 (passCount);
 
 	notifyInputEnd ();
+	endTraceEvent ();
 
 	return rescan;
 }
@@ -4161,7 +4536,7 @@ static subparser* teardownLanguageSubparsersInUse (const langType language)
 
 static void	initializeParserStats (parserObject *parser)
 {
-	if (Option.printTotals > 1 && parser->used == 0 && parser->def->initStats)
+	if (Option.printTotals == TOTALS_EXTRA && parser->used == 0 && parser->def->initStats)
 		parser->def->initStats (parser->def->id);
 	parser->used = 1;
 }
@@ -4198,6 +4573,7 @@ static bool createTagsWithFallback1 (const langType language,
 	initializeParser (language);
 	parser = &(LanguageTable [language]);
 
+	beginTraceEvent ("parse", "language", parser->def->name);
 	setupLanguageSubparsersInUse (language);
 
 	corkFlags = parserCorkFlags (parser->def);
@@ -4234,6 +4610,7 @@ static bool createTagsWithFallback1 (const langType language,
 			writerRescanFailed (numTags);
 			tagFileResized = true;
 			breakPromisesAfter(lastPromise);
+			countStatsRescan (language);
 		}
 		else if (whyRescan == RESCAN_APPEND)
 		{
@@ -4257,6 +4634,7 @@ static bool createTagsWithFallback1 (const langType language,
 		if (exclusive_subparser && s)
 			*exclusive_subparser = getSubparserLanguage (s);
 	}
+	endTraceEvent ();
 
 	return tagFileResized;
 }
@@ -4279,6 +4657,7 @@ extern bool runParserInNarrowedInputStream (const langType language,
 			 startLine, startCharOffset, sourceLineOffset,
 			 endLine, endCharOffset);
 
+	beginTraceEvent ("guest", "language", getLanguageName (language));
 	pushNarrowedInputStream (
 				 doesParserRequireMemoryStream (language),
 				 startLine, startCharOffset,
@@ -4287,6 +4666,7 @@ extern bool runParserInNarrowedInputStream (const langType language,
 				 promise);
 	tagFileResized = createTagsWithFallback1 (language, NULL);
 	popNarrowedInputStream  ();
+	endTraceEvent ();
 	return tagFileResized;
 
 }
@@ -4309,7 +4689,9 @@ static bool createTagsWithFallback (
 
 	tagFileResized = createTagsWithFallback1 (language,
 											  &exclusive_subparser);
+	beginTraceEvent ("promises", NULL, NULL);
 	tagFileResized = forcePromises()? true: tagFileResized;
+	endTraceEvent ();
 
 	pushLanguage ((exclusive_subparser == LANG_IGNORE)
 				  ? language
@@ -4391,6 +4773,7 @@ extern void freeEncodingResources (void)
 		eFree (Option.inputEncoding);
 	if (Option.outputEncoding)
 		eFree (Option.outputEncoding);
+	freeConverter ();
 }
 
 extern const char *getLanguageEncoding (const langType language)
@@ -4463,6 +4846,8 @@ static bool parseMio (const char *const fileName, langType language, MIO* mio, t
 	bool tagFileResized = false;
 	bool failureInOpenning = false;
 
+	beginStatsFile (fileName, language);
+	beginTraceEvent ("file", "file", fileName);
 	setupWriter (clientData);
 
 	setupAnon ();
@@ -4476,9 +4861,13 @@ static bool parseMio (const char *const fileName, langType language, MIO* mio, t
 	teardownAnon ();
 
 	if (useSourceFileTagPath && (!failureInOpenning))
-		return teardownWriter (getSourceFileTagPath())? true: tagFileResized;
+		tagFileResized = teardownWriter (getSourceFileTagPath())? true: tagFileResized;
 	else
-		return teardownWriter(fileName);
+		tagFileResized = teardownWriter(fileName);
+
+	endTraceEvent ();
+	endStatsFile ();
+	return tagFileResized;
 }
 
 extern bool parseFileWithMio (const char *const fileName, MIO *mio,
@@ -4516,7 +4905,12 @@ extern bool parseFileWithMio (const char *const fileName, MIO *mio,
 		/* TODO: checkUTF8BOM can be used to update the encodings. */
 		openConverter (getLanguageEncoding (language), Option.outputEncoding);
 #endif
-		tagFileResized = parseMio (fileName, language, req.mio, req.mtime, true, clientData);
+		dedupInput *dedup = NULL;
+		if (!dedupStartInput (fileName, language, req.mio, &dedup))
+		{
+			tagFileResized = parseMio (fileName, language, req.mio, req.mtime, true, clientData);
+			dedupEndInput (dedup);
+		}
 		if (Option.filter && ! Option.interactive)
 			closeTagFile (tagFileResized);
 		addTotals (1, 0L, 0L);
@@ -5111,6 +5505,7 @@ extern unsigned int getLanguageVersionAge (const langType language)
 *   Anonymous name generator
 */
 static ptrArray *parsersUsedInCurrentInput;
+static unsigned long anonymousNames;
 
 static void setupAnon (void)
 {
@@ -5157,6 +5552,7 @@ extern void anonGenerateFull (vString *buffer, const char *prefix, langType lang
 	Assert(lang != LANG_IGNORE);
 	parserObject* parser = LanguageTable + ((lang == LANG_AUTO)? getInputLanguage (): lang);
 	parser -> anonymousIdentiferId ++;
+	anonymousNames++;
 
 	char szNum[32];
 	char buf [9];
@@ -5169,6 +5565,11 @@ extern void anonGenerateFull (vString *buffer, const char *prefix, langType lang
 	vStringCatS(buffer,szNum);
 }
 
+extern unsigned long countAnonymousNames (void)
+{
+	return anonymousNames;
+}
+
 extern vString *anonGenerateNewFull (const char *prefix, langType lang, int kind)
 {
 	vString *buffer = vStringNew ();
@@ -5368,6 +5769,29 @@ extern void printLanguageMultitableStatistics (langType language)
 	printMultitableStatistics (parser->lregexControlBlock);
 }
 
+extern void printLanguageRegexProfile (FILE *fp)
+{
+	struct colprintTable *table = regexProfileColprintTableNew ();
+
+	/* Patterns never tried are not listed. */
+	for (unsigned int i = 0; i < LanguageCount; i++)
+		regexProfileColprintAddLines (table, LanguageTable [i].lregexControlBlock);
+
+	regexProfileColprintTablePrint (table, true, false, fp);
+	colprintTableDelete (table);
+}
+
+extern void compileLanguageRegexPatterns (langType language)
+{
+	if (language == LANG_AUTO)
+	{
+		for (unsigned int i = 0; i < LanguageCount; i++)
+			compileRegexPatterns (LanguageTable [i].lregexControlBlock);
+	}
+	else
+		compileRegexPatterns (LanguageTable [language].lregexControlBlock);
+}
+
 extern void addLanguageRegexTable (const langType language, const char *name)
 {
 	parserObject* const parser = LanguageTable + language;
@@ -131,6 +131,15 @@ extern void printLanguageSubparsers (const langType language,
 extern void printLangdefFlags (bool withListHeader, bool machinable, FILE *fp);
 extern void printKinddefFlags (bool withListHeader, bool machinable, FILE *fp);
 extern bool doesParserRequireMemoryStream (const langType language);
+
+/* Anonymous names are made from the input file name. */
+extern unsigned long countAnonymousNames (void);
+
+/* The head of INPUT read while guessing its language; line based
+ * selectors use it instead of reading INPUT again. NULL is returned
+ * if INPUT is not the input being guessed. *LENGTH is set to the
+ * length up to the last newline in the head. */
+extern const unsigned char *getGuessingInputHead (MIO *input, size_t *length, bool *whole);
 extern bool parseFile (const char *const fileName);
 extern bool parseFileWithMio (const char *const fileName, MIO *mio, void *clientData);
 extern bool parseRawBuffer(const char *fileName, unsigned char *buffer,
@@ -189,6 +198,11 @@ extern bool makeParserVersionPseudoTags (const langType language,
 										 const ptagDesc *pdesc);
 
 extern void printLanguageMultitableStatistics (langType language);
+extern void printLanguageRegexProfile (FILE *fp);
+
+/* LANGUAGE can be LANG_AUTO for all the languages. */
+extern void compileLanguageRegexPatterns (langType language);
+
 extern void printParserStatisticsIfUsed (langType lang);
 
 /* For keeping the API compatibility with Geany, we use a macro here. */
@@ -88,10 +88,9 @@ typedef struct sNestedInputStreamInfo {
 typedef struct sInputFile {
 	vString    *path;          /* path of input file (if any) */
 	vString    *line;          /* last line read from file */
-	const unsigned char* currentLine;  /* current line being worked on */
+	inputCursor cursor;        /* current line being worked on */
 	MIO        *mio;           /* MIO stream used for reading the file */
 	compoundPos    filePosition;  /* file position of current line */
-	unsigned int ungetchIdx;
 	int         ungetchBuf[8]; /* characters that were ungotten */
 
 	bool bomFound;
@@ -115,6 +114,12 @@ typedef struct sInputFile {
 	vString *allLines;
 	int thinDepth;
 	time_t mtime;
+#ifdef HAVE_ICONV
+	/* With --transcode-input, the offset in the original input of
+	   each line of the transcoded input */
+	long *transcodedLineOffsets;
+	unsigned int transcodedLineCount;
+#endif
 } inputFile;
 
 static inputLangInfo inputLang;
@@ -138,6 +143,12 @@ static inputFile File;  /* static read through functions */
 static inputFile BackupFile;	/* File is copied here when a nested parser is pushed */
 static compoundPos StartOfLine;  /* holds deferred position of start of line */
 
+/* The inline functions in read.h touch the cursor through this pointer.
+ * As File is copied to BackupFile as a whole when a narrowed input stream
+ * is pushed, the cursor is saved and restored together with the rest of
+ * the input state. */
+inputCursor *const InputCursor = &File.cursor;
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -152,8 +163,8 @@ extern int getInputLineOffset (void)
 	unsigned char *base = (unsigned char *) vStringValue (File.line);
 	int ret;
 
-	if (File.currentLine)
-		ret = File.currentLine - base - File.ungetchIdx;
+	if (File.cursor.currentLine)
+		ret = File.cursor.currentLine - base - File.cursor.ungetchIdx;
 	else if (File.input.lineNumber)
 	{
 		/* When EOF is saw, currentLine is set to NULL.
@@ -220,6 +231,13 @@ extern langType getInputLanguage (void)
 	return langStackTop (&inputLang.stack);
 }
 
+extern langType getInputLanguageIfAny (void)
+{
+	if (inputLang.stack.count == 0)
+		return LANG_IGNORE;
+	return langStackTop (&inputLang.stack);
+}
+
 extern const char *getInputLanguageName (void)
 {
 	return getLanguageName (getInputLanguage());
@@ -422,6 +440,22 @@ static void setOwnerDirectoryOfInputFile (const char *const fileName)
 	}
 }
 
+/*  Return the path of FILENAME as written to the tag file.
+ */
+extern vString *newInputFileTagPath (const char *const fileName)
+{
+	if (  Option.tagRelative == TREL_ALWAYS )
+		return vStringNewOwn (relativeFilename (fileName,
+												getTagFileDirectory ()));
+	else if ( Option.tagRelative == TREL_NEVER )
+		return vStringNewOwn (absoluteFilename (fileName));
+	else if ( Option.tagRelative == TREL_NO || isAbsolutePath (fileName) )
+		return vStringNewInit (fileName);
+	else
+		return vStringNewOwn (relativeFilename (fileName,
+												getTagFileDirectory ()));
+}
+
 static void setInputFileParametersCommon (inputFileInfo *finfo, vString *const fileName,
 					  const langType language,
 					  stringList *holder)
@@ -438,21 +472,7 @@ static void setInputFileParametersCommon (inputFileInfo *finfo, vString *const f
 			vStringDelete (finfo->tagPath);
 	}
 
-	if (0)
-		;
-	else if (  Option.tagRelative == TREL_ALWAYS )
-		finfo->tagPath =
-			vStringNewOwn (relativeFilename (vStringValue (fileName),
-							 getTagFileDirectory ()));
-	else if ( Option.tagRelative == TREL_NEVER )
-		finfo->tagPath =
-			vStringNewOwn (absoluteFilename (vStringValue (fileName)));
-	else if ( Option.tagRelative == TREL_NO || isAbsolutePath (vStringValue (fileName)) )
-		finfo->tagPath = vStringNewCopy (fileName);
-	else
-		finfo->tagPath =
-			vStringNewOwn (relativeFilename (vStringValue (fileName),
-							 getTagFileDirectory ()));
+	finfo->tagPath = newInputFileTagPath (vStringValue (fileName));
 
 	finfo->isHeader = isIncludeFile (vStringValue (fileName));
 }
@@ -710,6 +730,48 @@ static void rewindInputFile (inputFile *f)
 /*  This function opens an input file, and resets the line counter.  If it
  *  fails, it will display an error message and leave the File.mio set to NULL.
  */
+#ifdef HAVE_ICONV
+static void freeTranscodedLineOffsets (inputFile *f)
+{
+	if (f->transcodedLineOffsets)
+	{
+		eFree (f->transcodedLineOffsets);
+		f->transcodedLineOffsets = NULL;
+	}
+	f->transcodedLineCount = 0;
+}
+
+/*  Converts the whole input to the output encoding before parsing it,
+ *  for --transcode-input. The parser and the pattern lines read later
+ *  see the converted input; the line offsets are kept for the writers
+ *  recording the offsets in the original input.
+ */
+static void transcodeInputFile (inputFile *f)
+{
+	const unsigned char *data;
+	size_t size, converted_size;
+	char *converted;
+
+	data = mio_memory_get_data (f->mio, &size);
+	if (data == NULL)
+		return;
+
+	converted = convertLines ((const char *)data, size, &converted_size,
+							  &f->transcodedLineOffsets, &f->transcodedLineCount);
+	if (converted == NULL)
+		return;
+
+	mio_unref (f->mio);
+	f->mio = mio_new_memory ((unsigned char *)converted, converted_size,
+							 eRealloc, eFree);
+}
+
+static bool isInputTranscoded (void)
+{
+	return File.transcodedLineOffsets != NULL;
+}
+#endif
+
 extern bool openInputFile (const char *const fileName, const langType language,
 			      MIO *mio, time_t mtime)
 {
@@ -738,6 +800,11 @@ extern bool openInputFile (const char *const fileName, const langType language,
 	stringListClear (File.sourceTagPathHolder);
 
 	memStreamRequired = doesParserRequireMemoryStream (language);
+#ifdef HAVE_ICONV
+	freeTranscodedLineOffsets (&File);
+	if (Option.transcodeInput && isConverting ())
+		memStreamRequired = true;
+#endif
 
 	if (mio)
 	{
@@ -759,16 +826,21 @@ extern bool openInputFile (const char *const fileName, const langType language,
 		if (File.mio == mio)
 			File.mtime = mtime;
 
+#ifdef HAVE_ICONV
+		if (Option.transcodeInput && isConverting ())
+			transcodeInputFile (&File);
+#endif
+
 		File.bomFound = checkUTF8BOM (File.mio, true);
 
 		setOwnerDirectoryOfInputFile (fileName);
 		mio_getpos (File.mio, &StartOfLine.pos);
 		mio_getpos (File.mio, &File.filePosition.pos);
 		File.filePosition.offset = StartOfLine.offset = mio_tell (File.mio);
-		File.currentLine  = NULL;
+		File.cursor.currentLine  = NULL;
 
 		File.line = vStringNewOrClear (File.line);
-		File.ungetchIdx = 0;
+		File.cursor.ungetchIdx = 0;
 
 		setInputFileParameters  (vStringNewInit (fileName), language);
 		File.input.lineNumberOrigin = 0L;
@@ -803,11 +875,11 @@ extern void resetInputFile (const langType language, bool resetLineFposMap_)
 	mio_getpos (File.mio, &StartOfLine.pos);
 	mio_getpos (File.mio, &File.filePosition.pos);
 	File.filePosition.offset = StartOfLine.offset = mio_tell (File.mio);
-	File.currentLine  = NULL;
+	File.cursor.currentLine  = NULL;
 
 	Assert (File.line);
 	vStringClear (File.line);
-	File.ungetchIdx = 0;
+	File.cursor.ungetchIdx = 0;
 
 	if (hasLanguageMultilineRegexPatterns (language)
 		|| hasLanguagePostRunRegexPatterns (language))
@@ -834,11 +906,15 @@ extern void closeInputFile (void)
 		if (Option.printTotals)
 		{
 			fileStatus *status = eStat (vStringValue (File.input.name));
-			addTotals (0, File.input.lineNumber - 1L, status->size);
+			addTotals (0, File.input.lineNumber > 0? File.input.lineNumber - 1L: 0L,
+					   status->size);
 		}
 		mio_unref (File.mio);
 		File.mio = NULL;
 		freeLineFposMap (&File.lineFposMap);
+#ifdef HAVE_ICONV
+		freeTranscodedLineOffsets (&File);
+#endif
 	}
 }
 
@@ -867,10 +943,10 @@ extern void ungetcToInputFile (int c)
 {
 	const size_t len = ARRAY_SIZE (File.ungetchBuf);
 
-	Assert (File.ungetchIdx < len);
+	Assert (File.cursor.ungetchIdx < len);
 	/* we cannot rely on the assertion that might be disabled in non-debug mode */
-	if (File.ungetchIdx < len)
-		File.ungetchBuf[File.ungetchIdx++] = c;
+	if (File.cursor.ungetchIdx < len)
+		File.ungetchBuf[File.cursor.ungetchIdx++] = c;
 }
 
 typedef enum eEolType {
@@ -952,7 +1028,12 @@ static vString *iFileGetLine (bool chop_newline)
 
 		bool chopped = vStringStripNewline (File.line);
 
+		statsStamp stamp;
+		const char *allocationTag = setAllocationTag ("regex");
+		startStatsTimer (STATS_TIMER_REGEX, &stamp);
 		matchLanguageRegex (lang, File.line, false);
+		stopStatsTimer (STATS_TIMER_REGEX, &stamp);
+		setAllocationTag (allocationTag);
 
 		if (chopped && !chop_newline)
 			vStringPutNewlinAgainUnsafe (File.line);
@@ -963,6 +1044,10 @@ static vString *iFileGetLine (bool chop_newline)
 	{
 		if (File.allLines)
 		{
+			statsStamp stamp;
+			const char *allocationTag = setAllocationTag ("regex");
+			startStatsTimer (STATS_TIMER_REGEX, &stamp);
+
 			matchLanguageMultilineRegex (lang, File.allLines);
 			matchLanguageMultitableRegex (lang, File.allLines);
 
@@ -995,6 +1080,8 @@ static vString *iFileGetLine (bool chop_newline)
 				File.input.lineNumber = input_ln;
 				File.source.lineNumber = source_ln;
 			}
+			stopStatsTimer (STATS_TIMER_REGEX, &stamp);
+			setAllocationTag (allocationTag);
 
 			/* To limit the execution of multiline/multitable parser(s) only
 			   ONCE, clear File.allLines field. */
@@ -1015,25 +1102,25 @@ extern int getcFromInputFile (void)
 	 *  other processing on it, though, because we already did that the
 	 *  first time it was read through getcFromInputFile ().
 	 */
-	if (File.ungetchIdx > 0)
+	if (File.cursor.ungetchIdx > 0)
 	{
-		c = File.ungetchBuf[--File.ungetchIdx];
+		c = File.ungetchBuf[--File.cursor.ungetchIdx];
 		return c;  /* return here to avoid re-calling debugPutc () */
 	}
 	do
 	{
-		if (File.currentLine != NULL)
+		if (File.cursor.currentLine != NULL)
 		{
-			c = *File.currentLine++;
+			c = *File.cursor.currentLine++;
 			if (c == '\0')
-				File.currentLine = NULL;
+				File.cursor.currentLine = NULL;
 		}
 		else
 		{
 			vString* const line = iFileGetLine (false);
 			if (line != NULL)
-				File.currentLine = (unsigned char*) vStringValue (line);
-			if (File.currentLine == NULL)
+				File.cursor.currentLine = (unsigned char*) vStringValue (line);
+			if (File.cursor.currentLine == NULL)
 				c = EOF;
 			else
 				c = '\0';
@@ -1043,15 +1130,23 @@ extern int getcFromInputFile (void)
 	return c;
 }
 
+extern int peekcFromInputFileSlow (void)
+{
+	int c = getcFromInputFile ();
+	if (c != EOF)
+		ungetcToInputFile (c);
+	return c;
+}
+
 /* returns the nth previous character (0 meaning current), or def if nth cannot
  * be accessed.  Note that this can't access previous line data. */
 extern int getNthPrevCFromInputFile (unsigned int nth, int def)
 {
 	const unsigned char *base = (unsigned char *) vStringValue (File.line);
-	const unsigned int offset = File.ungetchIdx + 1 + nth;
+	const unsigned int offset = File.cursor.ungetchIdx + 1 + nth;
 
-	if (File.currentLine != NULL && File.currentLine >= base + offset)
-		return (int) *(File.currentLine - offset);
+	if (File.cursor.currentLine != NULL && File.cursor.currentLine >= base + offset)
+		return (int) *(File.cursor.currentLine - offset);
 	else
 		return def;
 }
@@ -1059,8 +1154,39 @@ extern int getNthPrevCFromInputFile (unsigned int nth, int def)
 extern int skipToCharacterInInputFile (int c)
 {
 	int d;
+
+	if (c == '\0')
+	{
+		/* getcFromInputFile () never returns '\0'. */
+		do
+			d = getcFromInputFile ();
+		while (d != EOF);
+		return d;
+	}
+
+	while (File.cursor.ungetchIdx > 0)
+	{
+		d = getcFromInputFile ();
+		if (d == c)
+			return d;
+	}
+
 	do
 	{
+		if (File.cursor.currentLine != NULL)
+		{
+			/* The line is terminated with '\0'. getcFromInputFile () ignores
+			 * the rest of the line after a '\0' in the middle of the line.
+			 * strchr () stops at the same place. */
+			const unsigned char *p = (const unsigned char *)
+				strchr ((const char *)File.cursor.currentLine, c);
+			if (p)
+			{
+				File.cursor.currentLine = p + 1;
+				return c;
+			}
+			File.cursor.currentLine = NULL;
+		}
 		d = getcFromInputFile ();
 	} while (d != EOF && d != c);
 	return d;
@@ -1122,21 +1248,95 @@ extern char *readLineRaw (vString *const vLine, MIO *const mio)
 	return vStringLength (vLine) > 0 ? vStringValue (vLine) : NULL;
 }
 
+/*  Copy the line starting at OFFSET in the memory stream to VLINE
+ *  in the same form as readLine () does.
+ */
+static void readLineFromMemory (vString *const vLine,
+								const unsigned char *data, size_t size,
+								size_t offset)
+{
+	const unsigned char *start = data + offset;
+	const unsigned char *nl = memchr (start, '\n', size - offset);
+	size_t len = nl? (size_t)(nl - start) + 1: size - offset;
+
+	vStringNCopyS (vLine, (const char *)start, len);
+	len = vStringLength (vLine);
+	if (len > 1
+		&& vStringChar (vLine, len - 1) == '\n'
+		&& vStringChar (vLine, len - 2) == '\r')
+	{
+		vStringChar (vLine, len - 2) = '\n';
+		vStringChop (vLine);
+	}
+}
+
+#ifdef HAVE_ICONV
+/*  The offsets in the transcoded input are meaningless to the tools
+ *  reading the original input.
+ */
+static void mapTranscodedSeekValue (unsigned long lineNumber,
+									long *const pSeekValue)
+{
+	if (pSeekValue != NULL
+		&& lineNumber > 0 && lineNumber <= File.transcodedLineCount)
+		*pSeekValue = File.transcodedLineOffsets [lineNumber - 1];
+}
+#endif
+
 /*  Places into the line buffer the contents of the line referenced by
- *  "location".
+ *  "location". "lineNumber" is the line number for "location"; if the
+ *  input is a memory stream and the line-fpos map has an entry for the
+ *  line at "location", the line is taken from the memory buffer
+ *  directly instead of seeking the stream.
  */
 extern char *readLineFromBypass (
-		vString *const vLine, MIOPos location, long *const pSeekValue)
+		vString *const vLine, unsigned long lineNumber, MIOPos location,
+		long *const pSeekValue)
 {
 	MIOPos orignalPosition;
 	char *result;
+	const unsigned char *data;
+	size_t size;
+
+	if (BackupFile.mio == NULL
+		&& lineNumber > 0 && lineNumber <= File.lineFposMap.count
+		&& (memcmp (&File.lineFposMap.pos[lineNumber - 1].pos, &location,
+					sizeof (location)) == 0)
+		&& (data = mio_memory_get_data (File.mio, &size)) != NULL)
+	{
+		long offset = File.lineFposMap.pos[lineNumber - 1].offset;
+
+		if (offset >= 0 && (size_t)offset <= size)
+		{
+			if (pSeekValue != NULL)
+				*pSeekValue = offset;
+			readLineFromMemory (vLine, data, size, (size_t)offset);
+#ifdef HAVE_ICONV
+			if (isInputTranscoded ())
+				mapTranscodedSeekValue (lineNumber, pSeekValue);
+			else if (isConverting ())
+				convertString (vLine);
+#endif
+			return vStringLength (vLine) > 0 ? vStringValue (vLine) : NULL;
+		}
+	}
 
 	mio_getpos (File.mio, &orignalPosition);
 	mio_setpos (File.mio, &location);
 	mio_clearerr (File.mio);
 	if (pSeekValue != NULL)
 		*pSeekValue = mio_tell (File.mio);
-	result = readLineRaw (vLine, File.mio);
+#ifdef HAVE_ICONV
+	if (isInputTranscoded ())
+	{
+		readLine (vLine, File.mio);
+		result = vStringLength (vLine) > 0 ? vStringValue (vLine) : NULL;
+		if (BackupFile.mio == NULL)
+			mapTranscodedSeekValue (lineNumber, pSeekValue);
+	}
+	else
+#endif
+		result = readLineRaw (vLine, File.mio);
 	mio_setpos (File.mio, &orignalPosition);
 	/* If the file is empty, we can't get the line
 	   for location 0. readLineFromBypass doesn't know
@@ -1261,6 +1461,10 @@ extern void   popNarrowedInputStream  (void)
 	mio_unref (File.mio);
 	File = BackupFile;
 	memset (&BackupFile, 0, sizeof (BackupFile));
+
+	/* Patterns cached while the narrowed stream was active are
+	 * keyed by file positions in the narrowed stream. */
+	invalidatePatternCache();
 }
 
 extern void pushLanguage (const langType language)
@@ -1309,8 +1513,17 @@ static void     langStackPush (langStack *langStack, langType type)
 	if (langStack->size == 0)
 		langStackInit (langStack);
 	else if (langStack->count == langStack->size)
-		langStack->languages = xRealloc (langStack->languages,
-						 ++ langStack->size, langType);
+	{
+		/* The allocation hook of --totals=json reads the stack via
+		 * getInputLanguageIfAny(); don't let it see the block released
+		 * by realloc(). */
+		langType *languages = xMalloc (langStack->size + 1, langType);
+		memcpy (languages, langStack->languages, sizeof (langType) * langStack->size);
+		langType *old = langStack->languages;
+		langStack->languages = languages;
+		langStack->size++;
+		eFree (old);
+	}
 	langStack->languages [ langStack->count ++ ] = type;
 }
 
@@ -18,6 +18,7 @@
 #include <ctype.h>
 
 #include "types.h"
+#include "inline.h"
 #include "vstring.h"
 #include "mio.h"
 
@@ -29,6 +30,15 @@
 *   DATA DECLARATIONS
 */
 
+/* The state shared between getcFromInputFile () and the inlined
+ * cursor functions below. Parsers must not touch the fields directly. */
+typedef struct sInputCursor {
+	const unsigned char *currentLine;
+	unsigned int ungetchIdx;
+} inputCursor;
+
+extern inputCursor *const InputCursor;
+
 /*
 *   FUNCTION PROTOTYPES
 */
@@ -58,6 +68,69 @@ extern const unsigned char *readLineFromInputFileWithLength (size_t *length);
 
 extern unsigned long getSourceLineNumber (void);
 
+/* Cursor: inlined variants of getcFromInputFile () and friends for
+ * character-level parsers. Inside a line they are pointer bumps over
+ * the input buffer; the out-of-line functions run only at the end of a
+ * line (where the line number, the line-fpos map and per-line regex
+ * matching are updated) or when ungotten characters are pending.
+ * They can be mixed freely with getcFromInputFile () and
+ * ungetcToInputFile (), so a parser can be migrated a piece at a time.
+ * For skipping to a character, skipToCharacterInInputFile () already
+ * scans the buffered line with strchr (). */
+extern int peekcFromInputFileSlow (void);
+
+CTAGS_INLINE int cursorGetc (void)
+{
+	const unsigned char *p = InputCursor->currentLine;
+
+	if (InputCursor->ungetchIdx == 0 && p != NULL && *p != '\0')
+	{
+		InputCursor->currentLine = p + 1;
+		return *p;
+	}
+	return getcFromInputFile ();
+}
+
+CTAGS_INLINE int cursorPeekc (void)
+{
+	const unsigned char *p = InputCursor->currentLine;
+
+	if (InputCursor->ungetchIdx == 0 && p != NULL && *p != '\0')
+		return *p;
+	return peekcFromInputFileSlow ();
+}
+
+/* Consume the character returned by the last cursorPeekc (). */
+CTAGS_INLINE void cursorAdvance (void)
+{
+	cursorGetc ();
+}
+
+/* Skip characters satisfying PRED. Return the first character not
+ * satisfying it without consuming the character. */
+CTAGS_INLINE int cursorSkipWhile (bool (* pred) (int c))
+{
+	int c;
+
+	for (;;)
+	{
+		const unsigned char *p = InputCursor->currentLine;
+		if (InputCursor->ungetchIdx == 0 && p != NULL)
+		{
+			while (*p != '\0' && pred (*p))
+				p++;
+			InputCursor->currentLine = p;
+			if (*p != '\0')
+				return *p;
+		}
+
+		c = peekcFromInputFileSlow ();
+		if (c == EOF || !pred (c))
+			return c;
+		getcFromInputFile ();
+	}
+}
+
 /* Raw: reading from given a parameter, mio */
 extern char *readLineRaw (vString *const vLine, MIO *const mio);
 
@@ -32,7 +32,11 @@ enum nestedInputBoundaryFlag {
 */
 
 extern const char *getInputLanguageName (void);
+/* Same as getInputLanguage() but returns LANG_IGNORE if no input
+ * file is open. */
+extern langType getInputLanguageIfAny (void);
 extern const char *getInputFileTagPath (void);
+extern vString *newInputFileTagPath (const char *const fileName);
 
 extern long getInputFileOffsetForLine (unsigned int line);
 
@@ -67,7 +71,8 @@ extern langType getSourceLanguage (void);
 extern time_t getInputFileMtime (void);
 
 /* Bypass: reading from fp in inputFile WITHOUT updating fields in input fields */
-extern char *readLineFromBypass (vString *const vLine, MIOPos location, long *const pSeekValue);
+extern char *readLineFromBypass (vString *const vLine, unsigned long lineNumber,
+								  MIOPos location, long *const pSeekValue);
 extern void   pushNarrowedInputStream (
 				       bool useMemoryStreamInput,
 				       unsigned long startLine, long startCharOffset,
@@ -0,0 +1,277 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains the read-ahead of input files going ahead of the
+*   parsers in a thread.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "readahead_p.h"
+
+#ifdef HAVE_READ_AHEAD
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "options_p.h"
+#include "routines.h"
+
+/*
+*   MACROS
+*/
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/* Like the directory walker, the helper thread must not call eMalloc()
+ * and friends nor error(). */
+struct sReadAhead {
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t changed;
+
+	/* The list of names: either of them */
+	char *const *argv;
+	FILE *fp;
+
+	unsigned int depth;
+	size_t budget;
+
+	unsigned long produced;	/* names the helper went through */
+	unsigned long consumed;	/* names the parsers took */
+	size_t bytes;			/* bytes hinted for the names not taken yet */
+	size_t *lengths;		/* bytes hinted for each name, in a ring of DEPTH */
+
+	bool stop;
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+extern void readAheadFileAt (int dirfd, const char *const name, size_t length)
+{
+	int fd = openat (dirfd, name, O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+		return;
+	posix_fadvise (fd, 0, (off_t) length, POSIX_FADV_WILLNEED);
+	close (fd);
+}
+
+/* Runs in the helper thread. Returns NULL at the end of the list. */
+static const char *nextName (readAhead *ra, char **line, size_t *size)
+{
+	if (ra->argv)
+		return *ra->argv? *ra->argv++: NULL;
+
+	ssize_t len = getline (line, size, ra->fp);
+	if (len < 0)
+		return NULL;
+
+	while (len > 0 && ((*line) [len - 1] == '\n' || (*line) [len - 1] == '\r'
+					   || (*line) [len - 1] == ' ' || (*line) [len - 1] == '\t'))
+		(*line) [--len] = '\0';
+	return *line;
+}
+
+static bool isWindowFull (readAhead *ra, size_t length)
+{
+	return (ra->produced - ra->consumed >= ra->depth
+			|| (ra->bytes > 0 && ra->bytes + length > ra->budget));
+}
+
+static void *readAheadMain (void *data)
+{
+	readAhead *ra = data;
+	char *line = NULL;
+	size_t lineSize = 0;
+	const char *name;
+	bool stop = false;
+
+	while (!stop && (name = nextName (ra, &line, &lineSize)) != NULL)
+	{
+		/* Options and comments are not counted by the parsers. A name
+		 * taken as an option parameter makes the helper fall behind by
+		 * one; it is harmless. */
+		if (name [0] == '-' || name [0] == '#' || name [0] == '\0')
+			continue;
+
+		pthread_mutex_lock (&ra->mutex);
+		bool behind = (ra->produced < ra->consumed);
+		if (behind)
+			ra->produced++;
+		pthread_mutex_unlock (&ra->mutex);
+		if (behind)
+			continue;
+
+		int fd = open (name, O_RDONLY | O_CLOEXEC);
+		struct stat status;
+		size_t length = 0;
+
+		if (fd >= 0 && fstat (fd, &status) == 0 && S_ISREG (status.st_mode))
+			length = ((size_t) status.st_size < ra->budget)
+				? (size_t) status.st_size: ra->budget;
+
+		pthread_mutex_lock (&ra->mutex);
+		while (!ra->stop && ra->produced >= ra->consumed
+			   && isWindowFull (ra, length))
+			pthread_cond_wait (&ra->changed, &ra->mutex);
+
+		if (ra->produced < ra->consumed)
+			length = 0;		/* The parsers took it already. */
+		ra->lengths [ra->produced % ra->depth] = length;
+		ra->bytes += length;
+		ra->produced++;
+		stop = ra->stop;
+		pthread_mutex_unlock (&ra->mutex);
+
+		if (fd >= 0)
+		{
+			if (length > 0 && !stop)
+				posix_fadvise (fd, 0, (off_t) length, POSIX_FADV_WILLNEED);
+			close (fd);
+		}
+	}
+
+	free (line);
+	return NULL;
+}
+
+static readAhead *readAheadNew (char *const *argv, FILE *fp)
+{
+	readAhead *ra = xCalloc (1, readAhead);
+
+	ra->argv = argv;
+	ra->fp = fp;
+	ra->depth = Option.readAheadFiles;
+	ra->budget = Option.readAheadBytes;
+	ra->lengths = xCalloc (ra->depth, size_t);
+
+	pthread_mutex_init (&ra->mutex, NULL);
+	pthread_cond_init (&ra->changed, NULL);
+
+	if (pthread_create (&ra->thread, NULL, readAheadMain, ra) != 0)
+	{
+		pthread_cond_destroy (&ra->changed);
+		pthread_mutex_destroy (&ra->mutex);
+		eFree (ra->lengths);
+		eFree (ra);
+		return NULL;
+	}
+	return ra;
+}
+
+extern readAhead *readAheadNewForArgv (char *const *argv)
+{
+	if (Option.readAheadFiles == 0 || Option.readAheadBytes == 0)
+		return NULL;
+
+	/* Nothing is ahead of the first name. */
+	if (argv == NULL || argv [0] == NULL || argv [1] == NULL)
+		return NULL;
+
+	return readAheadNew (argv, NULL);
+}
+
+extern readAhead *readAheadNewForListFile (const char *const fileName, FILE *const list)
+{
+	if (Option.readAheadFiles == 0 || Option.readAheadBytes == 0)
+		return NULL;
+
+	/* The helper reads the list for itself from its own stream. Only
+	 * a regular file can be read twice; the lines of a pipe or a FIFO
+	 * would be shared between the helper and the parsers. */
+	struct stat listStatus;
+	if (fstat (fileno (list), &listStatus) != 0 || !S_ISREG (listStatus.st_mode))
+		return NULL;
+
+	FILE *fp = fopen (fileName, "r");
+	if (fp == NULL)
+		return NULL;
+
+	struct stat status;
+	if (fstat (fileno (fp), &status) != 0
+		|| status.st_dev != listStatus.st_dev || status.st_ino != listStatus.st_ino)
+	{
+		fclose (fp);
+		return NULL;
+	}
+
+	readAhead *ra = readAheadNew (NULL, fp);
+	if (ra == NULL)
+		fclose (fp);
+	return ra;
+}
+
+extern void readAheadAdvance (readAhead *ra)
+{
+	if (ra == NULL)
+		return;
+
+	pthread_mutex_lock (&ra->mutex);
+	if (ra->consumed < ra->produced)
+		ra->bytes -= ra->lengths [ra->consumed % ra->depth];
+	ra->consumed++;
+	pthread_cond_signal (&ra->changed);
+	pthread_mutex_unlock (&ra->mutex);
+}
+
+extern void readAheadDelete (readAhead *ra)
+{
+	if (ra == NULL)
+		return;
+
+	pthread_mutex_lock (&ra->mutex);
+	ra->stop = true;
+	pthread_cond_signal (&ra->changed);
+	pthread_mutex_unlock (&ra->mutex);
+
+	pthread_join (ra->thread, NULL);
+
+	if (ra->fp)
+		fclose (ra->fp);
+	pthread_cond_destroy (&ra->changed);
+	pthread_mutex_destroy (&ra->mutex);
+	eFree (ra->lengths);
+	eFree (ra);
+}
+
+#else
+
+extern readAhead *readAheadNewForArgv (char *const *argv CTAGS_ATTR_UNUSED)
+{
+	return NULL;
+}
+
+extern readAhead *readAheadNewForListFile (const char *const fileName CTAGS_ATTR_UNUSED,
+											FILE *const list CTAGS_ATTR_UNUSED)
+{
+	return NULL;
+}
+
+extern void readAheadAdvance (readAhead *ra CTAGS_ATTR_UNUSED)
+{
+}
+
+extern void readAheadDelete (readAhead *ra CTAGS_ATTR_UNUSED)
+{
+}
+
+#endif	/* HAVE_READ_AHEAD */
@@ -0,0 +1,62 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Defines the interface to read-ahead of input files.
+*/
+#ifndef CTAGS_MAIN_READAHEAD_PRIVATE_H
+#define CTAGS_MAIN_READAHEAD_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stddef.h>
+#include <stdio.h>
+
+#if defined (HAVE_PTHREAD) && defined (HAVE_POSIX_FADVISE) && defined (HAVE_OPENAT)
+#define HAVE_READ_AHEAD 1
+#endif
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/* Read-ahead asks the kernel to bring the input files the parsers open
+ * next into the page cache, so that reading them in getMioFull () does
+ * not wait for the disk.
+ *
+ * A helper thread goes through a list of file names ahead of the
+ * parsers. It stays at most Option.readAheadFiles names and
+ * Option.readAheadBytes bytes ahead of them. */
+typedef struct sReadAhead readAhead;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* NULL is returned if read-ahead is disabled, not available on this
+ * platform, or there is nothing to read ahead. LIST is the stream
+ * the parsers take the names in FILENAME from; nothing is read ahead
+ * unless it is a regular file. */
+extern readAhead *readAheadNewForArgv (char *const *argv);
+extern readAhead *readAheadNewForListFile (const char *const fileName, FILE *const list);
+
+/* Tells that the parsers took the next name in the list. RA can be NULL
+ * for these two. */
+extern void readAheadAdvance (readAhead *ra);
+extern void readAheadDelete (readAhead *ra);
+
+#ifdef HAVE_READ_AHEAD
+
+/* Hints the first LENGTH bytes of NAME in the directory DIRFD. NAME is
+ * relative to the current directory if DIRFD is AT_FDCWD. This can be
+ * called from any thread. */
+extern void readAheadFileAt (int dirfd, const char *const name, size_t length);
+
+#endif	/* HAVE_READ_AHEAD */
+
+#endif	/* CTAGS_MAIN_READAHEAD_PRIVATE_H */
@@ -52,6 +52,9 @@
 #ifdef HAVE_IO_H
 # include <io.h>  /* to declare open() */
 #endif
+#if defined (HAVE_MALLOC_USABLE_SIZE) || defined (_WIN32)
+# include <malloc.h>  /* to declare malloc_usable_size() or _msize() */
+#endif
 #include "debug.h"
 #include "routines.h"
 #include "routines_p.h"
@@ -154,6 +157,9 @@ char *CurrentDirectory;
 static const char *ExecutableProgram;
 static const char *ExecutableName;
 
+static allocationHookFunc AllocationHook;
+static const char *AllocationTag;
+
 /*
 *   FUNCTION PROTOTYPES
 */
@@ -215,6 +221,35 @@ static bool fnmChEq (int c1, int c2)
  *  Memory allocation functions
  */
 
+static size_t allocatedSize (void *ptr)
+{
+#if defined (HAVE_MALLOC_USABLE_SIZE)
+	return malloc_usable_size (ptr);
+#elif defined (_WIN32)
+	return _msize (ptr);
+#else
+	return 0;
+#endif
+}
+
+extern bool setAllocationHook (allocationHookFunc hook)
+{
+#if defined (HAVE_MALLOC_USABLE_SIZE) || defined (_WIN32)
+	AllocationHook = hook;
+	return true;
+#else
+	return false;
+#endif
+}
+
+extern const char *setAllocationTag (const char *tag)
+{
+	const char *old = AllocationTag;
+
+	AllocationTag = tag;
+	return old;
+}
+
 extern void *eMalloc (const size_t size)
 {
 	void *buffer = malloc (size);
@@ -222,6 +257,9 @@ extern void *eMalloc (const size_t size)
 	if (buffer == NULL && size != 0)
 		error (FATAL, "out of memory");
 
+	if (AllocationHook && buffer)
+		AllocationHook (0, allocatedSize (buffer), AllocationTag);
+
 	return buffer;
 }
 
@@ -232,6 +270,9 @@ extern void *eCalloc (const size_t count, const size_t size)
 	if (buffer == NULL && count != 0 && size != 0)
 		error (FATAL, "out of memory");
 
+	if (AllocationHook && buffer)
+		AllocationHook (0, allocatedSize (buffer), AllocationTag);
+
 	return buffer;
 }
 
@@ -242,9 +283,15 @@ extern void *eRealloc (void *const ptr, const size_t size)
 		buffer = eMalloc (size);
 	else
 	{
+		const size_t freed = AllocationHook? allocatedSize (ptr): 0;
+
 		buffer = realloc (ptr, size);
 		if (buffer == NULL && size != 0)
 			error (FATAL, "out of memory");
+
+		if (AllocationHook)
+			AllocationHook (freed, buffer? allocatedSize (buffer): 0,
+							AllocationTag);
 	}
 	return buffer;
 }
@@ -252,11 +299,15 @@ extern void *eRealloc (void *const ptr, const size_t size)
 extern void eFree (void *const ptr)
 {
 	Assert (ptr != NULL);
+	if (AllocationHook)
+		AllocationHook (allocatedSize (ptr), 0, AllocationTag);
 	free (ptr);
 }
 
 extern void eFreeNoNullCheck (void *const ptr)
 {
+	if (AllocationHook && ptr)
+		AllocationHook (allocatedSize (ptr), 0, AllocationTag);
 	free (ptr);
 }
 
@@ -439,36 +490,65 @@ extern void setCurrentDirectory (void) /* TODO */
 }
 
 /* For caching of stat() calls */
+static fileStatus StatCache;
+
+extern void fillFileStatus (fileStatus *const file,
+							const struct stat *const lstatus, const struct stat *const status)
+{
+	const struct stat *target = lstatus;
+
+	if (lstatus == NULL)
+	{
+		file->exists = false;
+		return;
+	}
+
+	file->isSymbolicLink = (bool) S_ISLNK (lstatus->st_mode);
+	if (file->isSymbolicLink)
+		target = status;
+
+	if (target == NULL)
+		file->exists = false;
+	else
+	{
+		file->exists = true;
+		file->isDirectory = (bool) S_ISDIR (target->st_mode);
+		file->isNormalFile = (bool) (S_ISREG (target->st_mode));
+		file->isExecutable = (bool) ((target->st_mode &
+			(S_IXUSR | S_IXGRP | S_IXOTH)) != 0);
+		file->isSetuid = (bool) ((target->st_mode & S_ISUID) != 0);
+		file->isSetgid = (bool) ((target->st_mode & S_ISGID) != 0);
+		file->size = target->st_size;
+		file->mtime = target->st_mtime;
+	}
+}
+
 extern fileStatus *eStat (const char *const fileName)
 {
-	struct stat status;
-	static fileStatus file;
-	if (file.name == NULL  ||  strcmp (fileName, file.name) != 0)
+	struct stat lstatus, status;
+	fileStatus *const file = &StatCache;
+	if (file->name == NULL  ||  strcmp (fileName, file->name) != 0)
 	{
-		eStatFree (&file);
-		file.name = eStrdup (fileName);
-		if (lstat (file.name, &status) != 0)
-			file.exists = false;
-		else
-		{
-			file.isSymbolicLink = (bool) S_ISLNK (status.st_mode);
-			if (file.isSymbolicLink  &&  stat (file.name, &status) != 0)
-				file.exists = false;
-			else
-			{
-				file.exists = true;
-				file.isDirectory = (bool) S_ISDIR (status.st_mode);
-				file.isNormalFile = (bool) (S_ISREG (status.st_mode));
-				file.isExecutable = (bool) ((status.st_mode &
-					(S_IXUSR | S_IXGRP | S_IXOTH)) != 0);
-				file.isSetuid = (bool) ((status.st_mode & S_ISUID) != 0);
-				file.isSetgid = (bool) ((status.st_mode & S_ISGID) != 0);
-				file.size = status.st_size;
-				file.mtime = status.st_mtime;
-			}
-		}
+		bool lstatOK, statOK = false;
+
+		eStatFree (file);
+		file->name = eStrdup (fileName);
+		lstatOK = (lstat (file->name, &lstatus) == 0);
+		if (lstatOK && S_ISLNK (lstatus.st_mode))
+			statOK = (stat (file->name, &status) == 0);
+		fillFileStatus (file, lstatOK? &lstatus: NULL, statOK? &status: NULL);
 	}
-	return &file;
+	return file;
+}
+
+extern fileStatus *eStatSet (const char *const fileName, const fileStatus *const status)
+{
+	fileStatus *const file = &StatCache;
+
+	eStatFree (file);
+	*file = *status;
+	file->name = eStrdup (fileName);
+	return file;
 }
 
 extern void eStatFree (fileStatus *status)
@@ -947,3 +1027,56 @@ extern MIO *tempFile (const char *const mode, char **const pName)
 	FILE *fp = tempFileFP (mode, pName);
 	return mio_new_fp (fp, fclose);
 }
+
+/* Write S[0..LEN) to MIO as a quoted JSON string. Return the number
+ * of bytes written. */
+extern int writeJsonString (MIO *mio, const char *s, size_t len)
+{
+	int length = 0;
+
+	length += mio_putc (mio, '"') != EOF;
+	while (len > 0)
+	{
+		size_t n = findFirstCharToEscape (s, len, '"');
+		if (n > 0)
+		{
+			length += mio_write (mio, s, 1, n);
+			s += n;
+			len -= n;
+			if (len == 0)
+				break;
+		}
+
+		unsigned char c = (unsigned char) *s;
+		const char *seq = NULL;
+		char buf [7];
+
+		switch (c)
+		{
+		case '\\': seq = "\\\\"; break;
+		case '"':  seq = "\\\""; break;
+		case '\b': seq = "\\b"; break;
+		case '\f': seq = "\\f"; break;
+		case '\n': seq = "\\n"; break;
+		case '\r': seq = "\\r"; break;
+		case '\t': seq = "\\t"; break;
+		default:
+			if (c < 0x20)
+			{
+				snprintf (buf, sizeof (buf), "\\u%04X", c);
+				seq = buf;
+			}
+			break;
+		}
+
+		if (seq)
+			length += mio_puts (mio, seq) != EOF? (int) strlen (seq): 0;
+		else
+			length += mio_putc (mio, c) != EOF;
+		s++;
+		len--;
+	}
+	length += mio_putc (mio, '"') != EOF;
+
+	return length;
+}
@@ -54,6 +54,12 @@ extern void eFree (void *const ptr);
 extern void eFreeNoNullCheck (void *const ptr);
 extern void eFreeIndirect(void **ptr);
 
+/* Charge the allocations made from now on to TAG, a string literal,
+ * in the memory report of --totals=json instead of the parser of the
+ * current input file. Pass the returned value to restore the previous
+ * tag when done. */
+extern const char *setAllocationTag (const char *tag);
+
 /* String manipulation functions */
 extern int struppercmp (const char *s1, const char *s2);
 extern int strnuppercmp (const char *s1, const char *s2, size_t n);
@@ -36,6 +36,11 @@
 /*
 *   DATA DECLARATIONS
 */
+/* Called with the size of the block released and the size of the block
+ * allocated by each call of eMalloc() and its friends. TAG is the value
+ * given to setAllocationTag(). */
+typedef void (* allocationHookFunc) (size_t freed, size_t allocated, const char *tag);
+
 extern char *CurrentDirectory;
 #if defined (MSDOS_STYLE_PATH)
 extern const char *const PathDelimiters;
@@ -79,12 +84,27 @@ typedef struct {
 extern void freeRoutineResources (void);
 extern void setExecutableName (const char *const path);
 
+/* Returns false if the size of an allocated block cannot be known
+ * on this platform; HOOK is not installed then. */
+extern bool setAllocationHook (allocationHookFunc hook);
+
 /* File system functions */
 extern const char *getExecutableName (void);
 extern const char *getExecutablePath (void);
 extern void setCurrentDirectory (void);
 extern fileStatus *eStat (const char *const fileName);
 extern void eStatFree (fileStatus *status);
+
+/* Fill FILE as eStat() does from the results of lstat(2), LSTATUS, and,
+ * for a symbolic link, of stat(2), STATUS. NULL stands for a failed call.
+ * FILE->name is not touched. */
+struct stat;
+extern void fillFileStatus (fileStatus *const file,
+							const struct stat *const lstatus, const struct stat *const status);
+
+/* Make eStat (FILENAME) return a copy of STATUS until another name is
+ * given to eStat(). Used for a status obtained without eStat(). */
+extern fileStatus *eStatSet (const char *const fileName, const fileStatus *const status);
 extern bool doesFileExist (const char *const fileName);
 extern bool doesExecutableExist (const char *const fileName);
 extern bool isRecursiveLink (const char* const dirName);
@@ -98,4 +118,6 @@ extern MIO *tempFile (const char *const mode, char **const pName);
 
 extern char* baseFilenameSansExtensionNew (const char *const fileName, const char *const templateExt);
 
+extern int writeJsonString (MIO *mio, const char *s, size_t len);
+
 #endif  /* CTAGS_MAIN_ROUTINES_PRIVATE_H */
@@ -45,18 +45,46 @@ static const char *TR_VERILOG = "Verilog";
 #define startsWith(line,prefix)									\
 	(strncmp(line, prefix, strlen(prefix)) == 0? true: false)
 
+static const char *tasteLines (MIO *input,
+							   const char* (* lineTaster) (const char *, void *),
+							   void *userData)
+{
+	char line[0x800];
+	while (mio_gets(input, line, sizeof(line))) {
+		const char *lang = lineTaster (line, userData);
+		if (lang)
+			return lang;
+	}
+	return NULL;
+}
+
+/* The lines in the head of the input, already read while guessing
+ * the language, are tasted first. The input itself is read only if
+ * the head doesn't hold the whole input and no decision is made. */
 static const char *selectByLines (MIO *input,
 								  const char* (* lineTaster) (const char *, void *),
 								  const char* defaultLang,
 								  void *userData)
 {
-	char line[0x800];
-	while (mio_gets(input, line, sizeof(line))) {
-		const char *lang = lineTaster (line, userData);
+	const char *lang;
+	size_t length;
+	bool whole;
+	const unsigned char *head = getGuessingInputHead (input, &length, &whole);
+
+	if (head)
+	{
+		MIO *mio = mio_new_memory ((unsigned char *)head, length, NULL, NULL);
+		lang = tasteLines (mio, lineTaster, userData);
+		mio_unref (mio);
 		if (lang)
 			return lang;
+		if (whole)
+			return defaultLang;
+		mio_seek (input, (long)length, SEEK_SET);
 	}
-	return defaultLang;
+
+	lang = tasteLines (input, lineTaster, userData);
+	return lang? lang: defaultLang;
 }
 
 /* Returns "Perl" or "Perl6" or NULL if it does not taste like anything */
@@ -423,11 +451,86 @@ selectVOrVerilogByKeywords (MIO *input,
 #include <libxml/parser.h>
 #include <libxml/xpath.h>
 #include <libxml/tree.h>
+#include <libxml/parserInternals.h>
+#include <libxml/SAX2.h>
+#include <libxml/xmlreader.h>
 
 static void suppressWarning (void *ctx CTAGS_ATTR_UNUSED, const char *msg CTAGS_ATTR_UNUSED, ...)
 {
 }
 
+#ifdef LIBXML_READER_ENABLED
+static void
+stopAtRootElement (void *ctx, const xmlChar *localname, const xmlChar *prefix,
+				   const xmlChar *URI, int nb_namespaces, const xmlChar **namespaces,
+				   int nb_attributes, int nb_defaulted, const xmlChar **attributes)
+{
+	xmlParserCtxtPtr ctxt = ctx;
+
+	xmlSAX2StartElementNs (ctx, localname, prefix, URI,
+						   nb_namespaces, namespaces,
+						   nb_attributes, nb_defaulted, attributes);
+	ctxt->_private = ctxt->node;
+	xmlStopParser (ctxt);
+}
+
+static bool
+isXmlWellFormed (const unsigned char *buf, size_t len)
+{
+	xmlTextReaderPtr reader;
+	int r;
+
+	reader = xmlReaderForMemory ((const char *)buf, len, NULL, NULL,
+								 XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+	if (reader == NULL)
+		return false;
+
+	while ((r = xmlTextReaderRead (reader)) == 1)
+		;
+	xmlFreeTextReader (reader);
+	return (r == 0);
+}
+
+/* The selectors look at the prolog and the root element only. Make
+ * the tree up to the start tag of the root element, and check the rest
+ * of the input without making a tree; the XML parser may read the input
+ * as a stream. Like xmlParseMemory, return NULL for a broken input. */
+static xmlDocPtr
+xmlParseMIO (MIO *input)
+{
+	const unsigned char *buf;
+	size_t len;
+	xmlParserCtxtPtr ctxt;
+	xmlDocPtr doc;
+	bool rootFound;
+
+	buf = mio_memory_get_data (input, &len);
+	Assert (buf);
+
+	xmlSetGenericErrorFunc (NULL, suppressWarning);
+	xmlLineNumbersDefault (1);
+
+	ctxt = xmlCreateMemoryParserCtxt ((const char *)buf, len);
+	if (ctxt == NULL)
+		return NULL;
+
+	ctxt->sax->startElementNs = stopAtRootElement;
+	ctxt->_private = NULL;
+	xmlParseDocument (ctxt);
+
+	doc = ctxt->myDoc;
+	rootFound = (ctxt->_private != NULL);
+	ctxt->myDoc = NULL;
+	xmlFreeParserCtxt (ctxt);
+
+	if (doc && !(rootFound && isXmlWellFormed (buf, len)))
+	{
+		xmlFreeDoc (doc);
+		doc = NULL;
+	}
+	return doc;
+}
+#else
 static xmlDocPtr
 xmlParseMIO (MIO *input)
 {
@@ -441,6 +544,7 @@ xmlParseMIO (MIO *input)
 	xmlLineNumbersDefault (1);
 	return xmlParseMemory((const char *)buf, len);
 }
+#endif
 
 static bool
 matchXpathFileSpec (xmlDocPtr doc, xpathFileSpec *spec)
@@ -620,11 +724,16 @@ selectByXpathFileSpec (MIO *input,
 
 	r = selectParserForXmlDoc (doc, candidates, nCandidates);
 
+#ifdef LIBXML_READER_ENABLED
+	/* DOC is not the whole input. */
+	xmlFreeDoc (doc);
+#else
 	if (r == NULL)
 		xmlFreeDoc (doc);
 	else
 		mio_attach_user_data (input,
 							  doc,(MIODestroyNotify)xmlFreeDoc);
+#endif
 
 	return r;
 }
@@ -39,6 +39,17 @@ extern void catFile (MIO *mio)
 	if (mio != NULL)
 	{
 		int c;
+		size_t size;
+		unsigned char *data = mio_memory_get_data (mio, &size);
+
+		if (data)
+		{
+			if (size > 0)
+				fwrite (data, 1, size, stdout);
+			fflush (stdout);
+			return;
+		}
+
 		mio_seek (mio, 0, SEEK_SET);
 		while ((c = mio_getc (mio)) != EOF)
 			putchar (c);
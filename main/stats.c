@@ -16,9 +16,16 @@
 #include "general.h"  /* must always come first */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
+#include "debug.h"
 #include "entry_p.h"
 #include "options_p.h"
+#include "parse_p.h"
+#include "read_p.h"
+#include "routines_p.h"
 #include "stats_p.h"
 
 /*
@@ -26,11 +33,66 @@
 */
 #define plural(value)  (((unsigned long)(value) == 1L) ? "" : "s")
 
+/* The number of files listed as the slowest or the largest in
+ * --totals=json. */
+#define SLOWEST_FILES 10
+
+/* The number of tags given to setAllocationTag() we can count. */
+#define MEMORY_TAGS 32
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sFileTotals {
+	char *name;
+	langType language;
+	unsigned long lines, bytes, tags;
+	double wall, cpu;
+	long long peak;
+} fileTotals;
+
+typedef struct sMemoryTotals {
+	const char *name;
+	unsigned long allocations;
+	unsigned long long allocated;
+} memoryTotals;
+
+typedef struct sParserTotals {
+	unsigned long files, lines, bytes, tags, rescans;
+	double parseWall, parseCpu;
+	double timerWall [COUNT_STATS_TIMERS];
+	memoryTotals memory;
+} parserTotals;
+
 /*
 *   DATA DEFINITIONS
 */
 static struct { long files, lines, bytes; } Totals = { 0, 0, 0 };
 
+/* Filled only for --totals=json. */
+static parserTotals *ParserTotals;
+static unsigned int ParserTotalsCount;
+static double TimerWall [COUNT_STATS_TIMERS];	/* spent outside any file */
+static double SortCpu;
+
+static fileTotals CurrentFile;
+static unsigned int FileDepth;
+static statsStamp FileStamp;
+static unsigned long FileTagsAtStart;
+
+static fileTotals Slowest [SLOWEST_FILES];
+static unsigned int SlowestCount;
+
+static bool MemoryStats;
+static bool InAllocationHook;
+/* Bytes allocated and not released yet since startMemoryStats(). */
+static long long LiveBytes, PeakBytes, FilePeakBytes;
+static memoryTotals MemoryTags [MEMORY_TAGS];
+static unsigned int MemoryTagsCount;
+
+static fileTotals Largest [SLOWEST_FILES];
+static unsigned int LargestCount;
+
 
 /*
 *   FUNCTION DEFINITIONS
@@ -42,6 +104,211 @@ extern void addTotals (
 	Totals.files += files;
 	Totals.lines += lines;
 	Totals.bytes += bytes;
+
+	if (FileDepth > 0)
+	{
+		CurrentFile.lines += lines;
+		CurrentFile.bytes += bytes;
+	}
+}
+
+extern double statsWallClock (void)
+{
+#if defined (HAVE_CLOCK_GETTIME) && defined (CLOCK_MONOTONIC)
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+	return ((double) clock ()) / CLOCKS_PER_SEC;
+#endif
+}
+
+static double cpuClock (void)
+{
+	return ((double) clock ()) / CLOCKS_PER_SEC;
+}
+
+static parserTotals *getParserTotals (langType language)
+{
+	if (ParserTotals == NULL)
+	{
+		ParserTotalsCount = countParsers ();
+		ParserTotals = xCalloc (ParserTotalsCount, parserTotals);
+	}
+	Assert (0 <= language && (unsigned int) language < ParserTotalsCount);
+	return ParserTotals + language;
+}
+
+extern void startStatsTimer (enum statsTimer timer, statsStamp *stamp)
+{
+	if (Option.printTotals != TOTALS_JSON)
+		return;
+
+	stamp->wall = statsWallClock ();
+	/* Reading the CPU clock costs a system call; don't do it for
+	 * the timers started for each line or each tag. */
+	stamp->cpu = (timer == STATS_TIMER_SORT)? cpuClock (): 0.0;
+}
+
+extern void stopStatsTimer (enum statsTimer timer, const statsStamp *stamp)
+{
+	if (Option.printTotals != TOTALS_JSON)
+		return;
+
+	double wall = statsWallClock () - stamp->wall;
+	if (FileDepth > 0)
+		getParserTotals (CurrentFile.language)->timerWall [timer] += wall;
+	else
+		TimerWall [timer] += wall;
+
+	if (timer == STATS_TIMER_SORT)
+		SortCpu += cpuClock () - stamp->cpu;
+}
+
+extern void countStatsRescan (langType language)
+{
+	if (Option.printTotals != TOTALS_JSON)
+		return;
+
+	getParserTotals (language)->rescans++;
+}
+
+extern void beginStatsFile (const char *const fileName, langType language)
+{
+	if (Option.printTotals != TOTALS_JSON)
+		return;
+
+	/* Count a file parsed while parsing another file as a part of the
+	 * outer one. */
+	if (FileDepth++ > 0)
+		return;
+
+	CurrentFile.name = eStrdup (fileName);
+	CurrentFile.language = language;
+	CurrentFile.lines = 0;
+	CurrentFile.bytes = 0;
+	FilePeakBytes = LiveBytes;
+	FileTagsAtStart = numTagsAdded ();
+	FileStamp.wall = statsWallClock ();
+	FileStamp.cpu = cpuClock ();
+}
+
+static bool isSlower (const fileTotals *a, const fileTotals *b)
+{
+	return a->wall > b->wall;
+}
+
+static bool isLarger (const fileTotals *a, const fileTotals *b)
+{
+	return a->peak > b->peak;
+}
+
+/* Keep the top SLOWEST_FILES files in RANKING ordered by BETTER. */
+static void rankFile (fileTotals *ranking, unsigned int *count,
+					  const fileTotals *file,
+					  bool (* better) (const fileTotals *, const fileTotals *))
+{
+	unsigned int i;
+
+	if (*count == SLOWEST_FILES)
+	{
+		if (!better (file, ranking + SLOWEST_FILES - 1))
+			return;
+		eFree (ranking [--*count].name);
+	}
+
+	for (i = *count; i > 0 && better (file, ranking + i - 1); i--)
+		ranking [i] = ranking [i - 1];
+	ranking [i] = *file;
+	ranking [i].name = eStrdup (file->name);
+	(*count)++;
+}
+
+extern void endStatsFile (void)
+{
+	if (Option.printTotals != TOTALS_JSON || FileDepth == 0)
+		return;
+
+	if (--FileDepth > 0)
+		return;
+
+	CurrentFile.wall = statsWallClock () - FileStamp.wall;
+	CurrentFile.cpu = cpuClock () - FileStamp.cpu;
+	CurrentFile.tags = numTagsAdded () - FileTagsAtStart;
+
+	parserTotals *p = getParserTotals (CurrentFile.language);
+	p->files++;
+	p->lines += CurrentFile.lines;
+	p->bytes += CurrentFile.bytes;
+	p->tags += CurrentFile.tags;
+	p->parseWall += CurrentFile.wall;
+	p->parseCpu += CurrentFile.cpu;
+
+	rankFile (Slowest, &SlowestCount, &CurrentFile, isSlower);
+	if (MemoryStats)
+	{
+		CurrentFile.peak = FilePeakBytes;
+		rankFile (Largest, &LargestCount, &CurrentFile, isLarger);
+	}
+	eFree (CurrentFile.name);
+	CurrentFile.name = NULL;
+}
+
+static memoryTotals *getMemoryTotals (const char *tag)
+{
+	unsigned int i;
+
+	if (tag == NULL)
+	{
+		if (FileDepth > 0)
+		{
+			langType language = getInputLanguageIfAny ();
+			if (language == LANG_IGNORE)
+				language = CurrentFile.language;
+			return &getParserTotals (language)->memory;
+		}
+		tag = "main";
+	}
+
+	for (i = 0; i < MemoryTagsCount; i++)
+		if (MemoryTags [i].name == tag || strcmp (MemoryTags [i].name, tag) == 0)
+			return MemoryTags + i;
+
+	if (MemoryTagsCount == MEMORY_TAGS)
+		return NULL;
+	MemoryTags [MemoryTagsCount].name = tag;
+	return MemoryTags + MemoryTagsCount++;
+}
+
+static void countAllocation (size_t freed, size_t allocated, const char *tag)
+{
+	LiveBytes += (long long) allocated - (long long) freed;
+	if (LiveBytes > PeakBytes)
+		PeakBytes = LiveBytes;
+	if (LiveBytes > FilePeakBytes)
+		FilePeakBytes = LiveBytes;
+
+	/* getMemoryTotals() may allocate the parser table. */
+	if (allocated == 0 || InAllocationHook)
+		return;
+
+	InAllocationHook = true;
+	memoryTotals *m = getMemoryTotals (tag);
+	if (m)
+	{
+		m->allocations++;
+		m->allocated += allocated;
+	}
+	InAllocationHook = false;
+}
+
+extern void startMemoryStats (void)
+{
+	if (Option.printTotals != TOTALS_JSON)
+		return;
+
+	MemoryStats = setAllocationHook (countAllocation);
 }
 
 extern void printTotals (const clock_t *const timeStamps, bool append, sortType sorted)
@@ -83,3 +350,147 @@ extern void printTotals (const clock_t *const timeStamps, bool append, sortType
 		 (unsigned long) maxTagsLine ());
 #endif
 }
+
+static int compareMemoryTotals (const void *a, const void *b)
+{
+	const memoryTotals *ma = a;
+	const memoryTotals *mb = b;
+
+	if (ma->allocated != mb->allocated)
+		return (ma->allocated < mb->allocated)? 1: -1;
+	return strcmp (ma->name, mb->name);
+}
+
+static void printJsonMemory (MIO *mio)
+{
+	unsigned int count = 0;
+	unsigned long allocations = 0;
+	unsigned long long allocated = 0;
+	unsigned int i;
+
+	memoryTotals *subsystems = xMalloc (MemoryTagsCount + ParserTotalsCount,
+										memoryTotals);
+	for (i = 0; i < MemoryTagsCount; i++)
+		subsystems [count++] = MemoryTags [i];
+	for (i = 0; i < ParserTotalsCount; i++)
+	{
+		if (ParserTotals [i].memory.allocations == 0)
+			continue;
+		subsystems [count] = ParserTotals [i].memory;
+		subsystems [count++].name = getLanguageName (i);
+	}
+	qsort (subsystems, count, sizeof (memoryTotals), compareMemoryTotals);
+
+	for (i = 0; i < count; i++)
+	{
+		allocations += subsystems [i].allocations;
+		allocated += subsystems [i].allocated;
+	}
+	mio_printf (mio, " \"memory\": {\"peak\": %lld, \"allocations\": %lu, \"allocated\": %llu,\n",
+			 PeakBytes, allocations, allocated);
+
+	mio_puts (mio, "  \"subsystems\": [");
+	for (i = 0; i < count; i++)
+	{
+		mio_printf (mio, "%s\n   {\"name\": ", i == 0? "": ",");
+		writeJsonString (mio, subsystems [i].name, strlen (subsystems [i].name));
+		mio_printf (mio, ", \"allocations\": %lu, \"allocated\": %llu}",
+				 subsystems [i].allocations, subsystems [i].allocated);
+	}
+	mio_puts (mio, "],\n");
+	eFree (subsystems);
+
+	mio_puts (mio, "  \"largest\": [");
+	for (i = 0; i < LargestCount; i++)
+	{
+		fileTotals *f = Largest + i;
+		const char *parser;
+
+		mio_printf (mio, "%s\n   {\"name\": ", i == 0? "": ",");
+		writeJsonString (mio, f->name, strlen (f->name));
+		mio_puts (mio, ", \"parser\": ");
+		parser = getLanguageName (f->language);
+		writeJsonString (mio, parser, strlen (parser));
+		mio_printf (mio, ", \"peak\": %lld}", f->peak);
+		eFree (f->name);
+	}
+	mio_puts (mio, "]},\n");
+	LargestCount = 0;
+}
+
+static void printJsonTimers (MIO *mio, const double *timerWall)
+{
+	mio_printf (mio, "\"regex\": {\"wall\": %.6f}, \"write\": {\"wall\": %.6f}",
+			 timerWall [STATS_TIMER_REGEX], timerWall [STATS_TIMER_WRITE]);
+}
+
+extern void printTotalsAsJson (bool append, sortType sorted)
+{
+	bool memoryStats = MemoryStats;
+	unsigned int i;
+	bool first = true;
+
+	if (memoryStats)
+	{
+		/* Don't count the allocations for the report itself. */
+		setAllocationHook (NULL);
+		MemoryStats = false;
+	}
+	MIO *mio = mio_new_fp (stderr, NULL);
+
+	mio_printf (mio, "{\"files\": %ld, \"lines\": %ld, \"bytes\": %ld, ",
+			 Totals.files, Totals.lines, Totals.bytes);
+	mio_printf (mio, "\"tags\": {\"added\": %lu", numTagsAdded ());
+	if (append)
+		mio_printf (mio, ", \"total\": %lu", numTagsTotal ());
+	mio_puts (mio, "},\n");
+
+	mio_puts (mio, " \"time\": {");
+	printJsonTimers (mio, TimerWall);
+	if (sorted != SO_UNSORTED)
+		mio_printf (mio, ", \"sort\": {\"wall\": %.6f, \"cpu\": %.6f}",
+				 TimerWall [STATS_TIMER_SORT], SortCpu);
+	mio_puts (mio, "},\n");
+
+	if (memoryStats)
+		printJsonMemory (mio);
+
+	mio_puts (mio, " \"parsers\": [");
+	for (i = 0; i < ParserTotalsCount; i++)
+	{
+		parserTotals *p = ParserTotals + i;
+		if (p->files == 0 && p->rescans == 0)
+			continue;
+
+		const char *name = getLanguageName (i);
+		mio_printf (mio, "%s\n  {\"name\": ", first? "": ",");
+		writeJsonString (mio, name, strlen (name));
+		mio_printf (mio, ", \"files\": %lu, \"lines\": %lu, \"bytes\": %lu, \"tags\": %lu, \"rescans\": %lu,\n",
+				 p->files, p->lines, p->bytes, p->tags, p->rescans);
+		mio_printf (mio, "   \"time\": {\"parse\": {\"wall\": %.6f, \"cpu\": %.6f}, ",
+				 p->parseWall, p->parseCpu);
+		printJsonTimers (mio, p->timerWall);
+		mio_puts (mio, "}}");
+		first = false;
+	}
+	mio_puts (mio, "],\n");
+
+	mio_puts (mio, " \"slowest\": [");
+	for (i = 0; i < SlowestCount; i++)
+	{
+		fileTotals *f = Slowest + i;
+		const char *parser;
+
+		mio_printf (mio, "%s\n  {\"name\": ", i == 0? "": ",");
+		writeJsonString (mio, f->name, strlen (f->name));
+		mio_puts (mio, ", \"parser\": ");
+		parser = getLanguageName (f->language);
+		writeJsonString (mio, parser, strlen (parser));
+		mio_printf (mio, ", \"lines\": %lu, \"bytes\": %lu, \"tags\": %lu, \"wall\": %.6f, \"cpu\": %.6f}",
+				 f->lines, f->bytes, f->tags, f->wall, f->cpu);
+		eFree (f->name);
+	}
+	mio_puts (mio, "]}\n");
+	SlowestCount = 0;
+	mio_unref (mio);
+}
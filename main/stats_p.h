@@ -19,10 +19,46 @@
 #include "general.h"  /* must always come first */
 #include "options_p.h"
 
+#include "types.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/* Timers accumulated per parser for --totals=json. The time is charged
+ * to the parser of the file being parsed. */
+enum statsTimer {
+	STATS_TIMER_REGEX,
+	STATS_TIMER_WRITE,
+	STATS_TIMER_SORT,
+	COUNT_STATS_TIMERS
+};
+
+typedef struct sStatsStamp {
+	double wall;
+	double cpu;
+} statsStamp;
+
 /*
 *   FUNCTION PROTOTYPES
 */
 extern void addTotals (const unsigned int files, const long unsigned int lines, const long unsigned int bytes);
 extern void printTotals (const clock_t *const timeStamps, bool append, sortType sorted);
+extern void printTotalsAsJson (bool append, sortType sorted);
+
+/* Seconds from an arbitrary origin; only differences are meaningful. */
+extern double statsWallClock (void);
+
+/* These do nothing unless --totals=json is given. */
+extern void startStatsTimer (enum statsTimer timer, statsStamp *stamp);
+extern void stopStatsTimer (enum statsTimer timer, const statsStamp *stamp);
+extern void beginStatsFile (const char *const fileName, langType language);
+extern void endStatsFile (void);
+extern void countStatsRescan (langType language);
+
+/* Count the bytes allocated by eMalloc() and its friends for each
+ * parser and each tag given to setAllocationTag(), and the peak of
+ * the live bytes for each file. */
+extern void startMemoryStats (void);
 
 #endif  /* CTAGS_MAIN_STATS_PRIVATE_H */
@@ -0,0 +1,101 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module writes spans of the processing to a file in the trace event
+*   format of Chrome, which Perfetto and chrome://tracing can load.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "error_p.h"
+#include "mio.h"
+#include "routines_p.h"
+#include "stats_p.h"
+#include "trace-event_p.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+static MIO *TraceEventMio;
+static double TraceEventOrigin;
+static long TraceEventPid;
+static bool TraceEventFirst;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+extern void openTraceEvents (const char *const fileName)
+{
+	closeTraceEvents ();
+
+	FILE *fp = fopen (fileName, "w");
+	if (fp == NULL)
+		error (FATAL | PERROR, "cannot open trace event file \"%s\"", fileName);
+	TraceEventMio = mio_new_fp (fp, fclose);
+
+	TraceEventOrigin = statsWallClock ();
+#ifdef HAVE_UNISTD_H
+	TraceEventPid = (long) getpid ();
+#endif
+	/* The closing bracket is optional in this format; a trace cut
+	 * by a fatal error can still be loaded. */
+	mio_puts (TraceEventMio, "[");
+	TraceEventFirst = true;
+}
+
+extern void closeTraceEvents (void)
+{
+	if (TraceEventMio == NULL)
+		return;
+
+	mio_puts (TraceEventMio, "\n]\n");
+	if (mio_unref (TraceEventMio) != 0)
+		error (WARNING | PERROR, "cannot close trace event file");
+	TraceEventMio = NULL;
+}
+
+static void putEvent (char phase, const char *name, const char *argName, const char *argValue)
+{
+	mio_printf (TraceEventMio, "%s\n{\"ph\": \"%c\", \"ts\": %.3f, \"pid\": %ld, \"tid\": %ld",
+			 TraceEventFirst? "": ",", phase, (statsWallClock () - TraceEventOrigin) * 1e6,
+			 TraceEventPid, TraceEventPid);
+	if (name)
+	{
+		mio_puts (TraceEventMio, ", \"name\": ");
+		writeJsonString (TraceEventMio, name, strlen (name));
+	}
+	if (argName && argValue)
+	{
+		mio_puts (TraceEventMio, ", \"args\": {");
+		writeJsonString (TraceEventMio, argName, strlen (argName));
+		mio_puts (TraceEventMio, ": ");
+		writeJsonString (TraceEventMio, argValue, strlen (argValue));
+		mio_putc (TraceEventMio, '}');
+	}
+	mio_putc (TraceEventMio, '}');
+	TraceEventFirst = false;
+}
+
+extern void beginTraceEvent (const char *name, const char *argName, const char *argValue)
+{
+	if (TraceEventMio)
+		putEvent ('B', name, argName, argValue);
+}
+
+extern void endTraceEvent (void)
+{
+	if (TraceEventMio)
+		putEvent ('E', NULL, NULL, NULL);
+}
@@ -0,0 +1,28 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Defines interface for writing spans in the Chrome trace event format.
+*/
+#ifndef CTAGS_MAIN_TRACE_EVENT_PRIVATE_H
+#define CTAGS_MAIN_TRACE_EVENT_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void openTraceEvents (const char *const fileName);
+extern void closeTraceEvents (void);
+
+/* Spans must nest. ARG_NAME and ARG_VALUE may be NULL.
+ * These do nothing unless --_trace-events is given. */
+extern void beginTraceEvent (const char *name, const char *argName, const char *argValue);
+extern void endTraceEvent (void);
+
+#endif	/* CTAGS_MAIN_TRACE_EVENT_PRIVATE_H */
@@ -15,6 +15,11 @@
 #include <limits.h>  /* to define INT_MAX */
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+# include <emmintrin.h>
+# define USE_SSE2_ESCAPE_SCANNER
+#endif
 
 #include "debug.h"
 #include "routines.h"
@@ -314,12 +319,89 @@ static int valueToXDigit (int v)
 		return '0' + v;
 }
 
+static bool isCharToEscape (unsigned char c, unsigned char extra)
+{
+	return (c <= 0x1F || c == 0x7F || c == '\\' || c == extra);
+}
+
+/* Return the offset of the first byte in S[0..LEN) that is a control
+ * character (0x00-0x1F, 0x7F), a backslash, or EXTRA. Return LEN if
+ * there is no such byte. Most of the strings we write need no escaping;
+ * this lets callers check them 16 (or 8) bytes at a time and use them
+ * as is. */
+extern size_t findFirstCharToEscape (const char *s, size_t len, unsigned char extra)
+{
+	size_t i = 0;
+
+#ifdef USE_SSE2_ESCAPE_SCANNER
+	const __m128i v1f = _mm_set1_epi8 (0x1F);
+	const __m128i vdel = _mm_set1_epi8 (0x7F);
+	const __m128i vbs = _mm_set1_epi8 ('\\');
+	const __m128i vextra = _mm_set1_epi8 ((char) extra);
+
+	for (; i + 16 <= len; i += 16)
+	{
+		__m128i x = _mm_loadu_si128 ((const __m128i *)(s + i));
+		/* max(x, 0x1F) == 0x1F iff x <= 0x1F (unsigned) */
+		__m128i m = _mm_cmpeq_epi8 (_mm_max_epu8 (x, v1f), v1f);
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (x, vdel));
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (x, vbs));
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (x, vextra));
+
+		int mask = _mm_movemask_epi8 (m);
+		if (mask)
+			return i + __builtin_ctz ((unsigned int) mask);
+	}
+#else
+	/* Word-at-a-time fallback: test 8 bytes for the presence of
+	 * a byte to escape, then locate it with the scalar loop below. */
+#define ONES ((uint64_t)0x0101010101010101ULL)
+#define HIGHS ((uint64_t)0x8080808080808080ULL)
+#define HAS_ZERO(x) (((x) - ONES) & ~(x) & HIGHS)
+#define HAS_LESS(x,n) (((x) - ONES * (n)) & ~(x) & HIGHS)
+	for (; i + 8 <= len; i += 8)
+	{
+		uint64_t x;
+		memcpy (&x, s + i, sizeof (x));
+		if (HAS_LESS (x, 0x20)
+			|| HAS_ZERO (x ^ (ONES * 0x7F))
+			|| HAS_ZERO (x ^ (ONES * '\\'))
+			|| HAS_ZERO (x ^ (ONES * extra)))
+			break;
+	}
+#undef HAS_LESS
+#undef HAS_ZERO
+#undef HIGHS
+#undef ONES
+#endif
+
+	for (; i < len; i++)
+	{
+		if (isCharToEscape ((unsigned char) s[i], extra))
+			break;
+	}
+	return i;
+}
+
 extern void vStringCatSWithEscaping (vString* b, const char *s)
 {
-	for(; *s; s++)
+	size_t len = strlen (s);
+
+	for(; *s; s++, len--)
 	{
 		unsigned char c = (unsigned char) *s;
 
+		if (! isCharToEscape (c, '\\'))
+		{
+			size_t n = findFirstCharToEscape (s, len, '\\');
+			vStringNCatSUnsafe (b, s, n);
+			s += n;
+			len -= n;
+			if (len == 0)
+				break;
+			c = (unsigned char) *s;
+		}
+
 		/* escape control characters (incl. \t) */
 		if ((c > 0x00 && c <= 0x1F) || c == 0x7F || c == '\\')
 		{
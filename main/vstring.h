@@ -94,6 +94,7 @@ extern vString *vStringNewOwn (char *s);
 extern char    *vStringDeleteUnwrap (vString *const string);
 extern char    *vStringStrdup (const vString *const string);
 
+extern size_t findFirstCharToEscape (const char *s, size_t len, unsigned char extra);
 extern void vStringCatSWithEscaping (vString* b, const char *s);
 extern void vStringCatSWithEscapingAsPattern (vString *output, const char* input);
 
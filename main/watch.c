@@ -0,0 +1,498 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements the watch mode (--watch): after the initial run,
+*   ctags waits for changes in the directories it recursed into, and updates
+*   the tag file for the changed files only.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#define OPTION_WRITE
+#include "options_p.h"
+
+#include <string.h>
+
+#include "debug.h"
+#include "routines.h"
+#include "watch_p.h"
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dedup_p.h"
+#include "entry_p.h"
+#include "htable.h"
+#include "read_p.h"
+#include "routines_p.h"
+#include "strlist.h"
+#include "vstring.h"
+
+/*
+*   MACROS
+*/
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE	\
+					  | IN_MOVED_FROM | IN_MOVED_TO)
+
+/* Wait for this period of silence before updating the tag file, so a
+ * burst of events (saving a file, checking out a branch) results in
+ * one update. */
+#define QUIET_PERIOD_MSEC 100
+/* ... but don't keep the tag file stale longer than this. */
+#define MAX_DELAY_MSEC 1000
+
+#define TEMP_FILE_SUFFIX ".ctags-watch-XXXXXX"
+
+/*
+*   DATA DECLARATIONS
+*/
+enum changeFlags {
+	CHANGE_SEEN      = 1 << 0,
+	CHANGE_REPARSE   = 1 << 1,	/* the entry may exist after the change */
+	CHANGE_DIRECTORY = 1 << 2,
+};
+
+/*
+*   DATA DEFINITIONS
+*/
+static int inotifyFd = -1;
+static hashTable *watchedDirs;	/* watch descriptor -> directory name */
+static hashTable *changes;		/* entry name -> enum changeFlags */
+static char *tagFileAbsName;
+static volatile sig_atomic_t stopRequested;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+extern void watchDirectory (const char *const dirName)
+{
+	if (! Option.watch)
+		return;
+
+	if (inotifyFd < 0)
+	{
+		inotifyFd = inotify_init1 (IN_CLOEXEC);
+		if (inotifyFd < 0)
+			error (FATAL | PERROR, "cannot initialize inotify");
+		watchedDirs = hashTableNew (127, hashPtrhash, hashPtreq, NULL, eFree);
+	}
+
+	int wd = inotify_add_watch (inotifyFd, dirName, WATCH_EVENTS | IN_ONLYDIR);
+	if (wd < 0)
+	{
+		error (WARNING | PERROR, "cannot watch \"%s\"", dirName);
+		return;
+	}
+	verbose ("watching \"%s\"\n", dirName);
+	hashTableUpdateOrPutItem (watchedDirs, HT_INT_TO_PTR (wd), eStrdup (dirName));
+}
+
+static bool isUnderDirectory (const char *const name, const char *const dir)
+{
+	size_t len = strlen (dir);
+
+	return strncmp (name, dir, len) == 0 && name[len] == '/';
+}
+
+static bool unwatchIfUnder (const void *key, void *value, void *user_data)
+{
+	const char *dir = user_data;
+
+	if (strcmp (value, dir) == 0 || isUnderDirectory (value, dir))
+		inotify_rm_watch (inotifyFd, HT_PTR_TO_INT (key));	/* IN_IGNORED follows */
+	return true;
+}
+
+static void recordChange (char *name, unsigned int flags)
+{
+	void *old = hashTableGetItem (changes, name);
+
+	flags |= CHANGE_SEEN;
+	if (old)
+	{
+		hashTableUpdateItem (changes, name, HT_UINT_TO_PTR (HT_PTR_TO_UINT (old) | flags));
+		eFree (name);
+	}
+	else
+		hashTablePutItem (changes, name, HT_UINT_TO_PTR (flags));
+}
+
+static bool isOwnFile (const char *const name)
+{
+	char *absName = absoluteFilename (name);
+	size_t len = strlen (tagFileAbsName);
+	bool own = (strncmp (absName, tagFileAbsName, len) == 0
+				&& (absName[len] == '\0'
+					|| strncmp (absName + len, TEMP_FILE_SUFFIX,
+								strlen (TEMP_FILE_SUFFIX) - 6) == 0));
+
+	eFree (absName);
+	return own;
+}
+
+static bool collectDirectoryName (const void *key CTAGS_ATTR_UNUSED, void *value, void *user_data)
+{
+	hashTablePutItem (user_data, value, NULL);
+	return true;
+}
+
+static bool recordIfTopDirectory (const void *key CTAGS_ATTR_UNUSED, void *value, void *user_data)
+{
+	hashTable *names = user_data;
+	const char *dir = value;
+	bool top = true;
+
+	if (strcmp (dir, ".") != 0 && ! isAbsolutePath (dir))
+		top = ! hashTableHasItem (names, ".");
+
+	char *parent = eStrdup (dir);
+	char *slash;
+	while (top && (slash = strrchr (parent, '/')) && slash != parent)
+	{
+		*slash = '\0';
+		top = ! hashTableHasItem (names, parent);
+	}
+	eFree (parent);
+
+	if (top)
+		recordChange (eStrdup (dir), CHANGE_DIRECTORY | CHANGE_REPARSE);
+	return true;
+}
+
+/*  Some events are lost; scan the watched directory trees again.
+ */
+static void recordAllDirectories (void)
+{
+	hashTable *names = hashTableNew (127, hashCstrhash, hashCstreq, NULL, NULL);
+
+	hashTableForeachItem (watchedDirs, collectDirectoryName, names);
+	hashTableForeachItem (watchedDirs, recordIfTopDirectory, names);
+	hashTableDelete (names);
+}
+
+static void handleEvent (const struct inotify_event *const ev)
+{
+	if (ev->mask & IN_Q_OVERFLOW)
+	{
+		error (WARNING, "too many changes at once; rescanning all watched directories");
+		recordAllDirectories ();
+		return;
+	}
+
+	if (ev->mask & IN_IGNORED)
+	{
+		hashTableDeleteItem (watchedDirs, HT_INT_TO_PTR (ev->wd));
+		return;
+	}
+
+	const char *dir = hashTableGetItem (watchedDirs, HT_INT_TO_PTR (ev->wd));
+	if (dir == NULL || ev->len == 0)
+		return;
+
+	char *name = (strcmp (dir, ".") == 0)
+		? eStrdup (ev->name)
+		: combinePathAndFile (dir, ev->name);
+
+	if (isOwnFile (name))
+	{
+		eFree (name);
+		return;
+	}
+
+	unsigned int flags = (ev->mask & IN_ISDIR)? CHANGE_DIRECTORY: 0;
+	if (ev->mask & (IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO))
+		flags |= CHANGE_REPARSE;
+	if ((ev->mask & IN_MOVED_FROM) && (ev->mask & IN_ISDIR))
+		/* The watches would report the events with the old names. */
+		hashTableForeachItem (watchedDirs, unwatchIfUnder, name);
+
+	recordChange (name, flags);
+}
+
+static void readEvents (void)
+{
+	char buf[4096] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+	ssize_t len = read (inotifyFd, buf, sizeof (buf));
+
+	if (len < 0)
+	{
+		if (errno != EINTR && errno != EAGAIN)
+			error (FATAL | PERROR, "failed to read inotify events");
+		return;
+	}
+
+	for (char *p = buf; p < buf + len; )
+	{
+		const struct inotify_event *ev = (const struct inotify_event *) p;
+		handleEvent (ev);
+		p += sizeof (struct inotify_event) + ev->len;
+	}
+}
+
+/*
+ *  Updating the tag file
+ */
+typedef struct sDropSet {
+	hashTable *files;			/* tag paths of removed or changed files */
+	stringList *dirs;			/* tag paths of changed directories + "/" */
+	bool all;
+} dropSet;
+
+static bool addToDropSet (const void *key, void *value, void *user_data)
+{
+	const char *name = key;
+	dropSet *drops = user_data;
+	vString *tagPath = newInputFileTagPath (name);
+	vString *escaped = vStringNew ();
+
+	vStringCatSWithEscaping (escaped, vStringValue (tagPath));
+	if (HT_PTR_TO_UINT (value) & CHANGE_DIRECTORY)
+	{
+		if (strcmp (name, ".") == 0 || vStringIsEmpty (escaped)
+			|| strcmp (vStringValue (escaped), ".") == 0)
+			drops->all = true;
+		vStringPut (escaped, '/');
+		stringListAdd (drops->dirs, escaped);
+	}
+	else
+	{
+		/* hashTableHasItem () cannot find an item having NULL as its value. */
+		char *file = vStringDeleteUnwrap (escaped);
+		hashTablePutItem (drops->files, file, file);
+	}
+
+	vStringDelete (tagPath);
+	return true;
+}
+
+static bool shouldDropLine (char *line, dropSet *drops)
+{
+	if (line[0] == '!' && line[1] == '_')
+		return false;			/* pseudo tag */
+	if (drops->all)
+		return true;
+
+	char *field = strchr (line, '\t');
+	if (field == NULL)
+		return false;
+	field++;
+	char *end = strchr (field, '\t');
+	if (end == NULL)
+		return false;
+
+	bool drop = false;
+	*end = '\0';
+	if (hashTableHasItem (drops->files, field))
+		drop = true;
+	for (unsigned int i = 0; i < stringListCount (drops->dirs) && !drop; i++)
+	{
+		vString *dir = stringListItem (drops->dirs, i);
+		drop = (strncmp (field, vStringValue (dir), vStringLength (dir)) == 0);
+	}
+	*end = '\t';
+
+	return drop;
+}
+
+/*  Copy the tag file to TEMPNAME, dropping the tags for the changed
+ *  entries.
+ */
+static FILE *copyTagFileDropping (char *tempName, dropSet *drops)
+{
+	int fd = mkstemp (tempName);
+	if (fd < 0)
+	{
+		error (WARNING | PERROR, "cannot make a temporary file \"%s\"", tempName);
+		return NULL;
+	}
+
+	FILE *out = fdopen (fd, "w");
+	FILE *in = fopen (Option.tagFileName, "r");
+	struct stat st;
+
+	if (in && fstat (fileno (in), &st) == 0)
+		fchmod (fd, st.st_mode & 07777);
+
+	if (in)
+	{
+		char *line = NULL;
+		size_t size = 0;
+		ssize_t len;
+
+		while ((len = getline (&line, &size, in)) != -1)
+			if (! shouldDropLine (line, drops))
+				fwrite (line, 1, len, out);
+		free (line);
+		fclose (in);
+	}
+	return out;
+}
+
+static bool reparseIfExists (const void *key, void *value, void *user_data)
+{
+	watchCreateTagsFunc createTags = user_data;
+	const char *name = key;
+
+	if ((HT_PTR_TO_UINT (value) & CHANGE_REPARSE) && doesFileExist (name))
+		createTags (name);
+	return true;
+}
+
+static void updateTagFile (watchCreateTagsFunc createTags)
+{
+	dropSet drops = {
+		.files = hashTableNew (127, hashCstrhash, hashCstreq, eFree, NULL),
+		.dirs  = stringListNew (),
+		.all   = false,
+	};
+
+	verbose ("updating the tag file for %u changed entries\n",
+			 hashTableCountItem (changes));
+	hashTableForeachItem (changes, addToDropSet, &drops);
+
+	vString *tempName = vStringNewInit (Option.tagFileName);
+	vStringCatS (tempName, TEMP_FILE_SUFFIX);
+
+	FILE *out = copyTagFileDropping (vStringValue (tempName), &drops);
+	if (out == NULL)
+		goto out;
+	if (fclose (out) != 0)
+	{
+		error (WARNING | PERROR, "cannot write \"%s\"", vStringValue (tempName));
+		unlink (vStringValue (tempName));
+		goto out;
+	}
+
+	/* Append the tags for the changed files to the copy, and let
+	 * closeTagFile () sort it. */
+	char *tagFileName = Option.tagFileName;
+	bool append = Option.append;
+	Option.tagFileName = vStringValue (tempName);
+	Option.append = true;
+	openTagFile ();
+	/* The inputs seen before may have changed. */
+	dedupResetInputs ();
+	hashTableForeachItem (changes, reparseIfExists, createTags);
+	closeTagFile (false);
+	Option.tagFileName = tagFileName;
+	Option.append = append;
+
+	if (rename (vStringValue (tempName), tagFileName) != 0)
+	{
+		error (WARNING | PERROR, "cannot replace \"%s\"", tagFileName);
+		unlink (vStringValue (tempName));
+	}
+
+ out:
+	hashTableClear (changes);
+	vStringDelete (tempName);
+	stringListDelete (drops.dirs);
+	hashTableDelete (drops.files);
+}
+
+static void requestStop (int signum CTAGS_ATTR_UNUSED)
+{
+	stopRequested = 1;
+}
+
+static long elapsedMsec (const struct timespec *const since)
+{
+	struct timespec now;
+
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - since->tv_sec) * 1000
+		+ (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+extern void watchTagFile (watchCreateTagsFunc createTags)
+{
+	struct sigaction sa;
+	struct pollfd pfd;
+	struct timespec firstChange = { 0, 0 };
+
+	if (inotifyFd < 0)
+	{
+		error (WARNING, "no directory to watch");
+		return;
+	}
+
+	tagFileAbsName = absoluteFilename (Option.tagFileName);
+	changes = hashTableNew (127, hashCstrhash, hashCstreq, eFree, NULL);
+
+	memset (&sa, 0, sizeof (sa));
+	sa.sa_handler = requestStop;
+	sigemptyset (&sa.sa_mask);
+	/* No SA_RESTART; poll () must return when a signal arrives. */
+	sigaction (SIGINT, &sa, NULL);
+	sigaction (SIGTERM, &sa, NULL);
+
+	pfd.fd = inotifyFd;
+	pfd.events = POLLIN;
+
+	verbose ("waiting for changes\n");
+	while (! stopRequested)
+	{
+		bool pending = hashTableCountItem (changes) > 0;
+		int timeout = -1;
+
+		if (pending)
+		{
+			long left = MAX_DELAY_MSEC - elapsedMsec (&firstChange);
+			timeout = (left < 0)? 0: (left < QUIET_PERIOD_MSEC)? left: QUIET_PERIOD_MSEC;
+		}
+
+		int r = poll (&pfd, 1, timeout);
+		if (r < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			error (FATAL | PERROR, "failed in poll");
+		}
+		else if (r > 0)
+		{
+			readEvents ();
+			if (! pending && hashTableCountItem (changes) > 0)
+				clock_gettime (CLOCK_MONOTONIC, &firstChange);
+		}
+
+		if (hashTableCountItem (changes) > 0
+			&& (r == 0 || elapsedMsec (&firstChange) >= MAX_DELAY_MSEC))
+			updateTagFile (createTags);
+	}
+
+	if (hashTableCountItem (changes) > 0)
+		updateTagFile (createTags);
+
+	close (inotifyFd);
+	inotifyFd = -1;
+	hashTableDelete (watchedDirs);
+	hashTableDelete (changes);
+	eFree (tagFileAbsName);
+}
+
+#else  /* HAVE_SYS_INOTIFY_H */
+
+extern void watchDirectory (const char *const dirName CTAGS_ATTR_UNUSED)
+{
+}
+
+extern void watchTagFile (watchCreateTagsFunc createTags CTAGS_ATTR_UNUSED)
+{
+	error (FATAL, "--watch is not supported on this platform");
+}
+
+#endif	/* HAVE_SYS_INOTIFY_H */
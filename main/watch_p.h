@@ -0,0 +1,34 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Defines interface to the watch mode keeping a tag file up to date.
+*/
+#ifndef CTAGS_MAIN_WATCH_PRIVATE_H
+#define CTAGS_MAIN_WATCH_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef bool (* watchCreateTagsFunc) (const char *const entryName);
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Called for each directory visited while recursing. */
+extern void watchDirectory (const char *const dirName);
+
+/* Wait for changes in the watched directories, and update the tag file
+ * by running CREATETAGS on the changed entries. Never returns unless
+ * the process is interrupted. */
+extern void watchTagFile (watchCreateTagsFunc createTags);
+
+#endif  /* CTAGS_MAIN_WATCH_PRIVATE_H */
@@ -0,0 +1,594 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module writes tags in the binary tag stream format
+*   (--output-format=binary). See docs/output-binary.rst for the layout.
+*/
+
+#include "general.h"  /* must always come first */
+
+#include "debug.h"
+#include "entry_p.h"
+#include "field_p.h"
+#include "htable.h"
+#include "kind.h"
+#include "mio.h"
+#include "numarray.h"
+#include "options_p.h"
+#include "parse_p.h"
+#include "ptag_p.h"
+#include "ptrarray.h"
+#include "routines.h"
+#include "trashbox.h"
+#include "vstring.h"
+#include "writer_p.h"
+#include "xtag_p.h"
+
+#include <string.h>
+
+/*
+*   MACROS
+*/
+#define BINARY_WRITER_VERSION 1
+#define BINARY_TAGS_FILE "tags"
+
+/* Record types */
+#define REC_STRING 'S'
+#define REC_FIELD  'F'
+#define REC_KIND   'K'
+#define REC_PTAG   'P'
+#define REC_TAG    'T'
+
+/* Header flags: how the text writer would have presented the values
+ * the stream carries natively. */
+#define FLAG_KIND_LETTER (1 << 0)
+#define FLAG_KIND_LONG   (1 << 1)
+#define FLAG_SCOPE_KEY   (1 << 2)
+#define FLAG_COMBINE     (1 << 3)
+
+/* How the value of a field is encoded in a tag record */
+typedef enum eFieldEncoding {
+	ENC_STRING,		/* string reference */
+	ENC_INTEGER,	/* varint */
+	ENC_PRESENCE,	/* nothing; having the field is the value */
+	ENC_ROLES,		/* varint of role bits of the kind */
+	ENC_SCOPE,		/* string references for the scope kind and the scope */
+} fieldEncoding;
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/* Definitions (strings, kinds, and fields) are written lazily, right
+ * before the first record referring to them. Each definition remembers
+ * how many records had been written before it, its stamp, so the ones
+ * written after the tag file position restored on a rescan can be
+ * forgotten. */
+struct kindDef {
+	langType lang;
+	int kindIndex;
+	unsigned long stamp;
+};
+
+static struct binaryWriterState {
+	bool initialized;
+	bool headerWritten;
+	unsigned long records;
+
+	hashTable *strings;			/* string -> id */
+	ptrArray *stringList;		/* id - 1 -> string */
+	ulongArray *stringStamps;	/* id - 1 -> stamp */
+
+	ptrArray *kinds;			/* id - 1 -> struct kindDef */
+	unsigned int langCount;
+	unsigned int *kindSlotCounts;	/* lang -> length of kindIds [lang] */
+	unsigned int **kindIds;		/* lang -> kindIndex - KIND_FILE_INDEX -> id */
+
+	unsigned int fieldCount;
+	unsigned long *fieldStamps;	/* fieldType -> stamp + 1, or 0 */
+
+	vString *defs;
+	vString *record;
+	vString *fields;
+} State;
+
+/* Which fields are put to a tag record, in which order. Same as
+ * the order of the ctags writer. */
+static struct binaryPlan {
+	bool compiled;
+	unsigned int generation;
+	unsigned int flags;
+	unsigned int count;
+	fieldType ftypes [FIELD_BUILTIN_LAST + 1];
+} Plan;
+
+static int writeBinaryEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+							 MIO * mio, const tagEntryInfo *const tag,
+							 void *clientData);
+static int writeBinaryPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+								 MIO * mio, const ptagDesc *desc,
+								 const char *const fileName,
+								 const char *const pattern,
+								 const char *const parserName,
+								 void *clientData);
+static void rescanFailedBinaryEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+									 unsigned long validTagNum,
+									 void *clientData);
+tagWriter binaryWriter = {
+	.writeEntry = writeBinaryEntry,
+	.writePtagEntry = writeBinaryPtagEntry,
+	.printPtagByDefault = true,
+	.preWriteEntry = NULL,
+	.postWriteEntry = NULL,
+	.rescanFailedEntry = rescanFailedBinaryEntry,
+	.treatFieldAsFixed = NULL,
+	.defaultFileName = BINARY_TAGS_FILE,
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+/* vStringPut () cannot put '\0'. */
+static void putByte (vString *buf, unsigned char c)
+{
+	vStringNCatSUnsafe (buf, (const char *) &c, 1);
+}
+
+static void putVarint (vString *buf, uint64_t n)
+{
+	unsigned char bytes [10];
+	size_t len = 0;
+
+	while (n >= 0x80)
+	{
+		bytes [len++] = (unsigned char) ((n & 0x7f) | 0x80);
+		n >>= 7;
+	}
+	bytes [len++] = (unsigned char) n;
+	vStringNCatSUnsafe (buf, (const char *) bytes, len);
+}
+
+static void freeState (void *state CTAGS_ATTR_UNUSED)
+{
+	hashTableDelete (State.strings);
+	ptrArrayDelete (State.stringList);
+	ulongArrayDelete (State.stringStamps);
+	ptrArrayDelete (State.kinds);
+	for (unsigned int i = 0; i < State.langCount; i++)
+	{
+		if (State.kindIds [i])
+			eFree (State.kindIds [i]);
+	}
+	eFree (State.kindIds);
+	eFree (State.kindSlotCounts);
+	if (State.fieldStamps)
+		eFree (State.fieldStamps);
+	vStringDelete (State.defs);
+	vStringDelete (State.record);
+	vStringDelete (State.fields);
+	memset (&State, 0, sizeof (State));
+}
+
+static void initState (void)
+{
+	if (State.initialized)
+		return;
+
+	State.strings = hashTableNew (1021, hashCstrhash, hashCstreq, eFree, NULL);
+	State.stringList = ptrArrayNew (NULL);
+	State.stringStamps = ulongArrayNew ();
+	State.kinds = ptrArrayNew (eFree);
+	State.langCount = countParsers ();
+	State.kindSlotCounts = xCalloc (State.langCount, unsigned int);
+	State.kindIds = xCalloc (State.langCount, unsigned int *);
+	State.defs = vStringNew ();
+	State.record = vStringNew ();
+	State.fields = vStringNew ();
+	State.initialized = true;
+	DEFAULT_TRASH_BOX (&State, freeState);
+}
+
+/* Return the id of STR, putting a string record to State.defs if
+ * STR is new. NULL is represented by 0. */
+static unsigned int internString (const char *str)
+{
+	if (str == NULL)
+		return 0;
+
+	void *id = hashTableGetItem (State.strings, str);
+	if (id)
+		return (unsigned int) HT_PTR_TO_INT (id);
+
+	char *key = eStrdup (str);
+	size_t len = strlen (str);
+	unsigned int n = ptrArrayAdd (State.stringList, key) + 1;
+	ulongArrayAdd (State.stringStamps, State.records);
+	hashTablePutItem (State.strings, key, HT_INT_TO_PTR (n));
+
+	vStringPut (State.defs, REC_STRING);
+	putVarint (State.defs, len);
+	vStringNCatSUnsafe (State.defs, str, len);
+	return n;
+}
+
+static void putString (vString *buf, const char *str)
+{
+	putVarint (buf, internString (str));
+}
+
+static fieldEncoding getFieldEncoding (fieldType ftype)
+{
+	switch (ftype)
+	{
+	case FIELD_LINE_NUMBER:
+	case FIELD_FILE_SCOPE:
+		return ENC_PRESENCE;
+	case FIELD_ROLES:
+		return ENC_ROLES;
+	case FIELD_SCOPE:
+		return ENC_SCOPE;
+	default:
+		break;
+	}
+
+	unsigned int dt = getFieldDataType (ftype);
+	if (dt == FIELDTYPE_INTEGER)
+		return ENC_INTEGER;
+	else if (dt == FIELDTYPE_BOOL)
+		return ENC_PRESENCE;
+	return ENC_STRING;
+}
+
+static void defineFieldMaybe (fieldType ftype)
+{
+	if ((unsigned int) ftype >= State.fieldCount)
+	{
+		unsigned int n = countFields ();
+		State.fieldStamps = xRealloc (State.fieldStamps, n, unsigned long);
+		memset (State.fieldStamps + State.fieldCount, 0,
+				sizeof (unsigned long) * (n - State.fieldCount));
+		State.fieldCount = n;
+	}
+
+	if (State.fieldStamps [ftype])
+		return;
+
+	/* The name must be in the string table before the record refers it. */
+	unsigned int name = internString (getFieldName (ftype));
+	vStringPut (State.defs, REC_FIELD);
+	putVarint (State.defs, ftype);
+	putVarint (State.defs, name);
+	putVarint (State.defs, getFieldEncoding (ftype));
+	State.fieldStamps [ftype] = State.records + 1;
+}
+
+static unsigned int defineKindMaybe (langType lang, int kindIndex)
+{
+	Assert (lang >= 0);
+
+	if ((unsigned int) lang >= State.langCount)
+	{
+		unsigned int n = countParsers ();
+		State.kindSlotCounts = xRealloc (State.kindSlotCounts, n, unsigned int);
+		State.kindIds = xRealloc (State.kindIds, n, unsigned int *);
+		for (unsigned int i = State.langCount; i < n; i++)
+		{
+			State.kindSlotCounts [i] = 0;
+			State.kindIds [i] = NULL;
+		}
+		State.langCount = n;
+	}
+
+	unsigned int slot = (unsigned int) (kindIndex - KIND_FILE_INDEX);
+	if (slot >= State.kindSlotCounts [lang])
+	{
+		unsigned int n = countLanguageKinds (lang) - KIND_FILE_INDEX;
+		if (n <= slot)
+			n = slot + 1;
+		State.kindIds [lang] = xRealloc (State.kindIds [lang], n, unsigned int);
+		memset (State.kindIds [lang] + State.kindSlotCounts [lang], 0,
+				sizeof (unsigned int) * (n - State.kindSlotCounts [lang]));
+		State.kindSlotCounts [lang] = n;
+	}
+
+	if (State.kindIds [lang][slot])
+		return State.kindIds [lang][slot];
+
+	kindDefinition *kdef = getLanguageKind (lang, kindIndex);
+	unsigned int roleCount = (kindIndex >= 0)? countLanguageRoles (lang, kindIndex): 0;
+
+	unsigned int langName = internString (getLanguageName (lang));
+	unsigned int kindName = internString (kdef->name);
+	unsigned int *roleNames = roleCount? xMalloc (roleCount, unsigned int): NULL;
+	for (unsigned int i = 0; i < roleCount; i++)
+		roleNames [i] = internString (getLanguageRole (lang, kindIndex, i)->name);
+
+	vStringPut (State.defs, REC_KIND);
+	putVarint (State.defs, langName);
+	putByte (State.defs, kdef->letter);
+	putVarint (State.defs, kindName);
+	putVarint (State.defs, roleCount);
+	for (unsigned int i = 0; i < roleCount; i++)
+		putVarint (State.defs, roleNames [i]);
+	if (roleNames)
+		eFree (roleNames);
+
+	struct kindDef *def = xMalloc (1, struct kindDef);
+	def->lang = lang;
+	def->kindIndex = kindIndex;
+	def->stamp = State.records;
+	State.kindIds [lang][slot] = ptrArrayAdd (State.kinds, def) + 1;
+	return State.kindIds [lang][slot];
+}
+
+static void compilePlan (void)
+{
+	Plan.count = 0;
+	Plan.flags = 0;
+
+	if (isFieldEnabled (FIELD_KIND))
+		Plan.flags |= FLAG_KIND_LETTER;
+	if (isFieldEnabled (FIELD_KIND_LONG))
+		Plan.flags |= FLAG_KIND_LONG;
+	if (isFieldEnabled (FIELD_SCOPE_KEY))
+		Plan.flags |= FLAG_SCOPE_KEY;
+	if (Option.locate == EX_COMBINE)
+		Plan.flags |= FLAG_COMBINE;
+
+	int f[] = { FIELD_LINE_NUMBER,
+				FIELD_LANGUAGE,
+				FIELD_SCOPE,
+				FIELD_TYPE_REF,
+				FIELD_FILE_SCOPE,
+				-1 };
+	for (unsigned int i = 0; f[i] >= 0; i++)
+		if (isFieldEnabled (f[i]))
+			Plan.ftypes [Plan.count++] = f[i];
+
+	for (int k = FIELD_ECTAGS_LOOP_START; k <= FIELD_ECTAGS_LOOP_LAST; k++)
+		if (isFieldEnabled (k))
+			Plan.ftypes [Plan.count++] = k;
+	for (int k = FIELD_UCTAGS_LOOP_START; k <= FIELD_BUILTIN_LAST; k++)
+		if (isFieldEnabled (k))
+			Plan.ftypes [Plan.count++] = k;
+
+	Plan.generation = getFieldStateGeneration ();
+	Plan.compiled = true;
+}
+
+static void writeHeaderMaybe (MIO *mio)
+{
+	if (State.headerWritten)
+		return;
+
+	vString *header = State.defs;
+	vStringNCatSUnsafe (header, BINARY_TAGS_MAGIC, BINARY_TAGS_MAGIC_LENGTH);
+	putVarint (header, BINARY_WRITER_VERSION);
+	putVarint (header, Plan.flags);
+	mio_write (mio, vStringValue (header), 1, vStringLength (header));
+	vStringClear (header);
+	State.headerWritten = true;
+}
+
+static const char* renderFieldValueRaw (const tagEntryInfo * tag, fieldType ftype, int fieldIndex)
+{
+	if (doesFieldHaveRenderer (ftype, true))
+		return renderFieldNoEscaping (ftype, tag, fieldIndex);
+	return renderField (ftype, tag, fieldIndex);
+}
+
+/* Put a field id and its value to State.fields. Return false if
+ * the tag has no value for the field. */
+static bool putField (const tagEntryInfo *const tag, fieldType ftype, int fieldIndex)
+{
+	const char *str;
+	const char *kind;
+	unsigned int k;
+	long n;
+	roleBitsType bits;
+
+	if (fieldIndex == NO_PARSER_FIELD && !doesFieldHaveValue (ftype, tag))
+		return false;
+
+	defineFieldMaybe (ftype);
+
+	switch (getFieldEncoding (ftype))
+	{
+	case ENC_STRING:
+		str = renderFieldValueRaw (tag, ftype, fieldIndex);
+		if (str == NULL)
+			return false;
+		putVarint (State.fields, ftype);
+		putString (State.fields, str);
+		break;
+	case ENC_INTEGER:
+		str = renderFieldValueRaw (tag, ftype, fieldIndex);
+		if (str == NULL || !strToLong (str, 10, &n) || n < 0)
+			return false;
+		putVarint (State.fields, ftype);
+		putVarint (State.fields, (uint64_t) n);
+		break;
+	case ENC_PRESENCE:
+		putVarint (State.fields, ftype);
+		break;
+	case ENC_ROLES:
+		bits = 0;
+		if (tag->kindIndex >= 0)
+		{
+			int roleCount = countLanguageRoles (tag->langType, tag->kindIndex);
+			for (int i = 0; i < roleCount; i++)
+				if (((tag->extensionFields.roleBits >> i) & (roleBitsType)1)
+					&& isLanguageRoleEnabled (tag->langType, tag->kindIndex, i))
+					bits |= makeRoleBit (i);
+		}
+		putVarint (State.fields, ftype);
+		putVarint (State.fields, bits);
+		break;
+	case ENC_SCOPE:
+		/* renderField () may return a buffer shared between calls;
+		 * intern the kind before rendering the scope. */
+		kind = renderFieldValueRaw (tag, FIELD_SCOPE_KIND_LONG, NO_PARSER_FIELD);
+		if (kind == NULL)
+			return false;
+		k = internString (kind);
+		str = renderFieldValueRaw (tag, FIELD_SCOPE, NO_PARSER_FIELD);
+		if (str == NULL)
+			return false;
+		putVarint (State.fields, ftype);
+		putVarint (State.fields, k);
+		putString (State.fields, str);
+		break;
+	}
+	return true;
+}
+
+static int flushRecord (MIO *mio)
+{
+	int length = 0;
+
+	if (vStringLength (State.defs) > 0)
+	{
+		length += mio_write (mio, vStringValue (State.defs), 1, vStringLength (State.defs));
+		vStringClear (State.defs);
+	}
+	length += mio_write (mio, vStringValue (State.record), 1, vStringLength (State.record));
+	vStringClear (State.record);
+	State.records++;
+
+	return length;
+}
+
+static void prepareWriting (MIO *mio)
+{
+	initState ();
+	if (!Plan.compiled || Plan.generation != getFieldStateGeneration ())
+		compilePlan ();
+	writeHeaderMaybe (mio);
+}
+
+static int writeBinaryEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+							 MIO * mio, const tagEntryInfo *const tag,
+							 void *clientData CTAGS_ATTR_UNUSED)
+{
+	prepareWriting (mio);
+
+	vString *rec = State.record;
+	vStringPut (rec, REC_TAG);
+	/* renderField () returns a buffer shared between calls; intern each
+	 * value before rendering the next one. */
+	putString (rec, renderFieldValueRaw (tag, FIELD_NAME, NO_PARSER_FIELD));
+	putString (rec, renderFieldValueRaw (tag, FIELD_INPUT_FILE, NO_PARSER_FIELD));
+	putString (rec, tag->lineNumberEntry
+			   ? NULL
+			   : renderField (FIELD_PATTERN, tag, NO_PARSER_FIELD));
+	putVarint (rec, tag->lineNumber);
+
+	/* The count of the fields precedes them. */
+	unsigned int nfields = 0;
+	if (!includeExtensionFlags ())
+		putVarint (rec, 0);
+	else
+	{
+		putVarint (rec, defineKindMaybe (tag->langType, tag->kindIndex));
+		for (unsigned int i = 0; i < Plan.count; i++)
+			nfields += putField (tag, Plan.ftypes [i], NO_PARSER_FIELD);
+
+		for (unsigned int i = 0; i < tag->usedParserFields; i++)
+		{
+			const tagField *f = getParserFieldForIndex (tag, i);
+			if (isFieldEnabled (f->ftype))
+				nfields += putField (tag, f->ftype, i);
+		}
+	}
+
+	putVarint (rec, nfields);
+	vStringCat (rec, State.fields);
+	vStringClear (State.fields);
+
+	return flushRecord (mio);
+}
+
+static int writeBinaryPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+								 MIO * mio, const ptagDesc *desc,
+								 const char *const fileName,
+								 const char *const pattern,
+								 const char *const parserName,
+								 void *clientData CTAGS_ATTR_UNUSED)
+{
+	prepareWriting (mio);
+
+	vString *name = vStringNewInit (PSEUDO_TAG_PREFIX);
+	vStringCatS (name, desc->name);
+	if (parserName)
+	{
+		vStringCatS (name, PSEUDO_TAG_SEPARATOR);
+		vStringCatS (name, parserName);
+	}
+
+	/* Stored as the ctags writer prints it, like the pattern of a tag. */
+	vString *vpattern = vStringNewInit ("/");
+	if (pattern)
+		vStringCatSWithEscapingAsPattern (vpattern, pattern);
+	vStringPut (vpattern, '/');
+
+	vString *rec = State.record;
+	vStringPut (rec, REC_PTAG);
+	putString (rec, vStringValue (name));
+	putString (rec, fileName? fileName: "");
+	putString (rec, vStringValue (vpattern));
+	vStringDelete (vpattern);
+	vStringDelete (name);
+
+	if (includeExtensionFlags () && isFieldEnabled (FIELD_EXTRAS))
+	{
+		defineFieldMaybe (FIELD_EXTRAS);
+		putVarint (rec, 1);
+		putVarint (rec, FIELD_EXTRAS);
+		putString (rec, getXtagName (XTAG_PSEUDO_TAGS));
+	}
+	else
+		putVarint (rec, 0);
+
+	return flushRecord (mio);
+}
+
+static void rescanFailedBinaryEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+									 unsigned long validTagNum,
+									 void *clientData CTAGS_ATTR_UNUSED)
+{
+	if (!State.initialized)
+		return;
+
+	while (!ulongArrayIsEmpty (State.stringStamps)
+		   && ulongArrayLast (State.stringStamps) >= validTagNum)
+	{
+		char *key = ptrArrayRemoveLast (State.stringList);
+		ulongArrayRemoveLast (State.stringStamps);
+		hashTableDeleteItem (State.strings, key);
+	}
+
+	while (ptrArrayCount (State.kinds) > 0)
+	{
+		struct kindDef *def = ptrArrayLast (State.kinds);
+		if (def->stamp < validTagNum)
+			break;
+		State.kindIds [def->lang][def->kindIndex - KIND_FILE_INDEX] = 0;
+		ptrArrayDeleteLast (State.kinds);
+	}
+
+	for (unsigned int i = 0; i < State.fieldCount; i++)
+		if (State.fieldStamps [i] > validTagNum)
+			State.fieldStamps [i] = 0;
+
+	if (validTagNum == 0)
+		State.headerWritten = false;
+
+	vStringClear (State.defs);
+	vStringClear (State.record);
+	vStringClear (State.fields);
+	State.records = validTagNum;
+}
@@ -17,6 +17,9 @@
 #include "parse_p.h"
 #include "ptag_p.h"
 #include "read.h"
+#include "routines.h"
+#include "trashbox.h"
+#include "vstring.h"
 #include "writer_p.h"
 #include "xtag.h"
 #include "xtag_p.h"
@@ -37,6 +40,9 @@ static int writeCtagsPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
 								void *clientData);
 static bool treatFieldAsFixed (int fieldType);
 static void checkCtagsOptions (tagWriter *writer, bool fieldsWereReset);
+static int rewriteCtagsInputEntry (tagWriter *writer, MIO * mio,
+								   const char *const line, size_t length,
+								   const tagEntryInfo *const tag);
 
 #ifdef _WIN32
 static enum filenameSepOp overrideFilenameSeparator (enum filenameSepOp currentSetting);
@@ -55,6 +61,7 @@ tagWriter uCtagsWriter = {
 	.rescanFailedEntry = NULL,
 	.treatFieldAsFixed = treatFieldAsFixed,
 	.checkOptions = checkCtagsOptions,
+	.rewriteInputEntry = rewriteCtagsInputEntry,
 #ifdef _WIN32
 	.overrideFilenameSeparator = overrideFilenameSeparator,
 #endif
@@ -97,6 +104,7 @@ tagWriter eCtagsWriter = {
 	.treatFieldAsFixed = treatFieldAsFixed,
 	.defaultFileName = CTAGS_FILE,
 	.checkOptions = checkCtagsOptions,
+	.rewriteInputEntry = rewriteCtagsInputEntry,
 };
 
 static bool hasTagEntryTabOrNewlineChar (const tagEntryInfo * const tag)
@@ -182,19 +190,171 @@ static const char* escapeFieldValue (tagWriter *writer, const tagEntryInfo * tag
 	return escapeFieldValueFull (writer, tag, ftype, NO_PARSER_FIELD);
 }
 
-static int renderExtensionFieldMaybe (tagWriter *writer, int xftype, const tagEntryInfo *const tag, char sep[2], MIO *mio)
+/*
+ * Render plan
+ *
+ * Which extension fields are printed, in which order, and with which
+ * "\tKEY:" prefix depends only on the --fields and --fields-<LANG>
+ * options. The plan compiles that into a flat array of operations
+ * once, instead of asking isFieldEnabled () for every field of every
+ * tag. The plan is rebuilt when the state of fields changes.
+ */
+typedef enum eFieldRenderOpType {
+	FOP_KIND,
+	FOP_LINE,
+	FOP_SCOPE,
+	FOP_FILE_SCOPE,
+	FOP_GENERIC,
+} fieldRenderOpType;
+
+typedef struct sFieldRenderOp {
+	fieldRenderOpType type;
+	fieldType ftype;
+	vString *prefix;
+} fieldRenderOp;
+
+static struct renderPlan {
+	bool compiled;
+	unsigned int generation;
+	bool putFieldPrefix;
+
+	bool kindLong;
+	bool kind;
+
+	unsigned int count;
+	fieldRenderOp ops [FIELD_BUILTIN_LAST + 1];
+
+	/* Indexed by fieldType. NULL if the field is disabled. */
+	unsigned int parserFieldCount;
+	vString **parserFieldPrefixes;
+} Plan;
+
+static vString *makeFieldPrefix (vString *prefix, const char *key)
 {
-	if (isFieldEnabled (xftype) && doesFieldHaveValue (xftype, tag))
+	prefix = vStringNewOrClear (prefix);
+	vStringPut (prefix, '\t');
+	vStringCatS (prefix, key);
+	vStringPut (prefix, ':');
+	return prefix;
+}
+
+static void addRenderOp (fieldRenderOpType type, fieldType ftype, const char *key)
+{
+	fieldRenderOp *op = Plan.ops + Plan.count++;
+
+	op->type = type;
+	op->ftype = ftype;
+	if (key)
+		op->prefix = makeFieldPrefix (op->prefix, key);
+	else
 	{
-		int len;
-		len = mio_printf (mio, "%s\t%s:%s", sep,
-				  getFieldName (xftype),
-				  escapeFieldValue (writer, tag, xftype));
-		sep[0] = '\0';
-		return len;
+		op->prefix = vStringNewOrClear (op->prefix);
+		vStringPut (op->prefix, '\t');
 	}
-	else
-		return 0;
+}
+
+static void compileRenderPlan (void)
+{
+	Plan.count = 0;
+
+	Plan.kindLong = isFieldEnabled (FIELD_KIND_LONG);
+	Plan.kind = isFieldEnabled (FIELD_KIND);
+	if (Plan.kindLong || Plan.kind)
+		addRenderOp (FOP_KIND, FIELD_KIND,
+					 isFieldEnabled (FIELD_KIND_KEY)? getFieldName (FIELD_KIND_KEY): NULL);
+
+	if (isFieldEnabled (FIELD_LINE_NUMBER))
+		addRenderOp (FOP_LINE, FIELD_LINE_NUMBER, getFieldName (FIELD_LINE_NUMBER));
+
+	if (isFieldEnabled (FIELD_LANGUAGE))
+		addRenderOp (FOP_GENERIC, FIELD_LANGUAGE, getFieldName (FIELD_LANGUAGE));
+
+	if (isFieldEnabled (FIELD_SCOPE))
+		addRenderOp (FOP_SCOPE, FIELD_SCOPE,
+					 isFieldEnabled (FIELD_SCOPE_KEY)? getFieldName (FIELD_SCOPE_KEY): NULL);
+
+	if (isFieldEnabled (FIELD_TYPE_REF))
+		addRenderOp (FOP_GENERIC, FIELD_TYPE_REF, getFieldName (FIELD_TYPE_REF));
+
+	if (isFieldEnabled (FIELD_FILE_SCOPE))
+		addRenderOp (FOP_FILE_SCOPE, FIELD_FILE_SCOPE, getFieldName (FIELD_FILE_SCOPE));
+
+	for (int k = FIELD_ECTAGS_LOOP_START; k <= FIELD_ECTAGS_LOOP_LAST; k++)
+		if (isFieldEnabled (k))
+			addRenderOp (FOP_GENERIC, k, getFieldName (k));
+	for (int k = FIELD_UCTAGS_LOOP_START; k <= FIELD_BUILTIN_LAST; k++)
+		if (isFieldEnabled (k))
+			addRenderOp (FOP_GENERIC, k, getFieldName (k));
+
+	unsigned int n = countFields ();
+	if (n > Plan.parserFieldCount)
+	{
+		Plan.parserFieldPrefixes = xRealloc (Plan.parserFieldPrefixes, n, vString *);
+		memset (Plan.parserFieldPrefixes + Plan.parserFieldCount, 0,
+				sizeof (vString *) * (n - Plan.parserFieldCount));
+		Plan.parserFieldCount = n;
+	}
+	for (unsigned int i = FIELD_BUILTIN_LAST + 1; i < n; i++)
+	{
+		if (isFieldEnabled (i))
+			Plan.parserFieldPrefixes [i] = makeFieldPrefix (Plan.parserFieldPrefixes [i],
+															getFieldName (i));
+		else if (Plan.parserFieldPrefixes [i])
+		{
+			vStringDelete (Plan.parserFieldPrefixes [i]);
+			Plan.parserFieldPrefixes [i] = NULL;
+		}
+	}
+
+	Plan.generation = getFieldStateGeneration ();
+	Plan.putFieldPrefix = Option.putFieldPrefix;
+	Plan.compiled = true;
+}
+
+static void freeRenderPlan (void *plan CTAGS_ATTR_UNUSED)
+{
+	for (unsigned int i = 0; i < ARRAY_SIZE (Plan.ops); i++)
+		vStringDelete (Plan.ops [i].prefix);
+	for (unsigned int i = 0; i < Plan.parserFieldCount; i++)
+		vStringDelete (Plan.parserFieldPrefixes [i]);
+	eFree (Plan.parserFieldPrefixes);
+	memset (&Plan, 0, sizeof (Plan));
+}
+
+static void prepareRenderPlan (void)
+{
+	if (Plan.compiled
+		&& Plan.generation == getFieldStateGeneration ()
+		&& Plan.putFieldPrefix == Option.putFieldPrefix)
+		return;
+
+	if (!Plan.compiled)
+		DEFAULT_TRASH_BOX (&Plan, freeRenderPlan);
+	compileRenderPlan ();
+}
+
+static int writeVString (MIO *mio, const vString *v)
+{
+	return (int)mio_write (mio, vStringValue (v), 1, vStringLength (v));
+}
+
+static int writeString (MIO *mio, const char *s)
+{
+	size_t len = strlen (s);
+	return (int)mio_write (mio, s, 1, len);
+}
+
+static int writeULong (MIO *mio, unsigned long n)
+{
+	char buf [sizeof (unsigned long) * 3 + 1];
+	char *p = buf + sizeof (buf);
+
+	do
+	{
+		*--p = '0' + (n % 10);
+		n /= 10;
+	} while (n);
+	return (int)mio_write (mio, p, 1, buf + sizeof (buf) - p);
 }
 
 static int addParserFields (tagWriter *writer, MIO * mio, const tagEntryInfo *const tag)
@@ -206,12 +366,14 @@ static int addParserFields (tagWriter *writer, MIO * mio, const tagEntryInfo *co
 	{
 		const tagField *f = getParserFieldForIndex(tag, i);
 		fieldType ftype = f->ftype;
-		if (! isFieldEnabled (ftype))
+		vString *prefix = ((unsigned int)ftype < Plan.parserFieldCount)
+			? Plan.parserFieldPrefixes [ftype]
+			: NULL;
+		if (prefix == NULL)
 			continue;
 
-		length += mio_printf(mio, "\t%s:%s",
-							 getFieldName (ftype),
-							 escapeFieldValueFull (writer, tag, ftype, i));
+		length += writeVString (mio, prefix);
+		length += writeString (mio, escapeFieldValueFull (writer, tag, ftype, i));
 	}
 	return length;
 }
@@ -219,99 +381,110 @@ static int addParserFields (tagWriter *writer, MIO * mio, const tagEntryInfo *co
 static int writeLineNumberEntry (tagWriter *writer, MIO * mio, const tagEntryInfo *const tag)
 {
 	if (Option.lineDirectives)
-		return mio_printf (mio, "%s", escapeFieldValue (writer, tag, FIELD_LINE_NUMBER));
+		return writeString (mio, escapeFieldValue (writer, tag, FIELD_LINE_NUMBER));
 	else
-		return mio_printf (mio, "%lu", tag->lineNumber);
+		return writeULong (mio, tag->lineNumber);
 }
 
-static int addExtensionFields (tagWriter *writer, MIO *mio, const tagEntryInfo *const tag)
+static const char *getKindString (const tagEntryInfo *const tag, char kind_letter_str[2])
 {
-	bool isKindKeyEnabled = isFieldEnabled (FIELD_KIND_KEY);
-	bool isScopeEnabled = isFieldEnabled   (FIELD_SCOPE_KEY);
-
-	const char* const kindKey = isKindKeyEnabled
-		?getFieldName (FIELD_KIND_KEY)
-		:"";
-	const char* const kindFmt = isKindKeyEnabled
-		?"%s\t%s:%s"
-		:"%s\t%s%s";
-	const char* const scopeKey = isScopeEnabled
-		?getFieldName (FIELD_SCOPE_KEY)
-		:"";
-	const char* const scopeFmt = isScopeEnabled
-		?"%s\t%s:%s:%s"
-		:"%s\t%s%s:%s";
-
-	char sep [] = {';', '"', '\0'};
-	int length = 0;
-
-	const char *str = NULL;
 	kindDefinition *kdef = getLanguageKind(tag->langType, tag->kindIndex);
-	const char kind_letter_str[2] = {kdef->letter, '\0'};
 
-	if (kdef->name != NULL && (isFieldEnabled (FIELD_KIND_LONG)  ||
-		 (isFieldEnabled (FIELD_KIND)  && kdef->letter == KIND_NULL_LETTER)))
+	if (kdef->name != NULL && (Plan.kindLong  ||
+		 (Plan.kind  && kdef->letter == KIND_NULL_LETTER)))
 	{
 		/* Use kind long name */
-		str = kdef->name;
+		return kdef->name;
 	}
-	else if (kdef->letter != KIND_NULL_LETTER  && (isFieldEnabled (FIELD_KIND) ||
-			(isFieldEnabled (FIELD_KIND_LONG) &&  kdef->name == NULL)))
+	else if (kdef->letter != KIND_NULL_LETTER  && (Plan.kind ||
+			(Plan.kindLong &&  kdef->name == NULL)))
 	{
 		/* Use kind letter */
-		str = kind_letter_str;
+		kind_letter_str [0] = kdef->letter;
+		kind_letter_str [1] = '\0';
+		return kind_letter_str;
 	}
+	return NULL;
+}
 
-	if (str)
-	{
-		length += mio_printf (mio, kindFmt, sep, kindKey, str);
-		sep [0] = '\0';
-	}
+static int addExtensionFields (tagWriter *writer, MIO *mio, const tagEntryInfo *const tag)
+{
+	bool sep = true;
+	int length = 0;
 
-	if (isFieldEnabled (FIELD_LINE_NUMBER) &&  doesFieldHaveValue (FIELD_LINE_NUMBER, tag))
+	for (unsigned int i = 0; i < Plan.count; i++)
 	{
-		length += mio_printf (mio, "%s\t%s:%ld", sep,
-				   getFieldName (FIELD_LINE_NUMBER),
-				   tag->lineNumber);
-		sep [0] = '\0';
-	}
+		const fieldRenderOp *op = Plan.ops + i;
+		const char *str = NULL;
+		const char *k = NULL;
+		char kind_letter_str[2];
 
-	length += renderExtensionFieldMaybe (writer, FIELD_LANGUAGE, tag, sep, mio);
+		switch (op->type)
+		{
+		case FOP_KIND:
+			str = getKindString (tag, kind_letter_str);
+			break;
+		case FOP_SCOPE:
+			k = escapeFieldValue (writer, tag, FIELD_SCOPE_KIND_LONG);
+			str = k? escapeFieldValue (writer, tag, FIELD_SCOPE): NULL;
+			break;
+		case FOP_LINE:
+		case FOP_FILE_SCOPE:
+			if (!doesFieldHaveValue (op->ftype, tag))
+				continue;
+			str = "";
+			break;
+		case FOP_GENERIC:
+			if (doesFieldHaveValue (op->ftype, tag))
+				str = escapeFieldValue (writer, tag, op->ftype);
+			break;
+		}
+		if (str == NULL)
+			continue;
 
-	if (isFieldEnabled (FIELD_SCOPE))
-	{
-		const char* k, *v;
+		if (sep)
+		{
+			length += mio_write (mio, ";\"", 1, 2);
+			sep = false;
+		}
+		length += writeVString (mio, op->prefix);
 
-		k = escapeFieldValue (writer, tag, FIELD_SCOPE_KIND_LONG);
-		v = escapeFieldValue (writer, tag, FIELD_SCOPE);
-		if (k && v)
+		if (op->type == FOP_LINE)
+			length += writeULong (mio, tag->lineNumber);
+		else if (op->type == FOP_SCOPE)
 		{
-			length += mio_printf (mio, scopeFmt, sep, scopeKey, k, v);
-			sep [0] = '\0';
+			length += writeString (mio, k);
+			length += mio_putc (mio, ':') != EOF;
+			length += writeString (mio, str);
 		}
+		else
+			length += writeString (mio, str);
 	}
 
-	if (isFieldEnabled (FIELD_TYPE_REF) && doesFieldHaveValue (FIELD_TYPE_REF, tag))
-	{
-		length += mio_printf (mio, "%s\t%s:%s", sep,
-				      getFieldName (FIELD_TYPE_REF),
-				      escapeFieldValue (writer, tag, FIELD_TYPE_REF));
-		sep [0] = '\0';
-	}
+	return length;
+}
 
-	if (isFieldEnabled (FIELD_FILE_SCOPE) &&  doesFieldHaveValue (FIELD_FILE_SCOPE, tag))
-	{
-		length += mio_printf (mio, "%s\t%s:", sep,
-				      getFieldName (FIELD_FILE_SCOPE));
-		sep [0] = '\0';
-	}
+static int rewriteCtagsInputEntry (tagWriter *writer, MIO * mio,
+								   const char *const line, size_t length,
+								   const tagEntryInfo *const tag)
+{
+	const char *tab0, *tab1;
 
-	for (int k = FIELD_ECTAGS_LOOP_START; k <= FIELD_ECTAGS_LOOP_LAST; k++)
-		length += renderExtensionFieldMaybe (writer, k, tag, sep, mio);
-	for (int k = FIELD_UCTAGS_LOOP_START; k <= FIELD_BUILTIN_LAST; k++)
-		length += renderExtensionFieldMaybe (writer, k, tag, sep, mio);
+	/* Pseudo tags are written once for all inputs. */
+	if (length >= 2 && line[0] == '!' && line[1] == '_')
+		return 0;
 
-	return length;
+	tab0 = memchr (line, '\t', length);
+	if (tab0 == NULL)
+		return 0;
+	tab1 = memchr (tab0 + 1, '\t', length - (tab0 + 1 - line));
+	if (tab1 == NULL)
+		return 0;
+
+	int l = (int) mio_write (mio, line, 1, tab0 + 1 - line);
+	l += writeString (mio, escapeFieldValue (writer, tag, FIELD_INPUT_FILE));
+	l += (int) mio_write (mio, tab1, 1, length - (tab1 - line));
+	return l;
 }
 
 static int writeCtagsEntry (tagWriter *writer,
@@ -328,9 +501,10 @@ static int writeCtagsEntry (tagWriter *writer,
 		}
 	}
 
-	int length = mio_printf (mio, "%s\t%s\t",
-			      escapeFieldValue (writer, tag, FIELD_NAME),
-			      escapeFieldValue (writer, tag, FIELD_INPUT_FILE));
+	int length = writeString (mio, escapeFieldValue (writer, tag, FIELD_NAME));
+	length += mio_putc (mio, '\t') != EOF;
+	length += writeString (mio, escapeFieldValue (writer, tag, FIELD_INPUT_FILE));
+	length += mio_putc (mio, '\t') != EOF;
 
 	/* This is for handling 'common' of 'fortran'.  See the
 	   description of --excmd=mixed in ctags.1.  In tags output, what
@@ -342,17 +516,21 @@ static int writeCtagsEntry (tagWriter *writer,
 	else
 	{
 		if (Option.locate == EX_COMBINE)
-			length += mio_printf(mio, "%lu;", tag->lineNumber);
-		length += mio_puts(mio, escapeFieldValue(writer, tag, FIELD_PATTERN));
+		{
+			length += writeULong (mio, tag->lineNumber);
+			length += mio_putc (mio, ';') != EOF;
+		}
+		length += writeString (mio, escapeFieldValue(writer, tag, FIELD_PATTERN));
 	}
 
 	if (includeExtensionFlags ())
 	{
+		prepareRenderPlan ();
 		length += addExtensionFields (writer, mio, tag);
 		length += addParserFields (writer, mio, tag);
 	}
 
-	length += mio_printf (mio, "\n");
+	length += mio_putc (mio, '\n') != EOF;
 
 	return length;
 }
@@ -79,6 +79,19 @@ static bool endEtagsFile (tagWriter *writer,
 	{
 		mio_rewind (etags->mio);
 
+#ifdef HAVE_ICONV
+		/* With --transcode-input, the lines are in the output encoding
+		 * already. */
+		if (Option.transcodeInput)
+		{
+			char buf [BUFSIZ];
+			size_t len;
+
+			while ((len = mio_read (etags->mio, buf, 1, sizeof (buf))) > 0)
+				mio_write (mainfp, buf, 1, len);
+		}
+		else
+#endif
 		while ((line = readLineRaw (etags->vLine, etags->mio)) != NULL)
 			mio_puts (mainfp, line);
 
@@ -16,15 +16,15 @@
 #include "options_p.h"
 #include "read.h"
 #include "routines.h"
+#include "routines_p.h"
 #include "ptag_p.h"
+#include "vstring.h"
 #include "writer_p.h"
 
 
+#include <stdio.h>
 #include <string.h>
 
-#ifdef HAVE_JANSSON
-#include <jansson.h>
-
 /* The concept of CURRENT and AGE is taken from libtool.
  * However, we delete REVISION.
  * We will update more CURRENT frequently than the assumption
@@ -38,10 +38,13 @@
 #define JSON_WRITER_CURRENT 1
 #define JSON_WRITER_AGE 0
 
-#ifndef json_boolean /* compat with jansson < 2.4 */
-#define json_boolean(val)      ((val) ? json_true() : json_false())
-#endif
-
+/*
+ * The writer emits each JSON object directly into the output MIO
+ * instead of building it with a JSON library first. The output is the
+ * same as what json_dumps (..., JSON_PRESERVE_ORDER) of jansson made:
+ * ", " and ": " as separators, and a field whose string value is not
+ * valid UTF-8 is omitted.
+ */
 
 static int writeJsonEntry  (tagWriter *writer CTAGS_ATTR_UNUSED,
 				MIO * mio, const tagEntryInfo *const tag,
@@ -65,6 +68,161 @@ tagWriter jsonWriter = {
 	.defaultFileName = NULL,
 };
 
+typedef struct sJsonObject {
+	MIO *mio;
+	int length;
+	/* The members are written lazily; nothing is printed for an
+	 * object having only the leading member. */
+	const char *leadingKey;
+	const char *leadingValue;
+	bool opened;
+} jsonObject;
+
+/* The id of the interactive request being served, in JSON notation.
+ * When set, it is put to every object right after the leading member
+ * so a client can tell which request a tag belongs to. */
+static const char *requestId;
+
+extern void setJsonWriterRequestId (const char *rawJsonValue)
+{
+	requestId = rawJsonValue;
+}
+
+/* Same as utf8_check_string () of jansson. */
+static bool isValidUTF8 (const char *str, size_t len)
+{
+	const unsigned char *s = (const unsigned char *)str;
+	const unsigned char *end = s + len;
+
+	while (s < end)
+	{
+		unsigned char c = *s;
+		size_t size;
+		unsigned int value;
+
+		if (c < 0x80)
+		{
+			s++;
+			continue;
+		}
+		else if (c <= 0xC1)
+			return false;
+		else if (c <= 0xDF)
+		{
+			size = 2;
+			value = c & 0x1F;
+		}
+		else if (c <= 0xEF)
+		{
+			size = 3;
+			value = c & 0xF;
+		}
+		else if (c <= 0xF4)
+		{
+			size = 4;
+			value = c & 0x7;
+		}
+		else
+			return false;
+
+		if ((size_t)(end - s) < size)
+			return false;
+
+		for (size_t i = 1; i < size; i++)
+		{
+			if ((s [i] & 0xC0) != 0x80)
+				return false;
+			value = (value << 6) + (s [i] & 0x3F);
+		}
+
+		if (value > 0x10FFFF
+			|| (0xD800 <= value && value <= 0xDFFF)
+			|| (size == 2 && value < 0x80)
+			|| (size == 3 && value < 0x800)
+			|| (size == 4 && value < 0x10000))
+			return false;
+
+		s += size;
+	}
+	return true;
+}
+
+static void jsonObjectInit (jsonObject *obj, MIO *mio,
+							const char *leadingKey, const char *leadingValue)
+{
+	obj->mio = mio;
+	obj->length = 0;
+	obj->leadingKey = leadingKey;
+	obj->leadingValue = leadingValue;
+	obj->opened = false;
+}
+
+static void jsonObjectOpen (jsonObject *obj)
+{
+	obj->length += mio_putc (obj->mio, '{') != EOF;
+	obj->length += writeJsonString (obj->mio, obj->leadingKey,
+									   strlen (obj->leadingKey));
+	obj->length += mio_write (obj->mio, ": ", 1, 2);
+	obj->length += writeJsonString (obj->mio, obj->leadingValue,
+									   strlen (obj->leadingValue));
+	if (requestId)
+	{
+		obj->length += mio_write (obj->mio, ", \"id\": ", 1, 8);
+		obj->length += mio_write (obj->mio, requestId, 1, strlen (requestId));
+	}
+	obj->opened = true;
+}
+
+static void jsonObjectPutKey (jsonObject *obj, const char *key)
+{
+	if (!obj->opened)
+		jsonObjectOpen (obj);
+	obj->length += mio_write (obj->mio, ", ", 1, 2);
+	obj->length += writeJsonString (obj->mio, key, strlen (key));
+	obj->length += mio_write (obj->mio, ": ", 1, 2);
+}
+
+static bool jsonObjectPutString (jsonObject *obj, const char *key, const char *value)
+{
+	if (value == NULL)
+		return false;
+
+	size_t len = strlen (value);
+	if (!isValidUTF8 (value, len))
+		return false;
+
+	jsonObjectPutKey (obj, key);
+	obj->length += writeJsonString (obj->mio, value, len);
+	return true;
+}
+
+static void jsonObjectPutInteger (jsonObject *obj, const char *key, long value)
+{
+	jsonObjectPutKey (obj, key);
+	obj->length += mio_printf (obj->mio, "%ld", value);
+}
+
+static void jsonObjectPutBool (jsonObject *obj, const char *key, bool value)
+{
+	jsonObjectPutKey (obj, key);
+	obj->length += mio_puts (obj->mio, value? "true": "false") != EOF
+		? (value? 4: 5)
+		: 0;
+}
+
+/* Return the length of the object written. */
+static int jsonObjectClose (jsonObject *obj, bool force)
+{
+	if (!obj->opened)
+	{
+		if (!force)
+			return 0;
+		jsonObjectOpen (obj);
+	}
+	obj->length += mio_write (obj->mio, "}\n", 1, 2);
+	return obj->length;
+}
+
 static const char* escapeFieldValueRaw (const tagEntryInfo * tag, fieldType ftype, int fieldIndex)
 {
 	const char *v;
@@ -76,7 +234,8 @@ static const char* escapeFieldValueRaw (const tagEntryInfo * tag, fieldType ftyp
 	return v;
 }
 
-static json_t* escapeFieldValue (const tagEntryInfo * tag, fieldType ftype, bool returnEmptyStringAsNoValue)
+static void putFieldValue (jsonObject *obj, const char *key,
+						   const tagEntryInfo * tag, fieldType ftype, bool returnEmptyStringAsNoValue)
 {
 	const char *str = escapeFieldValueRaw (tag, ftype, NO_PARSER_FIELD);
 
@@ -86,35 +245,33 @@ static json_t* escapeFieldValue (const tagEntryInfo * tag, fieldType ftype, bool
 		if (dt & FIELDTYPE_STRING)
 		{
 			if (dt & FIELDTYPE_BOOL && str[0] == '\0')
-				return json_false();
+				jsonObjectPutBool (obj, key, false);
 			else
-				return json_string (str);
+				jsonObjectPutString (obj, key, str);
+			return;
 		}
 		else if (dt & FIELDTYPE_INTEGER)
 		{
 			long tmp;
 
 			if (strToLong (str, 10, &tmp))
-				return json_integer (tmp);
-			else
-				return NULL;
+				jsonObjectPutInteger (obj, key, tmp);
+			return;
 		}
 		else if (dt & FIELDTYPE_BOOL)
 		{
 			/* TODO: This must be fixed when new boolean field is added.
 			   Currently only `file:' field use this. */
-			return json_boolean (strcmp ("-", str)); /* "-" -> false */
+			jsonObjectPutBool (obj, key, strcmp ("-", str)); /* "-" -> false */
+			return;
 		}
 		AssertNotReached ();
-		return NULL;
 	}
 	else if (returnEmptyStringAsNoValue)
-		return json_false();
-	else
-		return NULL;
+		jsonObjectPutBool (obj, key, false);
 }
 
-static void renderExtensionFieldMaybe (int xftype, const tagEntryInfo *const tag, json_t *response)
+static void renderExtensionFieldMaybe (int xftype, const tagEntryInfo *const tag, jsonObject *obj)
 {
 	const char *fname = getFieldName (xftype);
 
@@ -123,21 +280,18 @@ static void renderExtensionFieldMaybe (int xftype, const tagEntryInfo *const tag
 		switch (xftype)
 		{
 		case FIELD_LINE_NUMBER:
-			json_object_set_new (response, fname,
-					     json_integer (tag->lineNumber));
+			jsonObjectPutInteger (obj, fname, (long) tag->lineNumber);
 			break;
 		case FIELD_FILE_SCOPE:
-			json_object_set_new (response, fname,
-					     json_boolean(1));
+			jsonObjectPutBool (obj, fname, true);
 			break;
 		default:
-			json_object_set_new (response, fname,
-					     escapeFieldValue (tag, xftype, false));
+			putFieldValue (obj, fname, tag, xftype, false);
 		}
 	}
 }
 
-static void addParserFields (json_t *response, const tagEntryInfo *const tag)
+static void addParserFields (jsonObject *obj, const tagEntryInfo *const tag)
 {
 	unsigned int i;
 
@@ -149,34 +303,40 @@ static void addParserFields (json_t *response, const tagEntryInfo *const tag)
 			continue;
 
 		unsigned int dt = getFieldDataType (ftype);
-		json_t *o;
+		const char *key = getFieldName (ftype);
 		if (dt & FIELDTYPE_STRING)
 		{
 			const char *str = escapeFieldValueRaw (tag, ftype, i);
 			if (dt & FIELDTYPE_BOOL && str[0] == '\0')
-				o = json_false ();
+				jsonObjectPutBool (obj, key, false);
 			else
-				o = json_string (str);
+				jsonObjectPutString (obj, key, str);
 		}
 		else if (dt & FIELDTYPE_INTEGER)
 		{
 			/* NOT IMPLEMENTED YET */
 			AssertNotReached ();
-			o = json_null ();
+			jsonObjectPutKey (obj, key);
+			obj->length += mio_puts (obj->mio, "null") != EOF? 4: 0;
 		}
 		else if (dt & FIELDTYPE_BOOL)
-			o = json_true ();
+			jsonObjectPutBool (obj, key, true);
 		else
 		{
 			AssertNotReached ();
-			o = json_null ();
+			jsonObjectPutKey (obj, key);
+			obj->length += mio_puts (obj->mio, "null") != EOF? 4: 0;
 		}
-
-		json_object_set_new (response, getFieldName (ftype), o);
 	}
 }
 
-static void addExtensionFields (json_t *response, const tagEntryInfo *const tag)
+static void enableFieldMaybe (fieldType ftype)
+{
+	if (!isFieldEnabled (ftype))
+		enableField (ftype, true);
+}
+
+static void addExtensionFields (jsonObject *obj, const tagEntryInfo *const tag)
 {
 	int k;
 
@@ -185,61 +345,48 @@ static void addExtensionFields (json_t *response, const tagEntryInfo *const tag)
 	   That cannot be changed to keep the compatibility of tags file format.
 	   Use FIELD_KIND_KEY instead */
 	if (isFieldEnabled (FIELD_KIND) || isFieldEnabled (FIELD_KIND_LONG))
-		enableField (FIELD_KIND_KEY, true);
+		enableFieldMaybe (FIELD_KIND_KEY);
 
 	/* FIELD_SCOPE has no name; getFieldName (FIELD_KIND_KEY) returns NULL.
 	   That cannot be changed to keep the compatibility of tags file format.
 	   Use FIELD_SCOPE_KEY and FIELD_SCOPE_KIND_LONG instead. */
 	if (isFieldEnabled (FIELD_SCOPE))
 	{
-		enableField (FIELD_SCOPE_KEY, true);
-		enableField (FIELD_SCOPE_KIND_LONG, true);
+		enableFieldMaybe (FIELD_SCOPE_KEY);
+		enableFieldMaybe (FIELD_SCOPE_KIND_LONG);
 	}
 
 	for (k = FIELD_JSON_LOOP_START; k <= FIELD_BUILTIN_LAST; k++)
-		renderExtensionFieldMaybe (k, tag, response);
+		renderExtensionFieldMaybe (k, tag, obj);
 }
 
 static int writeJsonEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
 			       MIO * mio, const tagEntryInfo *const tag,
 				   void *clientData CTAGS_ATTR_UNUSED)
 {
-	int length = 0;
-	json_t *response = json_pack ("{ss}", "_type", "tag");
+	jsonObject obj;
+
+	jsonObjectInit (&obj, mio, "_type", "tag");
 
 	if (isFieldEnabled (FIELD_NAME))
 	{
-		json_t *name = json_string (tag->name);
-		if (name == NULL)
-			goto out;
-		json_object_set_new (response, "name", name);
+		if (!isValidUTF8 (tag->name, strlen (tag->name)))
+			return 0;
+		jsonObjectPutString (&obj, "name", tag->name);
 	}
 	if (isFieldEnabled (FIELD_INPUT_FILE))
-		json_object_set_new (response, "path", json_string (tag->sourceFileName));
+		jsonObjectPutString (&obj, "path", tag->sourceFileName);
 	if (isFieldEnabled (FIELD_PATTERN))
-	{
-		json_t *pat = escapeFieldValue(tag, FIELD_PATTERN, true);
-		json_object_set_new (response, "pattern", pat);
-	}
+		putFieldValue (&obj, "pattern", tag, FIELD_PATTERN, true);
 
 	if (includeExtensionFlags ())
 	{
-		addExtensionFields (response, tag);
-		addParserFields (response, tag);
+		addExtensionFields (&obj, tag);
+		addParserFields (&obj, tag);
 	}
 
-	/* Print nothing if RESPONSE has only "_type" field. */
-	if (json_object_size (response) == 1)
-		goto out;
-
-	char *buf = json_dumps (response, JSON_PRESERVE_ORDER);
-	length = mio_printf (mio, "%s\n", buf);
-
-	free (buf);
- out:
-	json_decref (response);
-
-	return length;
+	/* Print nothing if the object has only "_type" field. */
+	return jsonObjectClose (&obj, false);
 }
 
 static int writeJsonPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
@@ -250,45 +397,33 @@ static int writeJsonPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
 				   void *clientData CTAGS_ATTR_UNUSED)
 {
 #define OPT(X) ((X)?(X):"")
-	json_t *response;
+	jsonObject obj;
 	char *parserName0 = NULL;
 
 	const char *rest = ((JSON_WRITER_CURRENT > 0) && parserName && desc->jsonObjectKey)
 		? strchr(parserName, '!')
 		: NULL;
+
+	/* All members are mandatory in a pseudo tag. */
+	if (!isValidUTF8 (OPT(fileName), strlen (OPT(fileName)))
+		|| !isValidUTF8 (OPT(pattern), strlen (OPT(pattern)))
+		|| (parserName && !isValidUTF8 (parserName, strlen (parserName))))
+		return 0;
+
+	jsonObjectInit (&obj, mio, "_type", "ptag");
+	jsonObjectPutString (&obj, "name", desc->name);
 	if (rest)
 	{
 		parserName0 = eStrndup(parserName, rest - parserName);
-		response = json_pack ("{ss ss ss ss ss ss}",
-				      "_type", "ptag",
-				      "name", desc->name,
-				      "parserName", parserName0,
-				      desc->jsonObjectKey, rest + 1,
-				      "path", OPT(fileName),
-				      "pattern", OPT(pattern));
+		jsonObjectPutString (&obj, "parserName", parserName0);
+		jsonObjectPutString (&obj, desc->jsonObjectKey, rest + 1);
 	}
 	else if (parserName)
-	{
-		response = json_pack ("{ss ss ss ss ss}",
-				      "_type", "ptag",
-				      "name", desc->name,
-				      "parserName", parserName,
-				      "path", OPT(fileName),
-				      "pattern", OPT(pattern));
-	}
-	else
-	{
-		response = json_pack ("{ss ss ss ss}",
-				      "_type", "ptag",
-				      "name", desc->name,
-				      "path", OPT(fileName),
-				      "pattern", OPT(pattern));
-	}
+		jsonObjectPutString (&obj, "parserName", parserName);
+	jsonObjectPutString (&obj, "path", OPT(fileName));
+	jsonObjectPutString (&obj, "pattern", OPT(pattern));
 
-	char *buf = json_dumps (response, JSON_PRESERVE_ORDER);
-	int length = mio_printf (mio, "%s\n", buf);
-	free (buf);
-	json_decref (response);
+	int length = jsonObjectClose (&obj, true);
 	if (parserName0)
 		eFree(parserName0);
 
@@ -304,21 +439,3 @@ extern bool ptagMakeJsonOutputVersion (ptagDesc *desc, langType language CTAGS_A
 			       "in development",
 			       NULL);
 }
-
-#else /* HAVE_JANSSON */
-
-tagWriter jsonWriter = {
-	.writeEntry = NULL,
-	.writePtagEntry = NULL,
-	.preWriteEntry = NULL,
-	.postWriteEntry = NULL,
-	.defaultFileName = "-",
-};
-
-extern bool ptagMakeJsonOutputVersion (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED,
-									   const void *data CTAGS_ATTR_UNUSED)
-{
-	return false;
-}
-
-#endif
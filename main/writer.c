@@ -19,6 +19,7 @@ extern tagWriter eCtagsWriter;
 extern tagWriter etagsWriter;
 extern tagWriter xrefWriter;
 extern tagWriter jsonWriter;
+extern tagWriter binaryWriter;
 
 static tagWriter *writerTable [WRITER_COUNT] = {
 	[WRITER_U_CTAGS] = &uCtagsWriter,
@@ -26,6 +27,7 @@ static tagWriter *writerTable [WRITER_COUNT] = {
 	[WRITER_ETAGS] = &etagsWriter,
 	[WRITER_XREF]  = &xrefWriter,
 	[WRITER_JSON]  = &jsonWriter,
+	[WRITER_BINARY] = &binaryWriter,
 	[WRITER_CUSTOM] = NULL,
 };
 
@@ -91,6 +93,17 @@ extern void writerRescanFailed (unsigned long validTagNum)
 		writer->rescanFailedEntry(writer, validTagNum, writer->clientData);
 }
 
+extern bool writerCanRewriteInput (void)
+{
+	return (writer->rewriteInputEntry != NULL);
+}
+
+extern int writerRewriteInput (MIO * mio, const char *const line, size_t length,
+							   const tagEntryInfo *const tag)
+{
+	return writer->rewriteInputEntry (writer, mio, line, length, tag);
+}
+
 extern bool ptagMakeCtagsOutputMode (ptagDesc *desc, langType langType CTAGS_ATTR_UNUSED,
 									 const void *data CTAGS_ATTR_UNUSED)
 {
@@ -187,3 +200,14 @@ extern bool writerPrintPtagByDefault (void)
 {
 	return writer->printPtagByDefault;
 }
+
+extern bool writerIsLineOrientedByFile (void)
+{
+	return (writer->type == WRITER_U_CTAGS
+			|| writer->type == WRITER_E_CTAGS);
+}
+
+extern bool writerIsBinary (void)
+{
+	return (writer->type == WRITER_BINARY);
+}
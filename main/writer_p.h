@@ -26,10 +26,16 @@ typedef enum eWriterType {
 	WRITER_ETAGS,
 	WRITER_XREF,
 	WRITER_JSON,
+	WRITER_BINARY,
 	WRITER_CUSTOM,
 	WRITER_COUNT,
 } writerType;
 
+/* The first bytes of a tags file written by the binary writer.
+ * "\r\n" in it detects a broken transfer in text mode. */
+#define BINARY_TAGS_MAGIC "\211CTAGS\r\n"
+#define BINARY_TAGS_MAGIC_LENGTH 8
+
 struct sTagWriter;
 typedef struct sTagWriter tagWriter;
 struct sTagWriter {
@@ -54,6 +60,14 @@ struct sTagWriter {
 
 	void (* checkOptions) (tagWriter *writer, bool fieldsWereReset);
 
+	/* Write LINE, written by this writer for another input having the
+	   same contents, again with the input field of TAG. Return the number
+	   of bytes written, or 0 if LINE is not for a tag.
+	   Used for --dedup-inputs. */
+	int (* rewriteInputEntry) (tagWriter *writer, MIO * mio,
+							   const char *const line, size_t length,
+							   const tagEntryInfo *const tag);
+
 #ifdef _WIN32
 	enum filenameSepOp (* overrideFilenameSeparator) (enum filenameSepOp currentSetting);
 #endif	/* _WIN32 */
@@ -83,12 +97,18 @@ int writerWritePtag (MIO * mio,
 
 void writerRescanFailed (unsigned long validTagNum);
 
+extern bool writerCanRewriteInput (void);
+extern int writerRewriteInput (MIO * mio, const char *const line, size_t length,
+							   const tagEntryInfo *const tag);
+
 extern const char *outputDefaultFileName (void);
 
 extern size_t truncateTagLineAfterTag (char *const line, const char *const token,
 			     const bool discardNewline);
 extern void abort_if_ferror(MIO *const fp);
 
+extern void setJsonWriterRequestId (const char *rawJsonValue);
+
 extern bool ptagMakeJsonOutputVersion (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED, const void *data CTAGS_ATTR_UNUSED);
 extern bool ptagMakeCtagsOutputMode (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED, const void *data CTAGS_ATTR_UNUSED);
 extern bool ptagMakeCtagsOutputFilesep (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED, const void *data);
@@ -100,6 +120,14 @@ extern bool writerDoesTreatFieldAsFixed (int fieldType);
 extern void writerCheckOptions (bool fieldsWereReset);
 extern bool writerPrintPtagByDefault (void);
 
+/* Whether each tag is written as one line having the input file name
+ * as its second tab separated field. */
+extern bool writerIsLineOrientedByFile (void);
+
+/* Whether the output is the binary tag stream, which must be written
+ * without conversion, and cannot be sorted nor appended. */
+extern bool writerIsBinary (void);
+
 #ifdef _WIN32
 extern enum filenameSepOp getFilenameSeparator (enum filenameSepOp currentSetting);
 #endif	/* _WIN32 */
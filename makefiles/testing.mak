@@ -1,14 +1,14 @@
 # -*- makefile -*-
-.PHONY: check units fuzz noise tmain tinst tlib man-test clean-units clean-tlib clean-tmain clean-gcov clean-man-test run-gcov codecheck cppcheck dicts validate-input check-genfile tutil
+.PHONY: check units bench complexity fuzz noise tmain tinst tlib man-test clean-units clean-tlib clean-tmain clean-gcov clean-man-test clean-bench clean-complexity run-gcov codecheck cppcheck dicts validate-input check-genfile tutil
 
-EXTRA_DIST += misc/units misc/units.py misc/man-test.py
+EXTRA_DIST += misc/units misc/units.py misc/man-test.py misc/bench misc/complexity
 EXTRA_DIST += misc/tlib misc/mini-geany.expected
 MAN_TEST_TMPDIR = ManTest
 
 check: tmain units tlib man-test check-genfile tutil
 
 # We may use CLEANFILES, DISTCLEANFILES, or etc.
-clean-local: clean-units clean-tmain clean-man-test clean-tlib clean-gcov
+clean-local: clean-units clean-tmain clean-man-test clean-tlib clean-gcov clean-bench clean-complexity
 
 CTAGS_TEST = ./ctags$(EXEEXT)
 READTAGS_TEST = ./readtags$(EXEEXT)
@@ -160,6 +160,66 @@ clean-units:
 		$(SHELL) $(srcdir)/misc/units clean $$(pwd)/Units; \
 	fi
 
+#
+# BENCH Target
+#
+# Measure the throughput of parsers on a corpus made from the inputs
+# of Units. e.g.
+#
+#    $ make bench LANGUAGES=C,Python BENCH_SAVE_BASELINE=base.txt
+#    (change the code)
+#    $ make bench LANGUAGES=C,Python BENCH_BASELINE=base.txt
+#
+BENCH_PROFILES = default,fields,unsorted,json
+BENCH_SIZE = 2048
+BENCH_REPEAT = 3
+BENCH_TOLERANCE = 10
+BENCH_BASELINE =
+BENCH_SAVE_BASELINE =
+bench: $(CTAGS_DEP)
+	$(V_RUN) \
+	if test -n "$${ZSH_VERSION+set}"; then set -o SH_WORD_SPLIT; fi; \
+	c="$(srcdir)/misc/bench \
+		--ctags=$(CTAGS_TEST) \
+		--languages=$(LANGUAGES) \
+		--profiles=$(BENCH_PROFILES) \
+		--size=$(BENCH_SIZE) \
+		--repeat=$(BENCH_REPEAT) \
+		--tolerance=$(BENCH_TOLERANCE) \
+		--baseline=$(BENCH_BASELINE) \
+		--save-baseline=$(BENCH_SAVE_BASELINE)"; \
+	$(SHELL) $${c} $(srcdir)/Units $$(pwd)/Bench
+
+clean-bench:
+	$(SILENT) echo Cleaning bench corpus
+	$(SILENT) rm -rf $$(pwd)/Bench
+
+#
+# COMPLEXITY Target
+#
+# Detect parsers whose run time grows faster than the size of input.
+#
+COMPLEXITY_SHAPES = siblings,long-line,nesting,string,unterminated
+COMPLEXITY_SIZE = 32
+COMPLEXITY_MAX_SIZE = 32768
+COMPLEXITY_TOLERANCE = 0.5
+complexity: $(CTAGS_DEP)
+	$(V_RUN) \
+	if test -n "$${ZSH_VERSION+set}"; then set -o SH_WORD_SPLIT; fi; \
+	c="$(srcdir)/misc/complexity \
+		--ctags=$(CTAGS_TEST) \
+		--languages=$(LANGUAGES) \
+		--shapes=$(COMPLEXITY_SHAPES) \
+		--size=$(COMPLEXITY_SIZE) \
+		--max-size=$(COMPLEXITY_MAX_SIZE) \
+		--tolerance=$(COMPLEXITY_TOLERANCE) \
+		--with-timeout=`expr $(TIMEOUT) '*' 60`"; \
+	$(SHELL) $${c} $(srcdir)/Units $$(pwd)/Complexity
+
+clean-complexity:
+	$(SILENT) echo Cleaning complexity test inputs
+	$(SILENT) rm -rf $$(pwd)/Complexity
+
 #
 # VALIDATE-INPUT Target
 #
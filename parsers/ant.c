@@ -223,6 +223,8 @@ static xmlSubparser antSubparser = {
 		.direction = SUBPARSER_BI_DIRECTION,
 	},
 	.runXPathEngine = runXPathEngine,
+	.rootXPathTable = true,
+	.xpathTable = TABLE_MAIN,
 };
 #endif
 
@@ -22,6 +22,7 @@
 #include "kind.h"
 #include "options.h"
 #include "read.h"
+#include "routines.h"
 #include "vstring.h"
 #include "param.h"
 #include "parse.h"
@@ -2015,7 +2016,9 @@ static bool buildMacroInfoFromTagEntry (int corkIndex,
 		if (val)
 			vStringCatS (macrodef, val);
 
+		const char *allocationTag = setAllocationTag ("cpp-macro");
 		*info = saveMacro (Cpp.fileMacroTable, vStringValue (macrodef));
+		setAllocationTag (allocationTag);
 		vStringDelete (macrodef);
 
 		return false;
@@ -221,6 +221,8 @@ static xmlSubparser dbusIntrospectSubparser = {
 		.direction = SUBPARSER_BI_DIRECTION,
 	},
 	.runXPathEngine = runXPathEngine,
+	.rootXPathTable = true,
+	.xpathTable = TABLE_ROOT,
 };
 
 extern parserDefinition*
@@ -72,18 +72,12 @@ findGladeTags (void)
 }
 
 
-static void
-runXPathEngine(xmlSubparser *s,
-			   xmlXPathContext *ctx, xmlNode *root)
-{
-	findXMLTags (ctx, root, TABLE_MAIN, NULL);
-}
-
 static xmlSubparser gladeSubparser = {
 	.subparser = {
 		.direction = SUBPARSER_BI_DIRECTION,
 	},
-	.runXPathEngine = runXPathEngine,
+	.useXPathTable = true,
+	.xpathTable = TABLE_MAIN,
 };
 
 extern parserDefinition*
@@ -144,6 +144,11 @@ static void makeJsonTag (tokenInfo *const token, const jsonKind kind)
 #define DEPTH_LIMIT 512
 static int depth_counter;
 
+static bool isWhitespace (int c)
+{
+	return (c == '\t' || c == ' ' || c == '\r' || c == '\n');
+}
+
 static void readTokenFull (tokenInfo *const token,
 						   bool includeStringRepr)
 {
@@ -166,9 +171,8 @@ static void readTokenFull (tokenInfo *const token,
 	token->type = TOKEN_UNDEFINED;
 	vStringClear (token->string);
 
-	do
-		c = getcFromInputFile ();
-	while (c == '\t' || c == ' ' || c == '\r' || c == '\n');
+	cursorSkipWhile (isWhitespace);
+	c = cursorGetc ();
 
 	token->lineNumber   = getInputLineNumber ();
 	token->filePosition = getInputFilePosition ();
@@ -197,7 +201,7 @@ static void readTokenFull (tokenInfo *const token,
 			token->type = TOKEN_STRING;
 			while (true)
 			{
-				c = getcFromInputFile ();
+				c = cursorGetc ();
 				/* we don't handle unicode escapes but they are safe */
 				if (escaped)
 					escaped = false;
@@ -221,7 +225,7 @@ static void readTokenFull (tokenInfo *const token,
 				do
 				{
 					vStringPut (token->string, c);
-					c = getcFromInputFile ();
+					c = cursorGetc ();
 				}
 				while (c != EOF && isIdentChar (c));
 				ungetcToInputFile (c);
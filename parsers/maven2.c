@@ -249,6 +249,8 @@ static xmlSubparser maven2Subparser = {
 		.direction = SUBPARSER_BI_DIRECTION,
 	},
 	.runXPathEngine = runXPathEngine,
+	.rootXPathTable = true,
+	.xpathTable = TABLE_MAIN,
 };
 
 extern parserDefinition*
@@ -170,6 +170,8 @@ static xmlSubparser plistSubparser = {
 		.direction = SUBPARSER_BI_DIRECTION,
 	},
 	.runXPathEngine = runXPathEngine,
+	.rootXPathTable = true,
+	.xpathTable = TABLE_MAIN,
 };
 
 extern parserDefinition*
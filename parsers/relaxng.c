@@ -238,6 +238,8 @@ static xmlSubparser relaxngSubparser = {
 		.direction = SUBPARSER_BI_DIRECTION,
 	},
 	.runXPathEngine = runXPathEngine,
+	.rootXPathTable = true,
+	.xpathTable = TABLE_MAIN,
 };
 
 extern parserDefinition*
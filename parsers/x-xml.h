@@ -28,6 +28,8 @@ struct sXmlSubparser {
 	/* Similar to makeTagEntryNotify method of subparser.
 	 * However, makeTagEntryWithNodeNotify passes the xml node
 	 * just found to subparsers.
+	 * The base parser may call this while reading the input as a stream.
+	 * Only NODE, its attributes, and its ancestors are read then.
 	 */
 	void (* makeTagEntryWithNodeNotify) (xmlSubparser *s,
 										 xmlNode *node, tagEntryInfo *xmlTag);
@@ -42,6 +44,25 @@ struct sXmlSubparser {
 	 */
 	void (* runXPathEngine) (xmlSubparser *s,
 							 xmlXPathContext *ctx, xmlNode *root);
+
+	/* A subparser that only runs one of its xpath tables from the
+	 * root element can set useXPathTable and the index of the table
+	 * to xpathTable instead of runXPathEngine. The base parser runs
+	 * the table. If the tables of the base parser and all the
+	 * subparsers can be matched while streaming (see xpathStreamAddTable),
+	 * the base parser reads the input as a stream without making the DOM
+	 * tree.
+	 */
+	bool useXPathTable;
+	int xpathTable;
+
+	/* A subparser whose runXPathEngine only runs one of its xpath
+	 * tables from the root element can set rootXPathTable to true and
+	 * the index of the table to xpathTable. The base parser doesn't call
+	 * runXPathEngine for an input the table cannot match (see
+	 * xpathStreamMayMatchTable), and may read the input as a stream.
+	 */
+	bool rootXPathTable;
 };
 
 #endif /* CTAGS_PARSER_XML_H */
@@ -65,7 +65,8 @@ static void findNsPrefix (xmlNode *node,
 static tagXpathTable XmlXpathMainTable [] = {
 	{ "//*",
 	  LXPATH_TABLE_DO_RECUR,
-	  { .recurSpec = { .enter = findNsPrefix, .nextTable = TABLE_ID } }
+	  { .recurSpec = { .enter = findNsPrefix, .nextTable = TABLE_ID,
+					   .streamable = true } }
 	},
 };
 
@@ -181,13 +182,75 @@ static void runAfter (xmlXPathContext *ctx, xmlNode *root, void *user_data)
 			xmlsub->runXPathEngine (xmlsub, ctx, root);
 			leaveSubparser();
 		}
+		else if (xmlsub->useXPathTable)
+		{
+			enterSubparser(sub);
+			findXMLTags (ctx, root, xmlsub->xpathTable, NULL);
+			leaveSubparser();
+		}
+	}
+}
+
+/* Returns false if the input should be parsed into a DOM tree. */
+static bool findXmlTagsStreaming (void)
+{
+	xpathStream *stream = xpathStreamNew ();
+	bool streaming = xpathStreamAddTable (stream, TABLE_MAIN);
+	subparser *sub;
+
+	foreachSubparser (sub, false)
+	{
+		xmlSubparser *xmlsub = (xmlSubparser *)sub;
+
+		if (!streaming)
+			break;
+
+		if (xmlsub->runXPathEngine)
+		{
+			if (xmlsub->rootXPathTable)
+			{
+				enterSubparser(sub);
+				streaming = !xpathStreamMayMatchTable (stream, xmlsub->xpathTable);
+				leaveSubparser();
+			}
+			else
+				streaming = false;
+		}
+		else if (xmlsub->useXPathTable)
+		{
+			enterSubparser(sub);
+			streaming = xpathStreamAddTable (stream, xmlsub->xpathTable);
+			leaveSubparser();
+		}
 	}
+
+	if (streaming)
+		streaming = xpathStreamRun (stream, NULL);
+
+	if (streaming)
+	{
+		foreachSubparser (sub, false)
+		{
+			xmlSubparser *xmlsub = (xmlSubparser *)sub;
+
+			if (xmlsub->useXPathTable)
+			{
+				enterSubparser(sub);
+				xpathStreamMakeTags (stream, xmlsub->xpathTable);
+				leaveSubparser();
+			}
+		}
+	}
+
+	xpathStreamDelete (stream);
+	return streaming;
 }
 
 static void
 findXmlTags (void)
 {
-	findXMLTagsFull (NULL, NULL, TABLE_MAIN, runAfter, NULL);
+	if (!findXmlTagsStreaming ())
+		findXMLTagsFull (NULL, NULL, TABLE_MAIN, runAfter, NULL);
 }
 
 extern parserDefinition*
@@ -98,6 +98,8 @@ static xmlSubparser xrcSubparser = {
 		.direction = SUBPARSER_SUB_RUNS_BASE,
 	},
 	.runXPathEngine = runXPathEngine,
+	.rootXPathTable = true,
+	.xpathTable = TABLE_MAIN,
 };
 
 extern parserDefinition*
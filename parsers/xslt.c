@@ -330,6 +330,8 @@ static xmlSubparser xsltSubparser = {
 		.direction = SUBPARSER_BI_DIRECTION,
 	},
 	.runXPathEngine = runXPathEngine,
+	.rootXPathTable = true,
+	.xpathTable = TABLE_MAIN,
 };
 
 extern parserDefinition*
@@ -105,12 +105,15 @@ LIB_PRIVATE_HEADS =		\
 	\
 	main/args_p.h		\
 	main/colprint_p.h	\
+	main/dedup_p.h		\
 	main/dependency_p.h	\
+	main/dirwalk_p.h	\
 	main/entry_p.h		\
 	main/error_p.h		\
 	main/field_p.h		\
 	main/flags_p.h		\
 	main/fmt_p.h		\
+	main/globset_p.h	\
 	main/interactive_p.h	\
 	main/keyword_p.h	\
 	main/kind_p.h		\
@@ -126,12 +129,15 @@ LIB_PRIVATE_HEADS =		\
 	main/promise_p.h	\
 	main/ptag_p.h		\
 	main/read_p.h		\
+	main/readahead_p.h	\
 	main/script_p.h		\
 	main/sort_p.h		\
 	main/stats_p.h		\
 	main/subparser_p.h	\
+	main/trace-event_p.h	\
 	main/trashbox_p.h	\
 	main/utf8_str.h		\
+	main/watch_p.h		\
 	main/writer_p.h		\
 	main/xtag_p.h		\
 	\
@@ -152,13 +158,16 @@ LIB_SRCS =			\
 	\
 	main/args.c			\
 	main/colprint.c			\
+	main/dedup.c			\
 	main/dependency.c		\
+	main/dirwalk.c			\
 	main/entry.c			\
 	main/entry_private.c		\
 	main/error.c			\
 	main/field.c			\
 	main/flags.c			\
 	main/fmt.c			\
+	main/globset.c			\
 	main/keyword.c			\
 	main/kind.c			\
 	main/lregex.c			\
@@ -176,6 +185,7 @@ LIB_SRCS =			\
 	main/ptag.c			\
 	main/rbtree.c			\
 	main/read.c			\
+	main/readahead.c		\
 	main/script.c			\
 	main/seccomp.c			\
 	main/selectors.c		\
@@ -183,10 +193,13 @@ LIB_SRCS =			\
 	main/stats.c			\
 	main/strlist.c			\
 	main/trace.c			\
+	main/trace-event.c		\
 	main/tokeninfo.c		\
 	main/unwindi.c			\
 	main/utf8_str.c			\
+	main/watch.c			\
 	main/writer.c			\
+	main/writer-binary.c		\
 	main/writer-etags.c		\
 	main/writer-ctags.c		\
 	main/writer-json.c		\